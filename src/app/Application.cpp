@@ -3,9 +3,16 @@
 #include "ImGuiLayer.h"
 #include "SimulationUI.h"
 #include "Shader.h"
+#include "Parallel.h"
+#include "PrecisionBenchmark.h"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdio>
 
+// Vertices per range when reducing frame metrics
+static const size_t METRICS_GRAIN = 8192;
+
 Application::Application() = default;
 
 Application::~Application()
@@ -75,73 +82,16 @@ bool Application::Init()
 
 void Application::MainLoop()
 {
+	JobSystem& jobs = JobSystem::Get();
+
 	while (!glfwWindowShouldClose(m_Window))
 	{
 		double currentTime = glfwGetTime();
 		m_DeltaTime = currentTime - m_LastTime;
 		m_LastTime = currentTime;
 
-		m_InputHandler->ProcessInput(m_Window, m_DeltaTime);
-
-		glClearColor(0.15f, 0.15f, 0.15f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-		// ImGui new frame
-		m_ImGuiLayer->BeginFrame();
-
-		// Draw UI panel
-		float fps = (m_DeltaTime > 0) ? static_cast<float>(1.0 / m_DeltaTime) : 0.0f;
-		m_SimUI->Draw(m_SimParams, m_SimMetrics, m_SimRunning, m_Wireframe,
-		              m_StepOnce, m_ResetRequested, fps, this);
-
-		// Handle reset
-		if (m_ResetRequested)
-		{
-			for (auto& sb : m_Softbodies)
-				sb->Reset();
-			m_SimMetrics = SimulationMetrics{};
-			m_ResetRequested = false;
-		}
-
-		// Physics update (timed for metrics)
-		bool shouldSim = m_SimRunning || m_StepOnce;
-		{
-			auto t0 = std::chrono::high_resolution_clock::now();
-
-			for (auto& sb : m_Softbodies)
-				sb->Update(shouldSim, m_SimParams, m_SimParams.collider);
-
-			auto t1 = std::chrono::high_resolution_clock::now();
-			float ms = std::chrono::duration<float, std::milli>(t1 - t0).count();
-
-			if (shouldSim)
-			{
-				m_SimMetrics.physicsStepMs = ms;
-				// Exponential moving average (α = 0.05)
-				m_SimMetrics.avgPhysicsStepMs = m_SimMetrics.avgPhysicsStepMs * 0.95f + ms * 0.05f;
-				m_SimMetrics.simFrameCount++;
-
-				// Compute max particle distance from center of mass
-				if (!m_Softbodies.empty())
-				{
-					const glm::vec3* bb = m_Softbodies[0]->GetBoundingBox();
-					glm::vec3 center = (bb[0] + bb[1]) * 0.5f;
-					float maxDist = 0.0f;
-
-					auto& mesh = m_Softbodies[0]->GetMesh();
-					for (const auto& v : mesh.GetVertices())
-					{
-						float d = glm::length(v.Position - center);
-						if (d > maxDist) maxDist = d;
-					}
-					m_SimMetrics.maxParticleDist = maxDist;
-
-					// Divergence: any particle > 50 units from center
-					m_SimMetrics.diverged = (maxDist > 50.0f);
-				}
-			}
-		}
-		if (m_StepOnce) m_StepOnce = false;
+		BuildFrameGraph();
+		m_FrameGraph.Run(jobs);
 
 		// Render soft bodies
 		if (m_Wireframe)
@@ -172,6 +122,23 @@ void Application::MainLoop()
 			                              GetAspectRatio(), m_NearPlane, m_FarPlane);
 		}
 
+		// Obstacles as wireframe boxes around their shapes
+		for (const ColliderPrimitive& obstacle : m_Obstacles.GetPrimitives())
+		{
+			if (!obstacle.enabled) continue;
+			glm::vec3 extent = obstacle.halfExtents;
+			if (obstacle.shape == ColliderShape::Sphere)
+				extent = glm::vec3(obstacle.radius);
+			else if (obstacle.shape == ColliderShape::Capsule)
+				extent = glm::vec3(obstacle.radius, obstacle.halfLength + obstacle.radius, obstacle.radius);
+			else if (obstacle.shape == ColliderShape::Plane)
+				extent = glm::vec3(5.0f, 0.0f, 5.0f);
+
+			glm::mat4 transform = glm::translate(glm::mat4(1.0f), obstacle.position) * glm::mat4(obstacle.GetAxes());
+			m_Renderer->RenderWireBox(-extent, extent, glm::vec4(1.0f, 0.6f, 0.0f, 1.0f), // Orange
+			                          *m_Camera, GetAspectRatio(), m_NearPlane, m_FarPlane, transform);
+		}
+
 		// Render loaded models (always solid)
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 		for (auto& model : m_Models)
@@ -192,6 +159,249 @@ void Application::MainLoop()
 	}
 }
 
+// Per-frame work as a dependency graph:
+//   input -> physics -> metrics -> render prep
+// Input and render prep touch GLFW/ImGui/GL and stay on the main thread;
+// physics and metrics run on the job system (physics fans out per body).
+void Application::BuildFrameGraph()
+{
+	m_FrameGraph.Clear();
+
+	TaskGraph::TaskId input = m_FrameGraph.AddTask("input", [this]()
+	{
+		m_InputHandler->ProcessInput(m_Window, m_DeltaTime);
+
+		glClearColor(0.15f, 0.15f, 0.15f, 1.0f);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+		// ImGui new frame
+		m_ImGuiLayer->BeginFrame();
+
+		// Draw UI panel
+		float fps = (m_DeltaTime > 0) ? static_cast<float>(1.0 / m_DeltaTime) : 0.0f;
+		m_SimUI->Draw(m_SimParams, m_SimMetrics, m_SimRunning, m_Wireframe,
+		              m_StepOnce, m_ResetRequested, fps, this);
+
+		// Handle reset
+		if (m_ResetRequested)
+		{
+			for (auto& sb : m_Softbodies)
+				sb->Reset();
+			m_SimMetrics = SimulationMetrics{};
+			m_Clock.Reset();
+			m_ResetRequested = false;
+		}
+
+		// Fixed-timestep clock: real time decides how many steps to run;
+		// a paused or single-stepped sim always shows its latest state
+		if (m_SimRunning)
+		{
+			m_Substeps = m_Clock.Advance(m_DeltaTime, m_SimParams.GetPhysicsStep(),
+			                             m_SimParams.maxSubsteps);
+			m_RenderAlpha = m_Clock.GetAlpha();
+		}
+		else
+		{
+			m_Clock.Reset();
+			m_Substeps = m_StepOnce ? 1 : 0;
+			m_RenderAlpha = 1.0f;
+		}
+		m_PhysicsStart = std::chrono::high_resolution_clock::now();
+	}, TaskAffinity::Main);
+
+	TaskGraph::TaskId metrics = m_FrameGraph.AddTask("metrics", [this]()
+	{
+		auto t1 = std::chrono::high_resolution_clock::now();
+		float ms = std::chrono::duration<float, std::milli>(t1 - m_PhysicsStart).count();
+
+		m_SimMetrics.substeps = m_Substeps;
+		if (m_DeltaTime > 0.0)
+		{
+			float rate = static_cast<float>(m_Substeps / m_DeltaTime);
+			m_SimMetrics.substepsPerSec = m_SimMetrics.substepsPerSec * 0.95f + rate * 0.05f;
+		}
+
+		if (m_Substeps == 0) return;
+
+		m_SimMetrics.physicsStepMs = ms;
+		// Exponential moving average (α = 0.05)
+		m_SimMetrics.avgPhysicsStepMs = m_SimMetrics.avgPhysicsStepMs * 0.95f + ms * 0.05f;
+		m_SimMetrics.simFrameCount++;
+
+		// Compute max particle distance from center of mass
+		if (!m_Softbodies.empty())
+		{
+			const glm::vec3* bb = m_Softbodies[0]->GetBoundingBox();
+			glm::vec3 center = (bb[0] + bb[1]) * 0.5f;
+
+			const auto& vertices = m_Softbodies[0]->GetMesh().GetVertices();
+			float maxDist = ParallelReduce(0, vertices.size(), METRICS_GRAIN, 0.0f,
+				[&](size_t first, size_t last)
+				{
+					float d = 0.0f;
+					for (size_t i = first; i < last; i++)
+						d = std::max(d, glm::length(vertices[i].Position - center));
+					return d;
+				},
+				[](float a, float b) { return std::max(a, b); });
+			m_SimMetrics.maxParticleDist = maxDist;
+
+			// Divergence: any particle > 50 units from center
+			m_SimMetrics.diverged = (maxDist > 50.0f);
+
+			const ImplicitSolver& solver = m_Softbodies[0]->GetImplicitSolver();
+			m_SimMetrics.solverIterations = solver.GetLastIterations();
+			m_SimMetrics.solverResidual = solver.GetLastResidual();
+
+			m_SimMetrics.adaptiveAccepted = m_Softbodies[0]->GetAcceptedSteps();
+			m_SimMetrics.adaptiveRejected = m_Softbodies[0]->GetRejectedSteps();
+			m_SimMetrics.adaptiveTruncated = m_Softbodies[0]->GetTruncatedSteps();
+			m_SimMetrics.adaptiveStep = m_Softbodies[0]->GetAdaptiveStep();
+
+			const ProjectiveDynamicsSolver& projective = m_Softbodies[0]->GetProjectiveSolver();
+			m_SimMetrics.pdFactorizations = projective.GetFactorizationCount();
+			m_SimMetrics.pdSingular = projective.IsSingular();
+			m_SimMetrics.pdFactorNonZeros = projective.GetFactorNonZeros();
+
+			m_SimMetrics.bodyPairs = m_BodyCollisions.GetPairCount();
+			m_SimMetrics.bodyContacts = m_BodyCollisions.GetContactCount();
+			m_SimMetrics.selfContacts = m_Softbodies[0]->GetSelfCollision().GetContactCount();
+
+			m_SimMetrics.meshContacts = 0;
+			for (size_t contacts : m_MeshContacts)
+				m_SimMetrics.meshContacts += contacts;
+
+			m_SimMetrics.sweptContacts = 0;
+			for (size_t contacts : m_SweptContacts)
+				m_SimMetrics.sweptContacts += contacts;
+
+			m_SimMetrics.sleepingBodies = 0;
+			for (auto& sb : m_Softbodies)
+				if (sb->IsAsleep()) m_SimMetrics.sleepingBodies++;
+
+			m_SimMetrics.obstacleContacts = 0;
+			for (const ColliderBins& bins : m_ObstacleBins)
+				m_SimMetrics.obstacleContacts += bins.contactCount;
+		}
+	});
+
+	TaskGraph::TaskId renderPrep = m_FrameGraph.AddTask("render prep", [this]()
+	{
+		for (auto& sb : m_Softbodies)
+			sb->UploadChangedBuffers();
+		if (m_StepOnce) m_StepOnce = false;
+	}, TaskAffinity::Main);
+
+	TaskGraph::TaskId physics = m_FrameGraph.AddTask("physics", [this]() { StepPhysics(); });
+
+	m_FrameGraph.AddDependency(input, physics);
+	m_FrameGraph.AddDependency(physics, metrics);
+	m_FrameGraph.AddDependency(metrics, renderPrep);
+}
+
+// Bodies step in parallel; between steps the body-body collision pass
+// sees every body at the same point in time. Model colliders are static
+// during the frame, so each body resolves against them on its own.
+void Application::StepPhysics()
+{
+	size_t count = m_Softbodies.size();
+
+	if (m_SimParams.ChangesDynamics(m_LastSimParams))
+		for (auto& sb : m_Softbodies)
+			sb->OnDynamicsChanged();
+	m_LastSimParams = m_SimParams;
+
+	// Simulation space is world space minus the shared object position
+	glm::mat4 localToWorld = glm::translate(glm::mat4(1.0f), m_SimParams.objectPosition);
+	m_MeshColliders.clear();
+	m_SdfColliders.clear();
+	for (auto& model : m_Models)
+	{
+		if (!model->IsCollisionEnabled() || model->GetCollider().IsEmpty()) continue;
+
+		glm::mat4 localToCollider = glm::inverse(model->GetTransform().GetModelMatrix()) * localToWorld;
+		if (model->IsUsingSdf())
+		{
+			SdfColliderInstance instance;
+			instance.field = &model->GetSdf();
+			instance.localToCollider = localToCollider;
+			m_SdfColliders.push_back(instance);
+			continue;
+		}
+
+		MeshColliderInstance instance;
+		instance.collider = &model->GetCollider();
+		instance.localToCollider = localToCollider;
+		instance.colliderToLocal = glm::inverse(localToCollider);
+		m_MeshColliders.push_back(instance);
+	}
+	m_MeshContacts.assign(count, 0);
+	m_SweptContacts.assign(count, 0);
+
+	m_Obstacles.Update(m_SimParams.objectPosition, m_SimParams.bodyThickness);
+	m_ObstacleBins.resize(count);
+	ParallelFor(0, count, 1, [this](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			m_Softbodies[i]->BeginUpdate(m_Substeps, m_SimParams);
+	});
+
+	for (int s = 0; s < m_Substeps; s++)
+	{
+		bool lastStep = (s == m_Substeps - 1);
+		ParallelFor(0, count, 1, [this, lastStep](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				m_MeshContacts[i] = 0;
+				m_SweptContacts[i] = 0;
+				m_ObstacleBins[i].contactCount = 0;
+				if (m_Softbodies[i]->IsAsleep()) continue;
+
+				m_Softbodies[i]->StepOnce(m_SimParams, m_SimParams.collider, lastStep);
+				ParticleStore& particles = m_Softbodies[i]->GetParticles();
+
+				// Swept passes first, so a path through a thin part ends in
+				// front of it before the discrete passes look at the end point
+				const std::vector<glm::vec3>& starts = m_Softbodies[i]->GetStepStartPositions();
+				if (m_SimParams.continuousCollision)
+				{
+					for (const MeshColliderInstance& mesh : m_MeshColliders)
+						m_SweptContacts[i] += mesh.collider->ResolveSwept(particles, starts,
+							mesh.localToCollider, mesh.colliderToLocal, m_SimParams.bodyThickness,
+							m_SimParams.collider.restitution);
+					for (const SdfColliderInstance& sdf : m_SdfColliders)
+						m_SweptContacts[i] += sdf.field->ResolveSwept(particles, starts, sdf.localToCollider,
+							m_SimParams.bodyThickness, m_SimParams.collider.restitution);
+					m_SweptContacts[i] += m_Obstacles.ResolveSwept(particles, starts,
+						m_SimParams.bodyThickness, m_SimParams.collider.restitution);
+				}
+
+				for (const MeshColliderInstance& mesh : m_MeshColliders)
+					m_MeshContacts[i] += mesh.collider->Resolve(particles,
+						mesh.localToCollider, mesh.colliderToLocal, m_SimParams.bodyThickness,
+						m_SimParams.collider.restitution, m_SimParams.GetPhysicsStep());
+				for (const SdfColliderInstance& sdf : m_SdfColliders)
+					m_MeshContacts[i] += sdf.field->Resolve(particles, sdf.localToCollider,
+						m_SimParams.bodyThickness, m_SimParams.collider.restitution);
+
+				m_Obstacles.Resolve(particles, m_ObstacleBins[i],
+					m_SimParams.bodyThickness, m_SimParams.collider.restitution);
+			}
+		});
+
+		if (m_SimParams.bodyCollisions)
+			m_BodyCollisions.Resolve(m_Softbodies, m_SimParams.bodyThickness,
+				SLEEP_WAKE_FACTOR * m_SimParams.sleepSpeed);
+	}
+
+	ParallelFor(0, count, 1, [this](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			m_Softbodies[i]->EndUpdate(m_RenderAlpha);
+	});
+}
+
 void Application::Shutdown()
 {
 	m_Models.clear();
@@ -236,22 +446,117 @@ void Application::ToggleGrid()
 	m_Scene->SetDrawGrid();
 }
 
+void Application::AddSoftbodies(int count)
+{
+	// Simulation space is world space minus the shared object position
+	glm::vec3 lo = m_SimParams.collider.min - m_SimParams.objectPosition;
+	glm::vec3 hi = m_SimParams.collider.max - m_SimParams.objectPosition;
+
+	// Bodies are spawned on a grid one inflated diameter apart (the unit
+	// sphere swells to radius ~2 at the default 500 moles; shape matching
+	// and FEM bodies keep their rest size), layer by layer above the current pile;
+	// spawning stops when the box is full
+	SoftbodyModel model = m_SimParams.spawnModel;
+	const float spacing = (model != SoftbodyModel::MassSpring) ? 2.4f : 4.4f;
+	int columns = std::max(1, static_cast<int>((hi.x - lo.x) / spacing));
+	int rows = std::max(1, static_cast<int>((hi.z - lo.z) / spacing));
+
+	float base = lo.y + 0.5f * spacing;
+	for (auto& sb : m_Softbodies)
+		base = std::max(base, sb->GetBoundingBox()[1].y + 0.5f * spacing);
+
+	for (int n = 0; n < count; n++)
+	{
+		int layer = n / (columns * rows);
+		int cell = n % (columns * rows);
+		float y = base + layer * spacing;
+		if (y + 0.5f * spacing > hi.y) break;
+
+		// Small golden-ratio jitter so stacked bodies do not balance perfectly
+		float jitter = std::fmod(m_Softbodies.size() * 0.6180340f, 1.0f) - 0.5f;
+		glm::vec3 offset(lo.x + (cell % columns + 0.5f) * spacing + 0.2f * jitter, y,
+						 lo.z + (cell / columns + 0.5f) * spacing - 0.2f * jitter);
+
+		m_Softbodies.push_back(std::make_unique<Softbody>(0, 1.0f, m_SimParams.moles, offset, model,
+														  m_SimParams.renderDetail));
+	}
+}
+
+bool Application::AddSoftbodyFromModel(int index, SurfaceReport& report)
+{
+	if (index < 0 || index >= static_cast<int>(m_Models.size())) return false;
+
+	// The collider holds the model's unwelded CPU geometry
+	const MeshCollider& collider = m_Models[index]->GetCollider();
+	size_t budget = static_cast<size_t>(std::max(0, m_SimParams.importParticleBudget));
+	SimulationSurface surface = SurfaceBuilder::Build(collider.GetPositions(), collider.GetTriangles(),
+													  budget, 1.0f, report);
+	if (!report.IsClosedManifold() || surface.triangles.empty()) return false;
+
+	// Unit radius like the spawned spheres, centered over the box above the pile
+	glm::vec3 lo = m_SimParams.collider.min - m_SimParams.objectPosition;
+	glm::vec3 hi = m_SimParams.collider.max - m_SimParams.objectPosition;
+	float y = lo.y + 1.2f;
+	for (auto& sb : m_Softbodies)
+		y = std::max(y, sb->GetBoundingBox()[1].y + 1.2f);
+	glm::vec3 offset(0.5f * (lo.x + hi.x), std::min(y, hi.y - 1.0f), 0.5f * (lo.z + hi.z));
+
+	// A decimated body can still draw the full surface, carried by the
+	// simulated one (same normalization, so the two line up)
+	SimulationSurface render;
+	if (m_SimParams.renderDetail > 0 && report.weldedVertices > surface.positions.size())
+	{
+		SurfaceReport renderReport;
+		render = SurfaceBuilder::Build(collider.GetPositions(), collider.GetTriangles(), 0, 1.0f, renderReport);
+	}
+
+	m_Softbodies.push_back(std::make_unique<Softbody>(surface, m_SimParams.moles, offset, m_SimParams.spawnModel,
+													  render.positions.empty() ? nullptr : &render));
+	return true;
+}
+
+void Application::AddObstacle(ColliderShape shape)
+{
+	ColliderPrimitive obstacle;
+	obstacle.shape = shape;
+	glm::vec3 center = 0.5f * (m_SimParams.collider.min + m_SimParams.collider.max);
+	obstacle.position = glm::vec3(center.x, m_SimParams.collider.min.y + 0.5f, center.z);
+	m_Obstacles.Add(obstacle);
+	WakeSoftbodies();
+}
+
+void Application::RemoveObstacle(int index)
+{
+	if (index >= 0)
+		m_Obstacles.Remove(static_cast<size_t>(index));
+	WakeSoftbodies();
+}
+
+void Application::WakeSoftbodies()
+{
+	for (auto& sb : m_Softbodies)
+		sb->Wake();
+}
+
 void Application::LoadModel(const std::string& path)
 {
 	auto model = std::make_unique<Model>(path);
 	m_Models.push_back(std::move(model));
+	WakeSoftbodies();
 }
 
 void Application::RemoveModel(int index)
 {
 	if (index >= 0 && index < static_cast<int>(m_Models.size()))
+	{
 		m_Models.erase(m_Models.begin() + index);
+		WakeSoftbodies();
+	}
 }
 
 void Application::CaptureSnapshot()
 {
-	const char* methodNames[] = { "Forward Euler", "Midpoint (2nd Order)", "Implicit Euler" };
-	const char* method = methodNames[static_cast<int>(m_SimParams.integrationMethod)];
+	const char* method = INTEGRATION_METHOD_NAMES[static_cast<int>(m_SimParams.integrationMethod)];
 
 	const char* volMethodNames[] = { "AABB", "Bounding Sphere", "Bounding Ellipsoid", "Exact (Divergence Thm)" };
 	const char* volMethod = volMethodNames[static_cast<int>(m_SimParams.volumeMethod)];
@@ -362,3 +667,30 @@ void Application::CaptureSnapshot()
 	fflush(stdout);
 }
 
+void Application::BenchmarkPrecision()
+{
+	if (m_Softbodies.empty()) return;
+
+	const Softbody& sb = *m_Softbodies[0];
+	std::vector<PrecisionBenchmarkResult> results =
+		PrecisionBenchmark::Run(sb.GetParticles(), sb.GetSurface());
+	if (results.empty()) return;
+
+	printf("\n");
+	printf("Precision benchmark: %zu faces (body 0 tiled), best of 5\n", results[0].faces);
+	printf("  %-42s %10s %10s %16s %12s\n", "Mode", "Volume ms", "Energy ms", "Volume", "Rel. Error");
+	for (const PrecisionBenchmarkResult& r : results)
+	{
+		printf("  %-42s %10.3f %10.3f %16.6f %12.3e\n", PRECISION_MODE_NAMES[static_cast<int>(r.mode)],
+			r.volumeMs, r.energyMs, r.volume, r.relativeError);
+	}
+	printf("CSV Headers: mode, faces, volume_ms, energy_ms, volume, rel_error\n");
+	for (const PrecisionBenchmarkResult& r : results)
+	{
+		printf("CSV: %s, %zu, %.4f, %.4f, %.6f, %.3e\n", PRECISION_MODE_NAMES[static_cast<int>(r.mode)],
+			r.faces, r.volumeMs, r.energyMs, r.volume, r.relativeError);
+	}
+	printf("\n");
+
+	fflush(stdout);
+}
@@ -2,6 +2,7 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <chrono>
 #include <memory>
 #include <vector>
 #include <string>
@@ -13,6 +14,10 @@
 #include "Softbody.h"
 #include "Model.h"
 #include "SimulationParams.h"
+#include "TaskGraph.h"
+#include "SimulationClock.h"
+#include "BodyCollisionSystem.h"
+#include "ColliderSet.h"
 
 class InputHandler;
 class ImGuiLayer;
@@ -38,6 +43,7 @@ private:
 	std::unique_ptr<SimulationUI> m_SimUI;
 
 	SimulationParams m_SimParams;
+	SimulationParams m_LastSimParams;   // as of the last physics step, to wake bodies on changes
 	SimulationMetrics m_SimMetrics;
 	bool m_Wireframe = true;
 	bool m_SimRunning = false;
@@ -47,6 +53,20 @@ private:
 	double m_DeltaTime = 0.0;
 	double m_LastTime = 0.0;
 
+	// Frame task graph and the state its tasks hand to each other
+	TaskGraph m_FrameGraph;
+	SimulationClock m_Clock;
+	BodyCollisionSystem m_BodyCollisions;
+	std::vector<MeshColliderInstance> m_MeshColliders;
+	std::vector<SdfColliderInstance> m_SdfColliders;
+	std::vector<size_t> m_MeshContacts;   // per body, last step
+	std::vector<size_t> m_SweptContacts;  // per body, last step
+	ColliderSet m_Obstacles;
+	std::vector<ColliderBins> m_ObstacleBins;   // per body
+	int m_Substeps = 0;
+	float m_RenderAlpha = 1.0f;
+	std::chrono::high_resolution_clock::time_point m_PhysicsStart;
+
 public:
 	Application();
 	~Application();
@@ -60,21 +80,43 @@ public:
 	void ResetSimulation();
 	void ToggleGrid();
 
+	// Drops `count` new bodies into the collider box above the existing ones
+	void AddSoftbodies(int count);
+
+	// Simulated copy of a loaded Model (welded, decimated to the particle
+	// budget), dropped above the pile; false when its surface is not a
+	// closed manifold, with the defects in report
+	bool AddSoftbodyFromModel(int index, SurfaceReport& report);
+
+	// Places a default-sized obstacle on the floor of the collider box
+	void AddObstacle(ColliderShape shape);
+	void RemoveObstacle(int index);
+
+	// Sleeping bodies resume simulating (scene edits, drags)
+	void WakeSoftbodies();
+
 	void LoadModel(const std::string& path);
 	void RemoveModel(int index);
 
 	void CaptureSnapshot();
 
+	// Times the volume/energy reductions of body 0 in every precision mode
+	// on a tiled copy of its surface and prints the table
+	void BenchmarkPrecision();
+
 	Camera& GetCamera() { return *m_Camera; }
 	double GetDeltaTime() const { return m_DeltaTime; }
 	void SetWindowSize(unsigned int w, unsigned int h) { m_WindowWidth = w; m_WindowHeight = h; }
 	SimulationParams& GetSimParams() { return m_SimParams; }
 	const std::vector<std::unique_ptr<Softbody>>& GetSoftbodies() const { return m_Softbodies; }
 	const std::vector<std::unique_ptr<Model>>& GetModels() const { return m_Models; }
+	ColliderSet& GetObstacles() { return m_Obstacles; }
 
 private:
 	bool Init();
 	void MainLoop();
+	void BuildFrameGraph();
+	void StepPhysics();
 	void Shutdown();
 	float GetAspectRatio() const;
 };
@@ -154,6 +154,7 @@ void InputHandler::CursorCallback(GLFWwindow* window, double xpos, double ypos)
 				params.collider.max += delta;
 				params.colliderPosition = newPos;
 			}
+			handler->m_App->WakeSoftbodies();
 		}
 
 		handler->m_LastX = xpos;
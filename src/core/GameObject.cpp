@@ -64,13 +64,17 @@ void GameObject::CalculateBoundingBox()
 
 void GameObject::Update(bool BEGIN_SIMULATION, const glm::vec3& position)
 {
-	(*m_Mesh).UpdateBuffers();
 	CalculateBoundingBox();
 
 	m_Transform.SetScale(glm::vec3(m_Size));
 	m_Transform.SetTranslation(position);
 }
 
+void GameObject::UploadBuffers()
+{
+	(*m_Mesh).UpdateBuffers();
+}
+
 void GameObject::Draw()
 {
 	(*m_Mesh).Draw();
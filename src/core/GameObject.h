@@ -32,6 +32,9 @@ public:
 	inline Transform& GetTransform() { return m_Transform; }
 	inline float& GetSize() { return m_Size; }
 
+	// CPU-side only (bounding box + transform); safe to call from job threads
 	void Update(bool BEGIN_SIMULATION, const glm::vec3& position = glm::vec3(0.0f));
+	// Pushes mesh vertices to the GPU; GL context thread only
+	void UploadBuffers();
 	void Draw();
 };
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+
+// Index of the calling thread's own queue (0 = shared queue for non-workers)
+static thread_local size_t t_QueueIndex = 0;
+
+// Oversubscribe ranges a little so stolen work evens out uneven chunks
+static const size_t CHUNKS_PER_THREAD = 4;
+
+JobSystem::JobSystem(size_t workerCount)
+{
+	m_Queues.reserve(workerCount + 1);
+	for (size_t i = 0; i < workerCount + 1; i++)
+		m_Queues.push_back(std::make_unique<WorkQueue>());
+
+	m_Workers.reserve(workerCount);
+	for (size_t i = 0; i < workerCount; i++)
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i + 1);
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Running = false;
+	}
+	m_WakeUp.notify_all();
+
+	for (auto& worker : m_Workers)
+		worker.join();
+}
+
+JobSystem& JobSystem::Get()
+{
+	static JobSystem instance(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	return instance;
+}
+
+void JobSystem::Submit(Job job, JobCounter& counter)
+{
+	counter.pending.fetch_add(1, std::memory_order_relaxed);
+
+	WorkQueue& queue = *m_Queues[t_QueueIndex];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back({ std::move(job), &counter });
+	}
+	m_Queued.fetch_add(1, std::memory_order_release);
+	m_WakeUp.notify_one();
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+	while (counter.pending.load(std::memory_order_acquire) > 0)
+	{
+		if (!RunOne())
+			std::this_thread::yield();
+	}
+}
+
+bool JobSystem::RunOne()
+{
+	Task task;
+	if (!PopOrSteal(t_QueueIndex, task))
+		return false;
+
+	task.fn();
+	task.counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+	return true;
+}
+
+bool JobSystem::PopOrSteal(size_t ownQueue, Task& out)
+{
+	if (m_Queued.load(std::memory_order_acquire) <= 0)
+		return false;
+
+	// Own queue first, newest job (LIFO)
+	{
+		WorkQueue& queue = *m_Queues[ownQueue];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			out = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			m_Queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// Then steal the oldest job (FIFO) from the others
+	size_t count = m_Queues.size();
+	for (size_t i = 1; i < count; i++)
+	{
+		WorkQueue& victim = *m_Queues[(ownQueue + i) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			out = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			m_Queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::WorkerLoop(size_t queueIndex)
+{
+	t_QueueIndex = queueIndex;
+
+	while (m_Running)
+	{
+		if (RunOne()) continue;
+
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_WakeUp.wait_for(lock, std::chrono::milliseconds(2), [this]()
+		{
+			return !m_Running || m_Queued.load(std::memory_order_acquire) > 0;
+		});
+	}
+}
+
+size_t JobSystem::GetChunkCount(size_t count, size_t grain) const
+{
+	if (m_Workers.empty()) return 1;
+
+	size_t byGrain = count / std::max<size_t>(1, grain);
+	return std::max<size_t>(1, std::min(byGrain, GetThreadCount() * CHUNKS_PER_THREAD));
+}
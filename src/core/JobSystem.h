@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Number of jobs still outstanding in a batch; Wait() returns once it hits zero
+struct JobCounter
+{
+	std::atomic<int> pending{ 0 };
+};
+
+// Work-stealing thread pool.
+// Every worker owns a deque: it pushes and pops its own jobs LIFO (hot in
+// cache) and, when empty, steals FIFO from the other deques. Threads that
+// are not workers (the main thread) submit into a shared queue. Waiting is
+// never idle: a thread blocked on a counter keeps executing pending jobs,
+// which makes nested ParallelFor calls from inside jobs safe.
+class JobSystem
+{
+public:
+	using Job = std::function<void()>;
+
+private:
+	struct Task
+	{
+		Job fn;
+		JobCounter* counter = nullptr;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	// queue 0 is shared by external threads, queue i + 1 belongs to worker i
+	std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+	std::vector<std::thread> m_Workers;
+
+	std::atomic<bool> m_Running{ true };
+	std::atomic<int> m_Queued{ 0 };
+	std::mutex m_SleepMutex;
+	std::condition_variable m_WakeUp;
+
+public:
+	explicit JobSystem(size_t workerCount);
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// Process-wide pool sized to the machine (hardware threads - 1 workers)
+	static JobSystem& Get();
+
+	void Submit(Job job, JobCounter& counter);
+	void Wait(JobCounter& counter);
+
+	// Executes one queued job on the calling thread; false if none was found
+	bool RunOne();
+
+	// Worker threads plus the calling thread
+	inline size_t GetThreadCount() const { return m_Workers.size() + 1; }
+
+	// Runs fn(rangeBegin, rangeEnd) over [begin, end) split into ranges of at
+	// least `grain` items. Ranges must write disjoint data.
+	template <typename Fn>
+	void ParallelFor(size_t begin, size_t end, size_t grain, const Fn& fn);
+
+	// Maps each range to a partial result with map(rangeBegin, rangeEnd) and
+	// folds the partials in range order, so the result is deterministic.
+	template <typename T, typename Map, typename Combine>
+	T ParallelReduce(size_t begin, size_t end, size_t grain, T identity,
+					 const Map& map, const Combine& combine);
+
+private:
+	void WorkerLoop(size_t queueIndex);
+	bool PopOrSteal(size_t ownQueue, Task& out);
+	size_t GetChunkCount(size_t count, size_t grain) const;
+};
+
+template <typename Fn>
+void JobSystem::ParallelFor(size_t begin, size_t end, size_t grain, const Fn& fn)
+{
+	if (end <= begin) return;
+
+	size_t chunks = GetChunkCount(end - begin, grain);
+	if (chunks <= 1)
+	{
+		fn(begin, end);
+		return;
+	}
+
+	size_t step = (end - begin + chunks - 1) / chunks;
+
+	JobCounter counter;
+	for (size_t first = begin + step; first < end; first += step)
+	{
+		size_t last = std::min(first + step, end);
+		Submit([&fn, first, last]() { fn(first, last); }, counter);
+	}
+
+	fn(begin, std::min(begin + step, end));
+	Wait(counter);
+}
+
+template <typename T, typename Map, typename Combine>
+T JobSystem::ParallelReduce(size_t begin, size_t end, size_t grain, T identity,
+							const Map& map, const Combine& combine)
+{
+	if (end <= begin) return identity;
+
+	size_t chunks = GetChunkCount(end - begin, grain);
+	if (chunks <= 1)
+		return combine(identity, map(begin, end));
+
+	size_t step = (end - begin + chunks - 1) / chunks;
+	std::vector<T> partials(chunks, identity);
+
+	ParallelFor(0, chunks, 1, [&](size_t firstChunk, size_t lastChunk)
+	{
+		for (size_t c = firstChunk; c < lastChunk; c++)
+		{
+			size_t first = begin + c * step;
+			if (first < end)
+				partials[c] = map(first, std::min(first + step, end));
+		}
+	});
+
+	T result = identity;
+	for (const T& partial : partials)
+		result = combine(result, partial);
+	return result;
+}
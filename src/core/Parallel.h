@@ -0,0 +1,21 @@
+#pragma once
+
+#include "JobSystem.h"
+
+// Splits [begin, end) into ranges of at least `grain` items and runs
+// fn(rangeBegin, rangeEnd) for each of them on the shared JobSystem. The
+// calling thread takes part. Callers must make ranges write disjoint data.
+template <typename Fn>
+void ParallelFor(size_t begin, size_t end, size_t grain, const Fn& fn)
+{
+	JobSystem::Get().ParallelFor(begin, end, grain, fn);
+}
+
+// Deterministic parallel reduction: map(rangeBegin, rangeEnd) -> T per range,
+// folded with combine(a, b) in range order.
+template <typename T, typename Map, typename Combine>
+T ParallelReduce(size_t begin, size_t end, size_t grain, T identity,
+				 const Map& map, const Combine& combine)
+{
+	return JobSystem::Get().ParallelReduce(begin, end, grain, identity, map, combine);
+}
@@ -0,0 +1,43 @@
+#include "SimulationClock.h"
+#include <algorithm>
+
+// Longest frame we try to catch up on (e.g. after a breakpoint or window drag)
+static const double MAX_FRAME_TIME = 0.25;
+
+int SimulationClock::Advance(double frameTime, float step, int maxSubsteps)
+{
+	if (step <= 0.0f || maxSubsteps <= 0)
+	{
+		m_LastSubsteps = 0;
+		return 0;
+	}
+
+	if (frameTime > MAX_FRAME_TIME)
+	{
+		m_DroppedTime += frameTime - MAX_FRAME_TIME;
+		frameTime = MAX_FRAME_TIME;
+	}
+	m_Accumulator += std::max(0.0, frameTime);
+
+	int steps = static_cast<int>(m_Accumulator / step);
+	if (steps > maxSubsteps)
+	{
+		// Keep the fractional part so interpolation stays continuous
+		double backlog = (steps - maxSubsteps) * static_cast<double>(step);
+		m_DroppedTime += backlog;
+		m_Accumulator -= backlog;
+		steps = maxSubsteps;
+	}
+
+	m_Accumulator -= steps * static_cast<double>(step);
+	m_Alpha = static_cast<float>(m_Accumulator / step);
+	m_LastSubsteps = steps;
+	return steps;
+}
+
+void SimulationClock::Reset()
+{
+	m_Accumulator = 0.0;
+	m_Alpha = 1.0f;
+	m_LastSubsteps = 0;
+}
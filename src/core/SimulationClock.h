@@ -0,0 +1,30 @@
+#pragma once
+
+// Fixed-timestep accumulator (Fiedler, "Fix Your Timestep").
+// Wall-clock frame time is banked and spent in whole physics steps, so the
+// simulated time advances at real-time speed regardless of frame rate. The
+// leftover fraction of a step is exposed as an interpolation factor for
+// rendering between the last two physics states.
+class SimulationClock
+{
+private:
+	double m_Accumulator = 0.0;
+	float m_Alpha = 1.0f;
+	int m_LastSubsteps = 0;
+	double m_DroppedTime = 0.0;
+
+public:
+	SimulationClock() = default;
+
+	// Banks frameTime and returns how many steps of `step` seconds to run now.
+	// Never returns more than maxSubsteps; any backlog beyond that is dropped
+	// so a slow frame cannot snowball into ever longer frames.
+	int Advance(double frameTime, float step, int maxSubsteps);
+
+	void Reset();
+
+	// Fraction of a step left in the accumulator: 0 = previous state, 1 = current
+	inline float GetAlpha() const { return m_Alpha; }
+	inline int GetLastSubsteps() const { return m_LastSubsteps; }
+	inline double GetDroppedTime() const { return m_DroppedTime; }
+};
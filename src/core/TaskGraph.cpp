@@ -0,0 +1,92 @@
+#include "TaskGraph.h"
+
+TaskGraph::TaskId TaskGraph::AddTask(const std::string& name, std::function<void()> fn,
+									 TaskAffinity affinity)
+{
+	Node node;
+	node.name = name;
+	node.fn = std::move(fn);
+	node.affinity = affinity;
+	m_Nodes.push_back(std::move(node));
+	return static_cast<TaskId>(m_Nodes.size() - 1);
+}
+
+void TaskGraph::AddDependency(TaskId before, TaskId after)
+{
+	m_Nodes[before].successors.push_back(after);
+	m_Nodes[after].predecessorCount++;
+}
+
+void TaskGraph::Clear()
+{
+	m_Nodes.clear();
+}
+
+void TaskGraph::Run(JobSystem& jobs)
+{
+	size_t count = m_Nodes.size();
+	if (count == 0) return;
+
+	m_Remaining.reset(new std::atomic<uint32_t>[count]);
+	for (size_t i = 0; i < count; i++)
+		m_Remaining[i].store(m_Nodes[i].predecessorCount, std::memory_order_relaxed);
+	m_Completed = 0;
+	m_MainReady.clear();
+
+	JobCounter counter;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (m_Nodes[i].predecessorCount == 0)
+			Dispatch(static_cast<TaskId>(i), jobs, counter);
+	}
+
+	// The calling thread owns Main tasks and helps with pool jobs in between
+	while (m_Completed.load(std::memory_order_acquire) < count)
+	{
+		TaskId mainTask = 0;
+		bool haveMain = false;
+		{
+			std::lock_guard<std::mutex> lock(m_MainMutex);
+			if (!m_MainReady.empty())
+			{
+				mainTask = m_MainReady.back();
+				m_MainReady.pop_back();
+				haveMain = true;
+			}
+		}
+
+		if (haveMain)
+			Execute(mainTask, jobs, counter);
+		else if (!jobs.RunOne())
+			std::this_thread::yield();
+	}
+
+	// Pool jobs decrement the counter after the task body returns
+	jobs.Wait(counter);
+}
+
+void TaskGraph::Dispatch(TaskId id, JobSystem& jobs, JobCounter& counter)
+{
+	if (m_Nodes[id].affinity == TaskAffinity::Main)
+	{
+		std::lock_guard<std::mutex> lock(m_MainMutex);
+		m_MainReady.push_back(id);
+		return;
+	}
+
+	jobs.Submit([this, id, &jobs, &counter]() { Execute(id, jobs, counter); }, counter);
+}
+
+void TaskGraph::Execute(TaskId id, JobSystem& jobs, JobCounter& counter)
+{
+	Node& node = m_Nodes[id];
+	if (node.fn) node.fn();
+
+	for (TaskId next : node.successors)
+	{
+		if (m_Remaining[next].fetch_sub(1, std::memory_order_acq_rel) == 1)
+			Dispatch(next, jobs, counter);
+	}
+
+	m_Completed.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "JobSystem.h"
+
+// Where a task may execute. Main tasks (GLFW input, ImGui, GL uploads) only
+// run on the thread that calls Run(); Any tasks go to the job system.
+enum class TaskAffinity { Any, Main };
+
+// Small dependency graph of per-frame work.
+// Tasks are added once, wired with AddDependency, then Run() executes every
+// task exactly once as soon as all of its predecessors have finished. The
+// graph can be rebuilt each frame or kept and re-run.
+class TaskGraph
+{
+public:
+	using TaskId = uint32_t;
+
+private:
+	struct Node
+	{
+		std::string name;
+		std::function<void()> fn;
+		TaskAffinity affinity = TaskAffinity::Any;
+		std::vector<TaskId> successors;
+		uint32_t predecessorCount = 0;
+	};
+
+	std::vector<Node> m_Nodes;
+
+	// Per-run state
+	std::unique_ptr<std::atomic<uint32_t>[]> m_Remaining;
+	std::atomic<size_t> m_Completed{ 0 };
+	std::mutex m_MainMutex;
+	std::vector<TaskId> m_MainReady;
+
+public:
+	TaskGraph() = default;
+
+	TaskId AddTask(const std::string& name, std::function<void()> fn,
+				   TaskAffinity affinity = TaskAffinity::Any);
+
+	// `after` will not start until `before` has finished
+	void AddDependency(TaskId before, TaskId after);
+
+	void Run(JobSystem& jobs);
+	void Clear();
+
+	inline size_t GetTaskCount() const { return m_Nodes.size(); }
+	inline const std::string& GetTaskName(TaskId id) const { return m_Nodes[id].name; }
+
+private:
+	void Dispatch(TaskId id, JobSystem& jobs, JobCounter& counter);
+	void Execute(TaskId id, JobSystem& jobs, JobCounter& counter);
+};
@@ -1,9 +1,13 @@
 #include "Mesh.h"
 #include <glad/glad.h>
 
-Mesh::Mesh()
+Mesh::Mesh() : Mesh(2)
 {
-	auto icosphereIndexedMesh = MakeIcosphere(2);
+}
+
+Mesh::Mesh(int subdivisions)
+{
+	auto icosphereIndexedMesh = MakeIcosphere(subdivisions);
 	SetVertices(icosphereIndexedMesh.first);
 	SetIndices(icosphereIndexedMesh.second);
 
@@ -29,6 +29,8 @@ protected:
 
 public:
 	Mesh();
+	// Unit icosphere refined `subdivisions` times
+	explicit Mesh(int subdivisions);
 	Mesh(std::vector<Vertex> vertices, std::vector<Triangle> indices);
 	Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices,
 	     std::vector<TextureInfo> textures);
@@ -41,6 +43,8 @@ public:
 	void Draw(Shader& shader) const;
 
 	inline const std::vector<Vertex>& GetVertices() { return m_Vertices; }
+	// In-place access for per-frame vertex updates (no reallocation)
+	inline std::vector<Vertex>& GetVerticesForWrite() { return m_Vertices; }
 	inline const std::vector<Triangle>& GetIndices() { return m_Indices; }
 	inline bool HasTextures() const { return !m_Textures.empty(); }
 
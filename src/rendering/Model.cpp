@@ -5,6 +5,9 @@
 #include <iostream>
 #include <cstring>
 
+// Baked distance fields, keyed by geometry hash (relative to the working directory)
+static const char* SDF_CACHE_DIRECTORY = "cache/sdf";
+
 Model::Model(const std::string& path)
     : m_Path(path)
 {
@@ -17,6 +20,18 @@ void Model::Draw(Shader& shader) const
         mesh->Draw(shader);
 }
 
+SdfSource Model::SetUseSdf(bool useSdf, int resolution)
+{
+    m_UseSdf = useSdf;
+    if (!useSdf)
+        return SdfSource::None;
+    if (!m_Sdf.IsEmpty() && m_SdfResolution == resolution)
+        return SdfSource::Reused;
+
+    m_SdfResolution = resolution;
+    return m_Sdf.BakeCached(m_Collider, resolution, SDF_CACHE_DIRECTORY) ? SdfSource::Cache : SdfSource::Baked;
+}
+
 void Model::LoadModel(const std::string& path)
 {
     Assimp::Importer importer;
@@ -31,6 +46,12 @@ void Model::LoadModel(const std::string& path)
 
     m_Directory = path.substr(0, path.find_last_of('/'));
     ProcessNode(scene->mRootNode, scene);
+
+    // Node transforms are not applied when drawing either, so the collider
+    // matches what is rendered
+    m_Collider.Build(std::move(m_CollisionPositions), std::move(m_CollisionTriangles));
+    m_CollisionPositions.clear();
+    m_CollisionTriangles.clear();
 }
 
 void Model::ProcessNode(aiNode* node, const aiScene* scene)
@@ -53,6 +74,8 @@ std::shared_ptr<Mesh> Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
     std::vector<unsigned int> indices;
     std::vector<TextureInfo> textures;
 
+    unsigned int collisionBase = static_cast<unsigned int>(m_CollisionPositions.size());
+
     // Vertices
     for (unsigned int i = 0; i < mesh->mNumVertices; i++)
     {
@@ -90,6 +113,7 @@ std::shared_ptr<Mesh> Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
         }
 
         vertices.push_back(vertex);
+        m_CollisionPositions.push_back(vertex.Position);
     }
 
     // Indices
@@ -98,6 +122,15 @@ std::shared_ptr<Mesh> Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
         aiFace face = mesh->mFaces[i];
         for (unsigned int j = 0; j < face.mNumIndices; j++)
             indices.push_back(face.mIndices[j]);
+
+        // Triangulated on import; points and lines left over are not solid
+        if (face.mNumIndices == 3)
+        {
+            Triangle triangle;
+            for (unsigned int j = 0; j < 3; j++)
+                triangle.vertex[j] = collisionBase + face.mIndices[j];
+            m_CollisionTriangles.push_back(triangle);
+        }
     }
 
     // Materials
@@ -6,6 +6,11 @@
 #include <assimp/scene.h>
 #include "Mesh.h"
 #include "Transform.h"
+#include "MeshCollider.h"
+#include "SignedDistanceField.h"
+
+// Where Model::SetUseSdf got its field from (None: it was disabled)
+enum class SdfSource { None, Reused, Cache, Baked };
 
 class Model
 {
@@ -16,6 +21,18 @@ public:
     Transform& GetTransform() { return m_Transform; }
     const std::string& GetPath() const { return m_Path; }
 
+    // Static collider over all triangles, in model space
+    const MeshCollider& GetCollider() const { return m_Collider; }
+    bool IsCollisionEnabled() const { return m_CollisionEnabled; }
+    void SetCollisionEnabled(bool enabled) { m_CollisionEnabled = enabled; }
+
+    // Collide against a baked distance field instead of the triangles.
+    // Enabling it reuses the field already in memory, or else loads it
+    // from the disk cache or bakes it; returns which one happened
+    SdfSource SetUseSdf(bool useSdf, int resolution = SDF_DEFAULT_RESOLUTION);
+    bool IsUsingSdf() const { return m_UseSdf && !m_Sdf.IsEmpty(); }
+    const SignedDistanceField& GetSdf() const { return m_Sdf; }
+
 private:
     std::vector<std::shared_ptr<Mesh>> m_Meshes;
     std::string m_Directory;
@@ -23,6 +40,15 @@ private:
     std::vector<TextureInfo> m_TexturesLoaded;
     Transform m_Transform;
 
+    // CPU copy of the geometry, gathered while loading for the collider
+    std::vector<glm::vec3> m_CollisionPositions;
+    std::vector<Triangle> m_CollisionTriangles;
+    MeshCollider m_Collider;
+    bool m_CollisionEnabled = true;
+    SignedDistanceField m_Sdf;
+    int m_SdfResolution = 0;
+    bool m_UseSdf = false;
+
     void LoadModel(const std::string& path);
     void ProcessNode(aiNode* node, const aiScene* scene);
     std::shared_ptr<Mesh> ProcessMesh(aiMesh* mesh, const aiScene* scene);
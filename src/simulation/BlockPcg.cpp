@@ -0,0 +1,91 @@
+#include "BlockPcg.h"
+#include "Parallel.h"
+#include <cmath>
+
+static const size_t PARTICLE_GRAIN = 2048;
+
+// Deterministic dot product (double accumulation, fixed range order)
+static double Dot(const std::vector<glm::vec3>& a, const std::vector<glm::vec3>& b)
+{
+	return ParallelReduce(0, a.size(), PARTICLE_GRAIN, 0.0,
+		[&](size_t first, size_t last)
+		{
+			double sum = 0.0;
+			for (size_t i = first; i < last; i++)
+				sum += static_cast<double>(glm::dot(a[i], b[i]));
+			return sum;
+		},
+		[](double x, double y) { return x + y; });
+}
+
+PcgResult BlockPcg::Solve(const BlockSparseMatrix& system, const std::vector<glm::mat3>& preconditioner,
+						  const std::vector<glm::vec3>& rhs, const std::vector<float>& inverseMasses,
+						  std::vector<glm::vec3>& x, int maxIterations, float tolerance)
+{
+	PcgResult result;
+	size_t n = rhs.size();
+
+	double rhsNorm = Dot(rhs, rhs);
+	if (rhsNorm == 0.0)
+	{
+		x.assign(n, glm::vec3(0.0f));
+		return result;
+	}
+	double threshold = static_cast<double>(tolerance) * tolerance * rhsNorm;
+
+	m_Residual.resize(n);
+	m_Direction.resize(n);
+	m_Preconditioned.resize(n);
+	m_Product.resize(n);
+
+	// r = b - A x (warm start), z = P r, p = z
+	system.Multiply(x, m_Product);
+	ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			m_Residual[i] = (inverseMasses[i] == 0.0f) ? glm::vec3(0.0f) : rhs[i] - m_Product[i];
+			m_Preconditioned[i] = preconditioner[i] * m_Residual[i];
+			m_Direction[i] = m_Preconditioned[i];
+		}
+	});
+
+	double rz = Dot(m_Residual, m_Preconditioned);
+	double residualNorm = Dot(m_Residual, m_Residual);
+
+	int iteration = 0;
+	while (iteration < maxIterations && residualNorm > threshold)
+	{
+		system.Multiply(m_Direction, m_Product);
+		double pAp = Dot(m_Direction, m_Product);
+		if (pAp <= 0.0) break;
+
+		float alpha = static_cast<float>(rz / pAp);
+		ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				x[i] += alpha * m_Direction[i];
+				if (inverseMasses[i] != 0.0f)
+					m_Residual[i] -= alpha * m_Product[i];
+				m_Preconditioned[i] = preconditioner[i] * m_Residual[i];
+			}
+		});
+		iteration++;
+
+		residualNorm = Dot(m_Residual, m_Residual);
+		double rzNext = Dot(m_Residual, m_Preconditioned);
+		float beta = static_cast<float>(rzNext / rz);
+		rz = rzNext;
+
+		ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+				m_Direction[i] = m_Preconditioned[i] + beta * m_Direction[i];
+		});
+	}
+
+	result.iterations = iteration;
+	result.residual = static_cast<float>(std::sqrt(residualNorm / rhsNorm));
+	return result;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "BlockSparseMatrix.h"
+
+struct PcgResult
+{
+	int iterations = 0;
+	float residual = 0.0f;   // |r| / |b| at exit
+};
+
+// Block-Jacobi preconditioned conjugate gradients for a symmetric positive
+// definite BlockSparseMatrix. Rows with zero inverse mass (pinned
+// particles) have their residual filtered out, so their entries of x keep
+// the warm start; their preconditioner blocks should be zero as well.
+// Dot products accumulate in double over fixed ranges, so results do not
+// depend on the thread count.
+class BlockPcg
+{
+private:
+	std::vector<glm::vec3> m_Residual;
+	std::vector<glm::vec3> m_Direction;
+	std::vector<glm::vec3> m_Preconditioned;
+	std::vector<glm::vec3> m_Product;
+
+public:
+	BlockPcg() = default;
+
+	// x holds the warm start and receives the solution; a zero right-hand
+	// side gives x = 0. Stops once |r| <= tolerance * |b|.
+	PcgResult Solve(const BlockSparseMatrix& system, const std::vector<glm::mat3>& preconditioner,
+					const std::vector<glm::vec3>& rhs, const std::vector<float>& inverseMasses,
+					std::vector<glm::vec3>& x, int maxIterations, float tolerance);
+};
@@ -0,0 +1,71 @@
+#include "BlockSparseMatrix.h"
+#include "Parallel.h"
+#include <algorithm>
+
+static const size_t ROW_GRAIN = 2048;
+
+void BlockSparseMatrix::BuildStructure(size_t rowCount, const std::vector<SpringEdge>& edges)
+{
+	// Each edge contributes (a, b) and (b, a); every row also owns its diagonal
+	std::vector<uint32_t> rows, cols;
+	rows.reserve(rowCount + edges.size() * 2);
+	cols.reserve(rowCount + edges.size() * 2);
+	for (size_t i = 0; i < rowCount; i++)
+	{
+		rows.push_back(static_cast<uint32_t>(i));
+		cols.push_back(static_cast<uint32_t>(i));
+	}
+	for (const SpringEdge& e : edges)
+	{
+		rows.push_back(e.a); cols.push_back(e.b);
+		rows.push_back(e.b); cols.push_back(e.a);
+	}
+
+	CsrAdjacency pattern;
+	pattern.Build(rowCount, rows, cols);
+
+	m_RowOffsets.assign(1, 0);
+	m_RowOffsets.reserve(rowCount + 1);
+	m_Columns.clear();
+	m_Columns.reserve(pattern.entries.size());
+	m_DiagonalBlocks.resize(rowCount);
+
+	for (size_t r = 0; r < rowCount; r++)
+	{
+		auto first = pattern.entries.begin() + pattern.RowBegin(r);
+		auto last = pattern.entries.begin() + pattern.RowEnd(r);
+		std::sort(first, last);
+		last = std::unique(first, last);
+
+		for (auto it = first; it != last; ++it)
+		{
+			if (*it == r)
+				m_DiagonalBlocks[r] = static_cast<uint32_t>(m_Columns.size());
+			m_Columns.push_back(*it);
+		}
+		m_RowOffsets.push_back(static_cast<uint32_t>(m_Columns.size()));
+	}
+
+	m_Blocks.assign(m_Columns.size(), glm::mat3(0.0f));
+}
+
+uint32_t BlockSparseMatrix::FindBlock(uint32_t row, uint32_t col) const
+{
+	auto first = m_Columns.begin() + m_RowOffsets[row];
+	auto last = m_Columns.begin() + m_RowOffsets[row + 1];
+	return static_cast<uint32_t>(std::lower_bound(first, last, col) - m_Columns.begin());
+}
+
+void BlockSparseMatrix::Multiply(const std::vector<glm::vec3>& x, std::vector<glm::vec3>& y) const
+{
+	ParallelFor(0, GetRowCount(), ROW_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t r = first; r < last; r++)
+		{
+			glm::vec3 sum(0.0f);
+			for (uint32_t k = m_RowOffsets[r]; k < m_RowOffsets[r + 1]; k++)
+				sum += m_Blocks[k] * x[m_Columns[k]];
+			y[r] = sum;
+		}
+	});
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "SpringTopology.h"
+
+// Square matrix of 3x3 blocks in block compressed sparse row (BSR) form.
+// The sparsity pattern (one block per particle pair joined by a spring,
+// plus the diagonal) is built once; afterwards only block values change,
+// so every step reuses the same index arrays.
+class BlockSparseMatrix
+{
+private:
+	std::vector<uint32_t> m_RowOffsets;
+	std::vector<uint32_t> m_Columns;      // sorted within each row
+	std::vector<uint32_t> m_DiagonalBlocks;
+	std::vector<glm::mat3> m_Blocks;
+
+public:
+	BlockSparseMatrix() = default;
+
+	// Symbolic phase: pattern from the spring graph, all blocks zeroed
+	void BuildStructure(size_t rowCount, const std::vector<SpringEdge>& edges);
+
+	// Index of block (row, col) in GetBlocks(); the block must exist
+	uint32_t FindBlock(uint32_t row, uint32_t col) const;
+
+	// y = A * x (parallel over rows)
+	void Multiply(const std::vector<glm::vec3>& x, std::vector<glm::vec3>& y) const;
+
+	inline size_t GetRowCount() const { return m_DiagonalBlocks.size(); }
+	inline size_t GetBlockCount() const { return m_Blocks.size(); }
+	inline uint32_t GetDiagonalBlock(size_t row) const { return m_DiagonalBlocks[row]; }
+	inline std::vector<glm::mat3>& GetBlocks() { return m_Blocks; }
+	inline const std::vector<glm::mat3>& GetBlocks() const { return m_Blocks; }
+};
@@ -0,0 +1,194 @@
+#include "BodyCollisionSystem.h"
+#include "PhysicsEngine.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <limits>
+
+void BodyCollisionSystem::Resolve(const std::vector<std::unique_ptr<Softbody>>& bodies, float thickness,
+								  float wakeSpeed)
+{
+	size_t count = bodies.size();
+	m_PairCount = 0;
+	m_ContactCount = 0;
+	if (count < 2) return;
+
+	m_BoundsMin.resize(count);
+	m_BoundsMax.resize(count);
+	m_Contacts.resize(count);
+
+	// Leaf boxes grow by the thickness, so a point query finds every face
+	// within contact range
+	ParallelFor(0, count, 1, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			if (!bodies[i]->IsAsleep())
+				bodies[i]->RefitSurfaceBvh(thickness);
+			const TriangleBvh& bvh = bodies[i]->GetSurfaceBvh();
+			m_BoundsMin[i] = bvh.IsEmpty() ? glm::vec3(0.0f) : bvh.GetMin();
+			m_BoundsMax[i] = bvh.IsEmpty() ? glm::vec3(0.0f) : bvh.GetMax();
+		}
+	});
+
+	SweepAndPrune();
+	if (m_PairCount == 0) return;
+
+	ParallelFor(0, count, 1, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			CollectContacts(bodies, static_cast<uint32_t>(i), thickness);
+	});
+
+	// Impacts wake sleeping bodies, whichever side of the contact they are on
+	float wakeSpeed2 = wakeSpeed * wakeSpeed;
+	for (size_t i = 0; i < count; i++)
+	{
+		for (const Contact& contact : m_Contacts[i])
+		{
+			if (glm::dot(contact.velocityChange, contact.velocityChange) <= wakeSpeed2) continue;
+			if (bodies[i]->IsAsleep()) bodies[i]->Wake();
+			if (bodies[contact.partner]->IsAsleep()) bodies[contact.partner]->Wake();
+		}
+	}
+
+	ParallelFor(0, count, 1, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			if (bodies[i]->IsAsleep()) continue;
+
+			auto& positions = bodies[i]->GetParticles().GetPositions();
+			auto& velocities = bodies[i]->GetParticles().GetVelocities();
+			for (const Contact& contact : m_Contacts[i])
+			{
+				positions[contact.particle] += contact.displacement;
+				velocities[contact.particle] += contact.velocityChange;
+			}
+		}
+	});
+
+	for (size_t i = 0; i < count; i++)
+		if (!bodies[i]->IsAsleep())
+			m_ContactCount += m_Contacts[i].size();
+}
+
+void BodyCollisionSystem::SweepAndPrune()
+{
+	size_t count = m_BoundsMin.size();
+	if (m_SortedBodies.size() != count)
+	{
+		m_SortedBodies.resize(count);
+		for (uint32_t i = 0; i < count; i++)
+			m_SortedBodies[i] = i;
+	}
+
+	// Bodies move little per step, so the previous order is nearly sorted
+	for (size_t k = 1; k < count; k++)
+	{
+		uint32_t body = m_SortedBodies[k];
+		float key = m_BoundsMin[body].x;
+		size_t j = k;
+		while (j > 0 && m_BoundsMin[m_SortedBodies[j - 1]].x > key)
+		{
+			m_SortedBodies[j] = m_SortedBodies[j - 1];
+			j--;
+		}
+		m_SortedBodies[j] = body;
+	}
+
+	m_PairRows.clear();
+	m_PairValues.clear();
+	for (size_t k = 0; k < count; k++)
+	{
+		uint32_t a = m_SortedBodies[k];
+		for (size_t m = k + 1; m < count; m++)
+		{
+			uint32_t b = m_SortedBodies[m];
+			if (m_BoundsMin[b].x > m_BoundsMax[a].x) break;
+
+			if (m_BoundsMin[b].y <= m_BoundsMax[a].y && m_BoundsMax[b].y >= m_BoundsMin[a].y &&
+				m_BoundsMin[b].z <= m_BoundsMax[a].z && m_BoundsMax[b].z >= m_BoundsMin[a].z)
+			{
+				m_PairRows.push_back(a); m_PairValues.push_back(b);
+				m_PairRows.push_back(b); m_PairValues.push_back(a);
+			}
+		}
+	}
+
+	m_PairCount = m_PairRows.size() / 2;
+	m_Partners.Build(count, m_PairRows, m_PairValues);
+}
+
+void BodyCollisionSystem::CollectContacts(const std::vector<std::unique_ptr<Softbody>>& bodies,
+										  uint32_t body, float thickness)
+{
+	std::vector<Contact>& contacts = m_Contacts[body];
+	contacts.clear();
+
+	const auto& positions = bodies[body]->GetParticles().GetPositions();
+	const auto& velocities = bodies[body]->GetParticles().GetVelocities();
+
+	for (uint32_t e = m_Partners.RowBegin(body); e < m_Partners.RowEnd(body); e++)
+	{
+		uint32_t other = m_Partners.entries[e];
+		const Softbody& partner = *bodies[other];
+		if (bodies[body]->IsAsleep() && partner.IsAsleep()) continue;
+		const auto& otherPositions = partner.GetParticles().GetPositions();
+		const auto& otherVelocities = partner.GetParticles().GetVelocities();
+		const auto& triangles = partner.GetSurface().GetTriangles();
+		const TriangleBvh& bvh = partner.GetSurfaceBvh();
+		const glm::vec3& boxMin = m_BoundsMin[other];
+		const glm::vec3& boxMax = m_BoundsMax[other];
+
+		for (ParticleId i = 0; i < positions.size(); i++)
+		{
+			const glm::vec3& p = positions[i];
+			if (glm::any(glm::lessThan(p, boxMin)) || glm::any(glm::greaterThan(p, boxMax)))
+				continue;
+
+			// Nearest face of the partner within the contact range
+			float bestDistance = std::numeric_limits<float>::max();
+			uint32_t bestFace = 0;
+			glm::vec3 bestPoint(0.0f), bestWeights(0.0f);
+			bvh.QuerySphere(p, 0.0f, [&](uint32_t f)
+			{
+				const Triangle& tri = triangles[f];
+				glm::vec3 weights;
+				glm::vec3 q = PhysicsEngine::ClosestPointOnTriangle(p, otherPositions[tri.vertex[0]],
+					otherPositions[tri.vertex[1]], otherPositions[tri.vertex[2]], weights);
+				float distance = glm::length(p - q);
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestFace = f;
+					bestPoint = q;
+					bestWeights = weights;
+				}
+			});
+			if (bestDistance > thickness) continue;
+
+			// Outward face normal (icosphere winding, as in ComputeSurface)
+			const Triangle& tri = triangles[bestFace];
+			const glm::vec3& a = otherPositions[tri.vertex[0]];
+			glm::vec3 normal = -glm::cross(otherPositions[tri.vertex[1]] - a, otherPositions[tri.vertex[2]] - a);
+			float length = glm::length(normal);
+			if (length < 1e-12f) continue;
+			normal /= length;
+
+			float separation = glm::dot(p - bestPoint, normal);
+			if (separation >= thickness) continue;
+
+			glm::vec3 faceVelocity = bestWeights.x * otherVelocities[tri.vertex[0]] +
+									 bestWeights.y * otherVelocities[tri.vertex[1]] +
+									 bestWeights.z * otherVelocities[tri.vertex[2]];
+			float approach = glm::dot(velocities[i] - faceVelocity, normal);
+
+			Contact contact;
+			contact.particle = i;
+			contact.partner = other;
+			contact.displacement = (thickness - separation) * normal;
+			contact.velocityChange = (approach < 0.0f) ? -approach * normal : glm::vec3(0.0f);
+			contacts.push_back(contact);
+		}
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Softbody.h"
+#include "CsrAdjacency.h"
+
+// Soft body vs soft body contacts, resolved between physics steps.
+//   1. refit  - every body's surface BVH is refit (never rebuilt); its root
+//               box is the body's bounds for the broad phase
+//   2. broad  - sweep and prune along x over the body boxes; the sorted
+//               order is kept between steps, so insertion sort is ~O(n)
+//   3. narrow - each particle inside a partner's box queries the partner's
+//               BVH and is pushed out along the nearest face normal to the
+//               contact thickness; the approaching normal velocity relative
+//               to the face is removed
+// Each body only ever writes its own particles, and contacts are gathered
+// from a consistent snapshot before any are applied, so all three phases
+// run in parallel over bodies and the result is deterministic.
+// Sleeping bodies keep their BVH and skip each other. They act as static
+// until a contact approaching faster than the wake speed touches them,
+// from either side, which wakes them.
+class BodyCollisionSystem
+{
+private:
+	struct Contact
+	{
+		ParticleId particle;
+		uint32_t partner;
+		glm::vec3 displacement;
+		glm::vec3 velocityChange;
+	};
+
+	std::vector<uint32_t> m_SortedBodies;
+	std::vector<glm::vec3> m_BoundsMin;
+	std::vector<glm::vec3> m_BoundsMax;
+
+	// Candidate partners of each body (both directions of every pair)
+	CsrAdjacency m_Partners;
+	std::vector<uint32_t> m_PairRows;
+	std::vector<uint32_t> m_PairValues;
+
+	std::vector<std::vector<Contact>> m_Contacts;
+	size_t m_PairCount = 0;
+	size_t m_ContactCount = 0;
+
+public:
+	BodyCollisionSystem() = default;
+
+	// One collision pass over all bodies (call after every physics step)
+	void Resolve(const std::vector<std::unique_ptr<Softbody>>& bodies, float thickness, float wakeSpeed);
+
+	inline size_t GetPairCount() const { return m_PairCount; }
+	inline size_t GetContactCount() const { return m_ContactCount; }
+
+private:
+	void SweepAndPrune();
+	void CollectContacts(const std::vector<std::unique_ptr<Softbody>>& bodies, uint32_t body,
+						 float thickness);
+};
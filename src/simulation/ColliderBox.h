@@ -1,7 +1,6 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include "Particle.h"
 
 struct ColliderBox
 {
@@ -36,11 +35,22 @@ struct ColliderBox
 			   (max.z >= otherMin.z && min.z <= otherMax.z);
 	}
 
+	// Position-only projection back inside the box (PBD collider constraint)
+	// Returns true if the point was outside and got clamped
+	bool ProjectPosition(glm::vec3& position) const
+	{
+		glm::vec3 clamped = glm::clamp(position, min, max);
+		bool outside = (clamped != position);
+		position = clamped;
+		return outside;
+	}
+
 	// Collision response: velocity decomposition with selective reflection
-	void ResolveCollision(std::shared_ptr<Particle>& particle) const
+	// Returns true if the particle was touching a wall and got corrected
+	bool ResolveCollision(glm::vec3& position, glm::vec3& velocity) const
 	{
-		glm::vec3 pos = particle->GetPosition();
-		glm::vec3 vel = particle->GetVelocity();
+		glm::vec3 pos = position;
+		glm::vec3 vel = velocity;
 		bool collided = false;
 
 		// Check each axis — clamp position, decompose & reflect velocity
@@ -64,8 +74,9 @@ struct ColliderBox
 
 		if (collided)
 		{
-			particle->SetPosition(pos);
-			particle->SetVelocity(vel);
+			position = pos;
+			velocity = vel;
 		}
+		return collided;
 	}
 };
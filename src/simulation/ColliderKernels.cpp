@@ -0,0 +1,233 @@
+#include "ColliderKernels.h"
+#include "SpringKernels.h"
+#include "SimdSupport.h"
+#include <cmath>
+
+// Signed separation of p from the obstacle surface and the outward normal
+// there; false when the normal is undefined (p on a capsule's axis)
+static bool Separation(const PreparedCollider& c, const glm::vec3& p, float& separation, glm::vec3& normal)
+{
+	switch (c.kernel)
+	{
+	case ColliderKernel::Box:
+	{
+		glm::vec3 d = p - c.center;
+		glm::vec3 local(glm::dot(d, c.axes[0]), glm::dot(d, c.axes[1]), glm::dot(d, c.axes[2]));
+		glm::vec3 delta = local - glm::clamp(local, -c.halfExtents, c.halfExtents);
+		float distance2 = glm::dot(delta, delta);
+		glm::vec3 n;
+		if (distance2 > 0.0f)
+		{
+			separation = std::sqrt(distance2);
+			n = delta / separation;
+		}
+		else
+		{
+			// Inside: leave through the nearest face
+			glm::vec3 depth = c.halfExtents - glm::abs(local);
+			int axis = (depth.x <= depth.y && depth.x <= depth.z) ? 0 : (depth.y <= depth.z ? 1 : 2);
+			separation = -depth[axis];
+			n = glm::vec3(0.0f);
+			n[axis] = local[axis] < 0.0f ? -1.0f : 1.0f;
+		}
+		normal = c.axes[0] * n.x + c.axes[1] * n.y + c.axes[2] * n.z;
+		return true;
+	}
+
+	case ColliderKernel::Capsule:
+	{
+		glm::vec3 ap = p - c.segmentStart;
+		float t = glm::clamp(glm::dot(ap, c.segment) * c.inverseSegmentLength2, 0.0f, 1.0f);
+		glm::vec3 delta = ap - t * c.segment;
+		float distance = glm::length(delta);
+		if (distance == 0.0f) return false;
+		separation = distance - c.radius;
+		normal = delta / distance;
+		return true;
+	}
+
+	case ColliderKernel::Plane:
+		separation = glm::dot(c.normal, p) - c.offset;
+		normal = c.normal;
+		return true;
+	}
+	return false;
+}
+
+size_t ColliderKernels::ResolveScalar(const PreparedCollider& collider, ColliderBatch& batch,
+									  size_t first, size_t last, float thickness, float restitution)
+{
+	size_t contacts = 0;
+	for (size_t i = first; i < last; i++)
+	{
+		glm::vec3 p(batch.px[i], batch.py[i], batch.pz[i]);
+		float separation;
+		glm::vec3 normal;
+		if (!Separation(collider, p, separation, normal) || separation >= thickness)
+			continue;
+
+		p += (thickness - separation) * normal;
+		batch.px[i] = p.x;
+		batch.py[i] = p.y;
+		batch.pz[i] = p.z;
+
+		float vn = batch.vx[i] * normal.x + batch.vy[i] * normal.y + batch.vz[i] * normal.z;
+		if (vn < 0.0f)
+		{
+			float dv = (1.0f + restitution) * vn;
+			batch.vx[i] -= dv * normal.x;
+			batch.vy[i] -= dv * normal.y;
+			batch.vz[i] -= dv * normal.z;
+		}
+		contacts++;
+	}
+	return contacts;
+}
+
+#if SOFTBODY_X86
+
+SOFTBODY_TARGET("avx2")
+static inline __m256 Dot(__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz)
+{
+	return _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ax, bx), _mm256_mul_ps(ay, by)), _mm256_mul_ps(az, bz));
+}
+
+SOFTBODY_TARGET("avx2")
+static inline __m256 Clamp(__m256 v, __m256 lo, __m256 hi)
+{
+	return _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+}
+
+// AVX2: 8 particles per iteration. Both sides of every branch of the
+// scalar path are computed and blended by lane masks.
+SOFTBODY_TARGET("avx2")
+static size_t ResolveAVX2(const PreparedCollider& c, ColliderBatch& batch,
+						  size_t first, size_t last, float thickness, float restitution)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 signBit = _mm256_set1_ps(-0.0f);
+	const __m256 thick = _mm256_set1_ps(thickness);
+	const __m256 bounce = _mm256_set1_ps(1.0f + restitution);
+	size_t contacts = 0;
+
+	size_t i = first;
+	for (; i + 8 <= last; i += 8)
+	{
+		__m256 px = _mm256_loadu_ps(batch.px + i);
+		__m256 py = _mm256_loadu_ps(batch.py + i);
+		__m256 pz = _mm256_loadu_ps(batch.pz + i);
+		__m256 separation, nx, ny, nz;
+		__m256 valid = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+		if (c.kernel == ColliderKernel::Box)
+		{
+			__m256 dx = _mm256_sub_ps(px, _mm256_set1_ps(c.center.x));
+			__m256 dy = _mm256_sub_ps(py, _mm256_set1_ps(c.center.y));
+			__m256 dz = _mm256_sub_ps(pz, _mm256_set1_ps(c.center.z));
+			__m256 local[3], delta[3], depth[3];
+			for (int k = 0; k < 3; k++)
+			{
+				const glm::vec3& axis = c.axes[k];
+				__m256 h = _mm256_set1_ps(c.halfExtents[k]);
+				local[k] = Dot(dx, dy, dz, _mm256_set1_ps(axis.x), _mm256_set1_ps(axis.y), _mm256_set1_ps(axis.z));
+				delta[k] = _mm256_sub_ps(local[k], Clamp(local[k], _mm256_xor_ps(h, signBit), h));
+				depth[k] = _mm256_sub_ps(h, _mm256_andnot_ps(signBit, local[k]));
+			}
+
+			// Outside: normal along the offset from the box
+			__m256 distance2 = Dot(delta[0], delta[1], delta[2], delta[0], delta[1], delta[2]);
+			__m256 outside = _mm256_cmp_ps(distance2, zero, _CMP_GT_OQ);
+			__m256 distance = _mm256_sqrt_ps(distance2);
+			__m256 inverse = _mm256_div_ps(one, _mm256_blendv_ps(one, distance, outside));
+
+			// Inside: nearest face, signed like the local coordinate
+			__m256 pickX = _mm256_and_ps(_mm256_cmp_ps(depth[0], depth[1], _CMP_LE_OQ),
+										 _mm256_cmp_ps(depth[0], depth[2], _CMP_LE_OQ));
+			__m256 pickY = _mm256_andnot_ps(pickX, _mm256_cmp_ps(depth[1], depth[2], _CMP_LE_OQ));
+			__m256 pickZ = _mm256_andnot_ps(_mm256_or_ps(pickX, pickY), valid);
+			__m256 minDepth = _mm256_blendv_ps(_mm256_blendv_ps(depth[2], depth[1], pickY), depth[0], pickX);
+
+			__m256 n[3];
+			__m256 pick[3] = { pickX, pickY, pickZ };
+			for (int k = 0; k < 3; k++)
+			{
+				__m256 faceNormal = _mm256_and_ps(pick[k], _mm256_or_ps(one, _mm256_and_ps(signBit, local[k])));
+				n[k] = _mm256_blendv_ps(faceNormal, _mm256_mul_ps(delta[k], inverse), outside);
+			}
+			separation = _mm256_blendv_ps(_mm256_xor_ps(minDepth, signBit), distance, outside);
+
+			// Back to simulation space
+			nx = _mm256_setzero_ps(); ny = _mm256_setzero_ps(); nz = _mm256_setzero_ps();
+			for (int k = 0; k < 3; k++)
+			{
+				nx = _mm256_add_ps(nx, _mm256_mul_ps(n[k], _mm256_set1_ps(c.axes[k].x)));
+				ny = _mm256_add_ps(ny, _mm256_mul_ps(n[k], _mm256_set1_ps(c.axes[k].y)));
+				nz = _mm256_add_ps(nz, _mm256_mul_ps(n[k], _mm256_set1_ps(c.axes[k].z)));
+			}
+		}
+		else if (c.kernel == ColliderKernel::Capsule)
+		{
+			__m256 sx = _mm256_set1_ps(c.segment.x);
+			__m256 sy = _mm256_set1_ps(c.segment.y);
+			__m256 sz = _mm256_set1_ps(c.segment.z);
+			__m256 ax = _mm256_sub_ps(px, _mm256_set1_ps(c.segmentStart.x));
+			__m256 ay = _mm256_sub_ps(py, _mm256_set1_ps(c.segmentStart.y));
+			__m256 az = _mm256_sub_ps(pz, _mm256_set1_ps(c.segmentStart.z));
+			__m256 t = Clamp(_mm256_mul_ps(Dot(ax, ay, az, sx, sy, sz), _mm256_set1_ps(c.inverseSegmentLength2)),
+							 zero, one);
+			__m256 dx = _mm256_sub_ps(ax, _mm256_mul_ps(t, sx));
+			__m256 dy = _mm256_sub_ps(ay, _mm256_mul_ps(t, sy));
+			__m256 dz = _mm256_sub_ps(az, _mm256_mul_ps(t, sz));
+			__m256 distance = _mm256_sqrt_ps(Dot(dx, dy, dz, dx, dy, dz));
+			valid = _mm256_cmp_ps(distance, zero, _CMP_NEQ_UQ);
+			__m256 inverse = _mm256_div_ps(one, _mm256_blendv_ps(one, distance, valid));
+			nx = _mm256_mul_ps(dx, inverse);
+			ny = _mm256_mul_ps(dy, inverse);
+			nz = _mm256_mul_ps(dz, inverse);
+			separation = _mm256_sub_ps(distance, _mm256_set1_ps(c.radius));
+		}
+		else
+		{
+			nx = _mm256_set1_ps(c.normal.x);
+			ny = _mm256_set1_ps(c.normal.y);
+			nz = _mm256_set1_ps(c.normal.z);
+			separation = _mm256_sub_ps(Dot(px, py, pz, nx, ny, nz), _mm256_set1_ps(c.offset));
+		}
+
+		__m256 hit = _mm256_and_ps(valid, _mm256_cmp_ps(separation, thick, _CMP_LT_OQ));
+		int mask = _mm256_movemask_ps(hit);
+		if (mask == 0) continue;
+		for (; mask != 0; mask &= mask - 1)
+			contacts++;
+
+		__m256 push = _mm256_and_ps(hit, _mm256_sub_ps(thick, separation));
+		_mm256_storeu_ps(batch.px + i, _mm256_add_ps(px, _mm256_mul_ps(push, nx)));
+		_mm256_storeu_ps(batch.py + i, _mm256_add_ps(py, _mm256_mul_ps(push, ny)));
+		_mm256_storeu_ps(batch.pz + i, _mm256_add_ps(pz, _mm256_mul_ps(push, nz)));
+
+		__m256 vx = _mm256_loadu_ps(batch.vx + i);
+		__m256 vy = _mm256_loadu_ps(batch.vy + i);
+		__m256 vz = _mm256_loadu_ps(batch.vz + i);
+		__m256 vn = _mm256_and_ps(hit, _mm256_min_ps(Dot(vx, vy, vz, nx, ny, nz), zero));
+		__m256 dv = _mm256_mul_ps(bounce, vn);
+		_mm256_storeu_ps(batch.vx + i, _mm256_sub_ps(vx, _mm256_mul_ps(dv, nx)));
+		_mm256_storeu_ps(batch.vy + i, _mm256_sub_ps(vy, _mm256_mul_ps(dv, ny)));
+		_mm256_storeu_ps(batch.vz + i, _mm256_sub_ps(vz, _mm256_mul_ps(dv, nz)));
+	}
+
+	return contacts + ColliderKernels::ResolveScalar(c, batch, i, last, thickness, restitution);
+}
+
+#endif // SOFTBODY_X86
+
+size_t ColliderKernels::Resolve(const PreparedCollider& collider, ColliderBatch& batch,
+								size_t first, size_t last, float thickness, float restitution)
+{
+#if SOFTBODY_X86
+	SimdLevel level = SpringKernels::GetActiveLevel();
+	if (level == SimdLevel::AVX2 || level == SimdLevel::AVX512)
+		return ResolveAVX2(collider, batch, first, last, thickness, restitution);
+#endif
+	return ResolveScalar(collider, batch, first, last, thickness, restitution);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// Narrow-phase form of an obstacle, in simulation space. AABBs are boxes
+// with identity axes and spheres are capsules with a zero-length segment,
+// so three kernels cover every ColliderSet shape.
+enum class ColliderKernel { Box, Capsule, Plane };
+
+struct PreparedCollider
+{
+	ColliderKernel kernel = ColliderKernel::Box;
+
+	glm::vec3 center = glm::vec3(0.0f);         // box
+	glm::vec3 axes[3] = { glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1) };
+	glm::vec3 halfExtents = glm::vec3(0.0f);
+
+	glm::vec3 segmentStart = glm::vec3(0.0f);   // capsule
+	glm::vec3 segment = glm::vec3(0.0f);
+	float inverseSegmentLength2 = 0.0f;         // 0 for a sphere
+	float radius = 0.0f;
+
+	glm::vec3 normal = glm::vec3(0, 1, 0);      // plane: dot(normal, p) = offset
+	float offset = 0.0f;
+};
+
+// Particles gathered from one broad-phase cell into structure-of-arrays
+// form, so the kernels can load eight lanes with one instruction
+const int COLLIDER_BATCH_SIZE = 64;
+
+struct alignas(32) ColliderBatch
+{
+	float px[COLLIDER_BATCH_SIZE], py[COLLIDER_BATCH_SIZE], pz[COLLIDER_BATCH_SIZE];
+	float vx[COLLIDER_BATCH_SIZE], vy[COLLIDER_BATCH_SIZE], vz[COLLIDER_BATCH_SIZE];
+};
+
+// Particle vs obstacle response for lanes [first, last) of a batch: every
+// particle closer than `thickness` to the surface (or inside) is pushed out
+// along the surface normal and its approaching normal velocity is
+// reflected with `restitution`. Returns the number of particles moved.
+// The AVX2 path runs 8 lanes per iteration (AVX-512 CPUs use it too);
+// other CPUs, and the remainder of each batch, take the scalar path.
+class ColliderKernels
+{
+public:
+	static size_t Resolve(const PreparedCollider& collider, ColliderBatch& batch,
+						  size_t first, size_t last, float thickness, float restitution);
+
+	static size_t ResolveScalar(const PreparedCollider& collider, ColliderBatch& batch,
+								size_t first, size_t last, float thickness, float restitution);
+};
@@ -0,0 +1,441 @@
+#include "ColliderSet.h"
+#include "Parallel.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const size_t PARTICLE_GRAIN = 4096;
+static const size_t CELL_GRAIN = 16;
+
+glm::mat3 ColliderPrimitive::GetAxes() const
+{
+	if (shape == ColliderShape::AABB || shape == ColliderShape::Sphere)
+		return glm::mat3(1.0f);
+
+	glm::mat4 r(1.0f);
+	r = glm::rotate(r, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	r = glm::rotate(r, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+	r = glm::rotate(r, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+	return glm::mat3(r);
+}
+
+bool ColliderPrimitive::GetBounds(glm::vec3& bMin, glm::vec3& bMax) const
+{
+	glm::mat3 axes = GetAxes();
+	glm::vec3 extent(0.0f);
+	switch (shape)
+	{
+	case ColliderShape::AABB:
+	case ColliderShape::OBB:
+		// |R| h bounds the rotated box
+		for (int k = 0; k < 3; k++)
+			extent += glm::abs(axes[k]) * halfExtents[k];
+		break;
+	case ColliderShape::Sphere:
+		extent = glm::vec3(radius);
+		break;
+	case ColliderShape::Capsule:
+		extent = glm::abs(axes[1]) * halfLength + radius;
+		break;
+	case ColliderShape::Plane:
+		return false;
+	}
+	bMin = position - extent;
+	bMax = position + extent;
+	return true;
+}
+
+void ColliderSet::Add(const ColliderPrimitive& primitive)
+{
+	m_Primitives.push_back(primitive);
+}
+
+void ColliderSet::Remove(size_t index)
+{
+	if (index < m_Primitives.size())
+		m_Primitives.erase(m_Primitives.begin() + index);
+}
+
+PreparedCollider ColliderSet::Prepare(const ColliderPrimitive& primitive, const glm::vec3& objectPosition)
+{
+	PreparedCollider c;
+	glm::mat3 axes = primitive.GetAxes();
+	glm::vec3 center = primitive.position - objectPosition;
+
+	switch (primitive.shape)
+	{
+	case ColliderShape::AABB:
+	case ColliderShape::OBB:
+		c.kernel = ColliderKernel::Box;
+		c.center = center;
+		for (int k = 0; k < 3; k++)
+			c.axes[k] = axes[k];
+		c.halfExtents = glm::max(primitive.halfExtents, glm::vec3(0.0f));
+		break;
+	case ColliderShape::Sphere:
+	case ColliderShape::Capsule:
+	{
+		float halfLength = primitive.shape == ColliderShape::Capsule ? std::max(primitive.halfLength, 0.0f) : 0.0f;
+		c.kernel = ColliderKernel::Capsule;
+		c.segmentStart = center - axes[1] * halfLength;
+		c.segment = axes[1] * (2.0f * halfLength);
+		float length2 = glm::dot(c.segment, c.segment);
+		c.inverseSegmentLength2 = length2 > 0.0f ? 1.0f / length2 : 0.0f;
+		c.radius = std::max(primitive.radius, 0.0f);
+		break;
+	}
+	case ColliderShape::Plane:
+		c.kernel = ColliderKernel::Plane;
+		c.normal = glm::normalize(axes[1]);
+		c.offset = glm::dot(c.normal, center);
+		break;
+	}
+	return c;
+}
+
+void ColliderSet::Update(const glm::vec3& objectPosition, float thickness)
+{
+	m_Prepared.clear();
+	m_Bounded.clear();
+	m_Planes.clear();
+	m_BoxMin.clear();
+	m_BoxMax.clear();
+
+	glm::vec3 lo(std::numeric_limits<float>::max());
+	glm::vec3 hi(-std::numeric_limits<float>::max());
+	float extentSum = 0.0f;
+	for (const ColliderPrimitive& primitive : m_Primitives)
+	{
+		if (!primitive.enabled) continue;
+
+		uint32_t index = static_cast<uint32_t>(m_Prepared.size());
+		m_Prepared.push_back(Prepare(primitive, objectPosition));
+
+		glm::vec3 bMin, bMax;
+		if (!primitive.GetBounds(bMin, bMax))
+		{
+			m_Planes.push_back(index);
+			continue;
+		}
+		bMin = bMin - objectPosition - thickness;
+		bMax = bMax - objectPosition + thickness;
+		glm::vec3 extent = bMax - bMin;
+		extentSum += std::max(extent.x, std::max(extent.y, extent.z));
+		lo = glm::min(lo, bMin);
+		hi = glm::max(hi, bMax);
+		m_Bounded.push_back(index);
+		m_BoxMin.push_back(bMin);
+		m_BoxMax.push_back(bMax);
+	}
+
+	// Cells about one obstacle wide, unless that would exceed the cell cap
+	m_GridSize = glm::ivec3(0);
+	if (!m_Bounded.empty())
+	{
+		glm::vec3 size = hi - lo;
+		float cellSize = extentSum / m_Bounded.size();
+		cellSize = std::max(cellSize, std::max(size.x, std::max(size.y, size.z)) / COLLIDER_GRID_MAX_CELLS);
+		cellSize = std::max(cellSize, 1e-4f);
+
+		m_GridMin = lo;
+		m_InverseCellSize = 1.0f / cellSize;
+		m_GridSize = glm::clamp(glm::ivec3(glm::ceil(size * m_InverseCellSize)),
+								glm::ivec3(1), glm::ivec3(COLLIDER_GRID_MAX_CELLS));
+	}
+
+	size_t cellCount = GetCellCount();
+	m_CellRows.clear();
+	m_CellValues.clear();
+	for (size_t k = 0; k < m_Bounded.size(); k++)
+	{
+		glm::ivec3 first = glm::clamp(glm::ivec3(glm::floor((m_BoxMin[k] - m_GridMin) * m_InverseCellSize)),
+									  glm::ivec3(0), m_GridSize - 1);
+		glm::ivec3 last = glm::clamp(glm::ivec3(glm::floor((m_BoxMax[k] - m_GridMin) * m_InverseCellSize)),
+									 glm::ivec3(0), m_GridSize - 1);
+		for (int z = first.z; z <= last.z; z++)
+			for (int y = first.y; y <= last.y; y++)
+				for (int x = first.x; x <= last.x; x++)
+				{
+					m_CellRows.push_back(static_cast<uint32_t>(x + m_GridSize.x * (y + m_GridSize.y * z)));
+					m_CellValues.push_back(m_Bounded[k]);
+				}
+	}
+	for (uint32_t plane : m_Planes)
+	{
+		for (size_t cell = 0; cell <= cellCount; cell++)
+		{
+			m_CellRows.push_back(static_cast<uint32_t>(cell));
+			m_CellValues.push_back(plane);
+		}
+	}
+	m_Cells.Build(cellCount + 1, m_CellRows, m_CellValues);
+}
+
+uint32_t ColliderSet::GetCell(const glm::vec3& p) const
+{
+	glm::ivec3 g = glm::ivec3(glm::floor((p - m_GridMin) * m_InverseCellSize));
+	if (glm::any(glm::lessThan(g, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(g, m_GridSize)))
+		return static_cast<uint32_t>(GetCellCount());
+	return static_cast<uint32_t>(g.x + m_GridSize.x * (g.y + m_GridSize.y * g.z));
+}
+
+size_t ColliderSet::Resolve(ParticleStore& particles, ColliderBins& bins, float thickness, float restitution) const
+{
+	bins.contactCount = 0;
+	size_t n = particles.Size();
+	if (m_Prepared.empty() || n == 0) return 0;
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	size_t rowCount = GetCellCount() + 1;
+
+	bins.particleCells.resize(n);
+	ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			bins.particleCells[i] = GetCell(positions[i]);
+	});
+
+	// Counting sort by cell; the scatter advances each offset to the next
+	// row's start, so shifting them back restores the row starts
+	bins.cellOffsets.assign(rowCount + 1, 0);
+	for (uint32_t cell : bins.particleCells)
+		bins.cellOffsets[cell + 1]++;
+	for (size_t r = 0; r < rowCount; r++)
+		bins.cellOffsets[r + 1] += bins.cellOffsets[r];
+	bins.particles.resize(n);
+	for (uint32_t i = 0; i < n; i++)
+		bins.particles[bins.cellOffsets[bins.particleCells[i]]++] = i;
+	for (size_t r = rowCount; r > 0; r--)
+		bins.cellOffsets[r] = bins.cellOffsets[r - 1];
+	bins.cellOffsets[0] = 0;
+
+	bins.contactCount = ParallelReduce(0, rowCount, CELL_GRAIN, size_t(0),
+		[&](size_t first, size_t last)
+		{
+			size_t contacts = 0;
+			ColliderBatch batch;
+			for (size_t row = first; row < last; row++)
+			{
+				uint32_t shapesBegin = m_Cells.RowBegin(row);
+				uint32_t shapesEnd = m_Cells.RowEnd(row);
+				if (shapesBegin == shapesEnd) continue;
+
+				for (uint32_t begin = bins.cellOffsets[row]; begin < bins.cellOffsets[row + 1];
+					 begin += COLLIDER_BATCH_SIZE)
+				{
+					uint32_t count = std::min<uint32_t>(COLLIDER_BATCH_SIZE, bins.cellOffsets[row + 1] - begin);
+					for (uint32_t k = 0; k < count; k++)
+					{
+						uint32_t i = bins.particles[begin + k];
+						batch.px[k] = positions[i].x; batch.py[k] = positions[i].y; batch.pz[k] = positions[i].z;
+						batch.vx[k] = velocities[i].x; batch.vy[k] = velocities[i].y; batch.vz[k] = velocities[i].z;
+					}
+
+					for (uint32_t e = shapesBegin; e < shapesEnd; e++)
+						contacts += ColliderKernels::Resolve(m_Prepared[m_Cells.entries[e]], batch, 0, count,
+															 thickness, restitution);
+
+					for (uint32_t k = 0; k < count; k++)
+					{
+						uint32_t i = bins.particles[begin + k];
+						positions[i] = glm::vec3(batch.px[k], batch.py[k], batch.pz[k]);
+						velocities[i] = glm::vec3(batch.vx[k], batch.vy[k], batch.vz[k]);
+					}
+				}
+			}
+			return contacts;
+		},
+		[](size_t a, size_t b) { return a + b; });
+	return bins.contactCount;
+}
+
+bool ColliderSet::Sweep(const PreparedCollider& collider, const glm::vec3& start, const glm::vec3& end,
+						float& fraction, glm::vec3& normal)
+{
+	glm::vec3 d = end - start;
+	switch (collider.kernel)
+	{
+	case ColliderKernel::Box:
+	{
+		// Slab test in the box's frame, entering from outside
+		glm::vec3 s, e;
+		for (int k = 0; k < 3; k++)
+		{
+			s[k] = glm::dot(collider.axes[k], start - collider.center);
+			e[k] = glm::dot(collider.axes[k], d);
+		}
+		float tEnter = -std::numeric_limits<float>::max();
+		float tExit = std::numeric_limits<float>::max();
+		int enterAxis = -1;
+		for (int k = 0; k < 3; k++)
+		{
+			float h = collider.halfExtents[k];
+			if (std::abs(e[k]) < 1e-12f)
+			{
+				if (std::abs(s[k]) > h) return false;
+				continue;
+			}
+			float t0 = (-h - s[k]) / e[k];
+			float t1 = (h - s[k]) / e[k];
+			if (t0 > t1) std::swap(t0, t1);
+			if (t0 > tEnter) { tEnter = t0; enterAxis = k; }
+			tExit = std::min(tExit, t1);
+		}
+		if (enterAxis < 0 || tEnter < 0.0f || tEnter > 1.0f || tEnter > tExit) return false;
+		fraction = tEnter;
+		normal = collider.axes[enterAxis] * (e[enterAxis] > 0.0f ? -1.0f : 1.0f);
+		return true;
+	}
+	case ColliderKernel::Capsule:
+	{
+		// Ray against the swept sphere: the cylinder body first, then the cap
+		// nearest to where the ray meets the cylinder's axis line
+		float length = glm::length(d);
+		if (length < 1e-8f) return false;
+		glm::vec3 direction = d / length;
+		float r2 = collider.radius * collider.radius;
+
+		glm::vec3 ba = collider.segment;
+		glm::vec3 oa = start - collider.segmentStart;
+		float baba = glm::dot(ba, ba);
+		float baoa = glm::dot(ba, oa);
+		glm::vec3 closest = collider.segmentStart + ba * glm::clamp(baoa * collider.inverseSegmentLength2, 0.0f, 1.0f);
+		if (glm::dot(start - closest, start - closest) <= r2) return false;
+
+		float t = -1.0f;
+		glm::vec3 cap = collider.segmentStart;
+		if (baba > 0.0f)
+		{
+			float bard = glm::dot(ba, direction);
+			float a = baba - bard * bard;
+			float b = baba * glm::dot(direction, oa) - baoa * bard;
+			float c = baba * glm::dot(oa, oa) - baoa * baoa - r2 * baba;
+			float h = b * b - a * c;
+			if (h < 0.0f) return false;
+			if (a > 1e-12f)
+			{
+				float tBody = (-b - std::sqrt(h)) / a;
+				float y = baoa + tBody * bard;
+				if (y > 0.0f && y < baba)
+					t = tBody;
+				else if (y >= baba)
+					cap = collider.segmentStart + ba;
+			}
+			else if (bard < 0.0f)
+				cap = collider.segmentStart + ba;   // along the axis: the cap facing the ray
+		}
+		if (t < 0.0f)
+		{
+			glm::vec3 oc = start - cap;
+			float b = glm::dot(direction, oc);
+			float h = b * b - (glm::dot(oc, oc) - r2);
+			if (h < 0.0f) return false;
+			t = -b - std::sqrt(h);
+		}
+		if (t < 0.0f || t > length) return false;
+
+		glm::vec3 hit = start + direction * t;
+		glm::vec3 axisPoint = collider.segmentStart +
+			ba * glm::clamp(glm::dot(hit - collider.segmentStart, ba) * collider.inverseSegmentLength2, 0.0f, 1.0f);
+		normal = hit - axisPoint;
+		float normalLength = glm::length(normal);
+		normal = normalLength > 1e-8f ? normal / normalLength : -direction;
+		fraction = t / length;
+		return true;
+	}
+	case ColliderKernel::Plane:
+	{
+		float d0 = glm::dot(collider.normal, start) - collider.offset;
+		float d1 = glm::dot(collider.normal, end) - collider.offset;
+		if (d0 < 0.0f || d1 >= 0.0f) return false;
+		fraction = d0 / (d0 - d1);
+		normal = collider.normal;
+		return true;
+	}
+	}
+	return false;
+}
+
+size_t ColliderSet::ResolveSwept(ParticleStore& particles, const std::vector<glm::vec3>& startPositions,
+								 float thickness, float restitution) const
+{
+	size_t n = particles.Size();
+	if (m_Prepared.empty() || startPositions.size() != n) return 0;
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+
+	return ParallelReduce(0, n, PARTICLE_GRAIN, size_t(0),
+		[&](size_t first, size_t last)
+		{
+			size_t contacts = 0;
+			for (size_t i = first; i < last; i++)
+			{
+				glm::vec3& p = positions[i];
+				const glm::vec3& start = startPositions[i];
+				if (p == start) continue;
+
+				float best = 2.0f;
+				glm::vec3 bestNormal(0.0f);
+				auto test = [&](uint32_t index)
+				{
+					float fraction;
+					glm::vec3 normal;
+					if (Sweep(m_Prepared[index], start, p, fraction, normal) && fraction < best)
+					{
+						best = fraction;
+						bestNormal = normal;
+					}
+				};
+
+				for (uint32_t plane : m_Planes)
+					test(plane);
+
+				if (!m_Bounded.empty())
+				{
+					glm::ivec3 lo = glm::ivec3(glm::floor((glm::min(start, p) - m_GridMin) * m_InverseCellSize));
+					glm::ivec3 hi = glm::ivec3(glm::floor((glm::max(start, p) - m_GridMin) * m_InverseCellSize));
+					if (glm::all(glm::greaterThanEqual(hi, glm::ivec3(0))) && glm::all(glm::lessThan(lo, m_GridSize)))
+					{
+						lo = glm::max(lo, glm::ivec3(0));
+						hi = glm::min(hi, m_GridSize - 1);
+						glm::ivec3 span = hi - lo + 1;
+						if (span.x * span.y * span.z > COLLIDER_SWEEP_MAX_CELLS)
+						{
+							for (uint32_t index : m_Bounded)
+								test(index);
+						}
+						else
+						{
+							for (int z = lo.z; z <= hi.z; z++)
+								for (int y = lo.y; y <= hi.y; y++)
+									for (int x = lo.x; x <= hi.x; x++)
+									{
+										size_t row = static_cast<size_t>(x + m_GridSize.x * (y + m_GridSize.y * z));
+										for (uint32_t e = m_Cells.RowBegin(row); e < m_Cells.RowEnd(row); e++)
+										{
+											uint32_t index = m_Cells.entries[e];
+											if (m_Prepared[index].kernel != ColliderKernel::Plane)
+												test(index);
+										}
+									}
+						}
+					}
+				}
+				if (best > 1.0f) continue;
+
+				glm::vec3 contact = glm::mix(start, p, best);
+				p += (thickness - glm::dot(p - contact, bestNormal)) * bestNormal;
+
+				glm::vec3& v = velocities[i];
+				float vn = glm::dot(v, bestNormal);
+				if (vn < 0.0f)
+					v -= (1.0f + restitution) * vn * bestNormal;
+				contacts++;
+			}
+			return contacts;
+		},
+		[](size_t a, size_t b) { return a + b; });
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "ParticleStore.h"
+#include "CsrAdjacency.h"
+#include "ColliderKernels.h"
+
+enum class ColliderShape { AABB, OBB, Sphere, Capsule, Plane };
+
+const char* const COLLIDER_SHAPE_NAMES[] = { "AABB", "OBB", "Sphere", "Capsule", "Plane" };
+
+// One solid obstacle as edited in the UI, in world space. Particles are
+// kept outside of it (the ColliderBox, by contrast, keeps them inside).
+struct ColliderPrimitive
+{
+	ColliderShape shape = ColliderShape::AABB;
+	bool enabled = true;
+	glm::vec3 position = glm::vec3(0.0f);
+	glm::vec3 rotation = glm::vec3(0.0f);      // degrees about x, y, z (as Transform); AABB/sphere ignore it
+	glm::vec3 halfExtents = glm::vec3(0.5f);   // AABB, OBB
+	float radius = 0.5f;                       // sphere, capsule
+	float halfLength = 0.5f;                   // capsule segment along local y
+
+	// Local axes in world space; a plane's normal is local y
+	glm::mat3 GetAxes() const;
+
+	// World-space bounds; planes are unbounded
+	bool GetBounds(glm::vec3& bMin, glm::vec3& bMax) const;
+};
+
+const int COLLIDER_GRID_MAX_CELLS = 32;
+const int COLLIDER_SWEEP_MAX_CELLS = 64;     // paths covering more cells test every obstacle
+
+// Per-body broad-phase scratch, so bodies can resolve concurrently
+struct ColliderBins
+{
+	std::vector<uint32_t> particleCells;
+	std::vector<uint32_t> cellOffsets;
+	std::vector<uint32_t> particles;
+	size_t contactCount = 0;
+};
+
+// Set of obstacle primitives with a uniform-grid broad phase.
+// Update converts the enabled primitives to simulation space and enters
+// each bounded one into every grid cell its box (grown by the thickness)
+// overlaps, at most COLLIDER_GRID_MAX_CELLS per axis; planes are entered
+// into every cell and into an extra row for particles outside the grid.
+// Resolve counting-sorts a body's particles by cell, then for each cell
+// gathers its particles into ColliderBatch chunks and runs the SIMD
+// kernels of that cell's obstacles over them. Cells own disjoint
+// particles, so they are processed in parallel.
+class ColliderSet
+{
+private:
+	std::vector<ColliderPrimitive> m_Primitives;
+
+	std::vector<PreparedCollider> m_Prepared;
+	std::vector<uint32_t> m_Bounded;            // prepared shapes with a box, and their boxes
+	std::vector<glm::vec3> m_BoxMin;
+	std::vector<glm::vec3> m_BoxMax;
+	std::vector<uint32_t> m_Planes;
+	glm::vec3 m_GridMin = glm::vec3(0.0f);
+	glm::ivec3 m_GridSize = glm::ivec3(0);
+	float m_InverseCellSize = 1.0f;
+	CsrAdjacency m_Cells;                       // row per cell, plus one for outside the grid
+	std::vector<uint32_t> m_CellRows;
+	std::vector<uint32_t> m_CellValues;
+
+public:
+	ColliderSet() = default;
+
+	void Add(const ColliderPrimitive& primitive);
+	void Remove(size_t index);
+	inline std::vector<ColliderPrimitive>& GetPrimitives() { return m_Primitives; }
+	inline const std::vector<ColliderPrimitive>& GetPrimitives() const { return m_Primitives; }
+
+	// Rebuilds the prepared shapes and the grid; call once per frame before Resolve
+	void Update(const glm::vec3& objectPosition, float thickness);
+
+	// Returns the number of particle contacts (also stored in bins)
+	size_t Resolve(ParticleStore& particles, ColliderBins& bins, float thickness, float restitution) const;
+
+	// Continuous pass: particles whose path from startPositions enters an
+	// obstacle are put back at the entry point (plus the thickness); run
+	// before Resolve. Only the grid cells the path's box overlaps are tested.
+	size_t ResolveSwept(ParticleStore& particles, const std::vector<glm::vec3>& startPositions,
+						float thickness, float restitution) const;
+
+	inline bool IsEmpty() const { return m_Prepared.empty(); }
+	inline size_t GetCellCount() const { return static_cast<size_t>(m_GridSize.x) * m_GridSize.y * m_GridSize.z; }
+
+private:
+	static PreparedCollider Prepare(const ColliderPrimitive& primitive, const glm::vec3& objectPosition);
+	uint32_t GetCell(const glm::vec3& p) const;
+
+	// Earliest entry of start-end into a prepared shape, as a fraction of the path
+	static bool Sweep(const PreparedCollider& collider, const glm::vec3& start, const glm::vec3& end,
+					  float& fraction, glm::vec3& normal);
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+// Compressed sparse row adjacency: the entries of row r are
+// entries[offsets[r] .. offsets[r + 1]). Used to map each particle to the
+// springs/faces touching it so forces can be gathered per particle, which
+// lets threads write disjoint outputs without atomics.
+struct CsrAdjacency
+{
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> entries;
+
+	inline size_t GetRowCount() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+	inline uint32_t RowBegin(size_t row) const { return offsets[row]; }
+	inline uint32_t RowEnd(size_t row) const { return offsets[row + 1]; }
+
+	// Counting-sort build from (row, entry) pairs; entries keep their input order within a row
+	void Build(size_t rowCount, const std::vector<uint32_t>& rows, const std::vector<uint32_t>& values)
+	{
+		offsets.assign(rowCount + 1, 0);
+		for (uint32_t r : rows)
+			offsets[r + 1]++;
+		for (size_t r = 0; r < rowCount; r++)
+			offsets[r + 1] += offsets[r];
+
+		entries.resize(values.size());
+		std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < rows.size(); i++)
+			entries[cursor[rows[i]]++] = values[i];
+	}
+};
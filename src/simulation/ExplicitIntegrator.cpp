@@ -0,0 +1,237 @@
+#include "ExplicitIntegrator.h"
+#include "PhysicsEngine.h"
+#include "Parallel.h"
+#include <algorithm>
+
+static const size_t PARTICLE_GRAIN = 2048;
+
+void ExplicitIntegrator::Resize(size_t count)
+{
+	if (m_StartPositions.size() == count) return;
+
+	m_StartPositions.assign(count, glm::vec3(0.0f));
+	m_StartVelocities.assign(count, glm::vec3(0.0f));
+	m_PositionSum.assign(count, glm::vec3(0.0f));
+	m_VelocitySum.assign(count, glm::vec3(0.0f));
+	m_Accelerations.assign(count, glm::vec3(0.0f));
+	for (int stage = 0; stage < 3; stage++)
+	{
+		m_StageVelocities[stage].assign(count, glm::vec3(0.0f));
+		m_StageAccelerations[stage].assign(count, glm::vec3(0.0f));
+	}
+	m_HasAccelerations = false;
+}
+
+void ExplicitIntegrator::SaveStart(const ParticleStore& particles)
+{
+	const auto& positions = particles.GetPositions();
+	const auto& velocities = particles.GetVelocities();
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			m_StartPositions[i] = positions[i];
+			m_StartVelocities[i] = velocities[i];
+		}
+	});
+}
+
+void ExplicitIntegrator::StoreAccelerations(const ParticleStore& particles)
+{
+	const auto& forces = particles.GetForces();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			m_Accelerations[i] = forces[i] * inverseMasses[i];
+	});
+}
+
+void ExplicitIntegrator::KickDrift(ParticleStore& particles, float dt)
+{
+	PhysicsEngine::Integrate(particles, dt);
+}
+
+void ExplicitIntegrator::HalfKickDrift(ParticleStore& particles, float dt)
+{
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	float halfDt = dt * 0.5f;
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			velocities[i] += m_Accelerations[i] * halfDt;
+			positions[i] += velocities[i] * dt;
+		}
+	});
+}
+
+void ExplicitIntegrator::HalfKick(ParticleStore& particles, float dt)
+{
+	auto& velocities = particles.GetVelocities();
+	float halfDt = dt * 0.5f;
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			velocities[i] += m_Accelerations[i] * halfDt;
+	});
+}
+
+void ExplicitIntegrator::MidpointHalf(ParticleStore& particles, float dt)
+{
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& forces = particles.GetForces();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	float halfDt = dt * 0.5f;
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			glm::vec3 a = forces[i] * inverseMasses[i];
+			velocities[i] = m_StartVelocities[i] + a * halfDt;
+			positions[i] = m_StartPositions[i] + velocities[i] * halfDt;
+		}
+	});
+}
+
+void ExplicitIntegrator::MidpointFull(ParticleStore& particles, float dt)
+{
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& forces = particles.GetForces();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			glm::vec3 aHalf = forces[i] * inverseMasses[i];
+			velocities[i] = m_StartVelocities[i] + aHalf * dt;
+			positions[i] = m_StartPositions[i] + velocities[i] * dt;
+		}
+	});
+}
+
+void ExplicitIntegrator::RungeKuttaStage(ParticleStore& particles, float weight, float c, bool first)
+{
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& forces = particles.GetForces();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t firstIndex, size_t lastIndex)
+	{
+		for (size_t i = firstIndex; i < lastIndex; i++)
+		{
+			// k = (v, a) at the state currently in the store
+			glm::vec3 kx = velocities[i];
+			glm::vec3 kv = forces[i] * inverseMasses[i];
+
+			m_PositionSum[i] = first ? weight * kx : m_PositionSum[i] + weight * kx;
+			m_VelocitySum[i] = first ? weight * kv : m_VelocitySum[i] + weight * kv;
+
+			// Next stage input: y0 + c * k
+			positions[i] = m_StartPositions[i] + c * kx;
+			velocities[i] = m_StartVelocities[i] + c * kv;
+		}
+	});
+}
+
+void ExplicitIntegrator::RungeKuttaFinish(ParticleStore& particles, float dt)
+{
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	float sixth = dt / 6.0f;
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			positions[i] = m_StartPositions[i] + sixth * m_PositionSum[i];
+			velocities[i] = m_StartVelocities[i] + sixth * m_VelocitySum[i];
+		}
+	});
+}
+
+void ExplicitIntegrator::RestoreStart(ParticleStore& particles)
+{
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			positions[i] = m_StartPositions[i];
+			velocities[i] = m_StartVelocities[i];
+		}
+	});
+}
+
+// Bogacki-Shampine tableau:
+//   y2 = y0 + h (1/2 k1)
+//   y3 = y0 + h (3/4 k2)
+//   y  = y0 + h (2/9 k1 + 1/3 k2 + 4/9 k3)
+void ExplicitIntegrator::EmbeddedStage(ParticleStore& particles, int stage, float h)
+{
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& forces = particles.GetForces();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	auto& stageVelocities = m_StageVelocities[stage];
+	auto& stageAccelerations = m_StageAccelerations[stage];
+
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			stageVelocities[i] = velocities[i];
+			stageAccelerations[i] = forces[i] * inverseMasses[i];
+
+			glm::vec3 dx, dv;
+			if (stage == 0)
+			{
+				dx = 0.5f * stageVelocities[i];
+				dv = 0.5f * stageAccelerations[i];
+			}
+			else if (stage == 1)
+			{
+				dx = 0.75f * stageVelocities[i];
+				dv = 0.75f * stageAccelerations[i];
+			}
+			else
+			{
+				dx = (2.0f / 9.0f) * m_StageVelocities[0][i] + (1.0f / 3.0f) * m_StageVelocities[1][i]
+				   + (4.0f / 9.0f) * stageVelocities[i];
+				dv = (2.0f / 9.0f) * m_StageAccelerations[0][i] + (1.0f / 3.0f) * m_StageAccelerations[1][i]
+				   + (4.0f / 9.0f) * stageAccelerations[i];
+			}
+
+			positions[i] = m_StartPositions[i] + h * dx;
+			velocities[i] = m_StartVelocities[i] + h * dv;
+		}
+	});
+}
+
+// y - z = h (-5/72 k1 + 1/12 k2 + 1/9 k3 - 1/8 k4), with z the 2nd-order
+// solution and k4 evaluated at y (forces currently in the store)
+float ExplicitIntegrator::EmbeddedError(const ParticleStore& particles, float h) const
+{
+	const auto& velocities = particles.GetVelocities();
+	const auto& forces = particles.GetForces();
+	const auto& inverseMasses = particles.GetInverseMasses();
+
+	return ParallelReduce(0, particles.Size(), PARTICLE_GRAIN, 0.0f,
+		[&](size_t first, size_t last)
+		{
+			float worst = 0.0f;
+			for (size_t i = first; i < last; i++)
+			{
+				glm::vec3 ex = h * ((-5.0f / 72.0f) * m_StageVelocities[0][i] + (1.0f / 12.0f) * m_StageVelocities[1][i]
+					+ (1.0f / 9.0f) * m_StageVelocities[2][i] - 0.125f * velocities[i]);
+				glm::vec3 ev = h * ((-5.0f / 72.0f) * m_StageAccelerations[0][i] + (1.0f / 12.0f) * m_StageAccelerations[1][i]
+					+ (1.0f / 9.0f) * m_StageAccelerations[2][i] - 0.125f * forces[i] * inverseMasses[i]);
+				worst = std::max(worst, std::max(glm::length(ex), h * glm::length(ev)));
+			}
+			return worst;
+		},
+		[](float a, float b) { return std::max(a, b); });
+}
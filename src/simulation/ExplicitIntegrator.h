@@ -0,0 +1,164 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "ParticleStore.h"
+
+enum class ExplicitScheme { SymplecticEuler, VelocityVerlet, Midpoint, RK4 };
+
+// Explicit time steppers over the particle store's flat position/velocity
+// buffers. The state y = (x, v) has derivative (v, F(x, v) / m); forces come
+// from a caller-supplied evaluate() that recomputes particles' forces for
+// whatever state currently sits in the store. Every stage buffer is
+// allocated once, so a step costs only its force evaluations.
+class ExplicitIntegrator
+{
+private:
+	// y0 of the current step
+	std::vector<glm::vec3> m_StartPositions;
+	std::vector<glm::vec3> m_StartVelocities;
+
+	// RK4 weighted sums of the stage derivatives
+	std::vector<glm::vec3> m_PositionSum;
+	std::vector<glm::vec3> m_VelocitySum;
+
+	// Bogacki-Shampine stages: velocity and acceleration of k1..k3
+	std::vector<glm::vec3> m_StageVelocities[3];
+	std::vector<glm::vec3> m_StageAccelerations[3];
+
+	// Velocity Verlet: acceleration at the end of the previous step
+	std::vector<glm::vec3> m_Accelerations;
+	bool m_HasAccelerations = false;
+
+public:
+	ExplicitIntegrator() = default;
+
+	void Resize(size_t count);
+
+	// Forget cached accelerations (after a reset, a method change or a change
+	// of the parameters that enter the forces, see Softbody::OnDynamicsChanged)
+	void Invalidate() { m_HasAccelerations = false; }
+
+	template <typename EvaluateFn>
+	void Step(ExplicitScheme scheme, ParticleStore& particles, float dt, EvaluateFn&& evaluate);
+
+	// Same step with the scheme fixed at compile time, so the force
+	// evaluation inlines into each stage
+	template <ExplicitScheme Scheme, typename EvaluateFn>
+	void Step(ParticleStore& particles, float dt, EvaluateFn&& evaluate);
+
+	// Embedded Bogacki-Shampine 3(2) step. Leaves the 3rd-order solution in
+	// the store and returns the error estimate max_i max(|e_x|, h |e_v|)
+	// against the embedded 2nd-order solution. RestoreStart() rejects it.
+	template <typename EvaluateFn>
+	float StepEmbedded(ParticleStore& particles, float h, EvaluateFn&& evaluate);
+
+	void RestoreStart(ParticleStore& particles);
+
+private:
+	void SaveStart(const ParticleStore& particles);
+	void StoreAccelerations(const ParticleStore& particles);
+
+	// v += a * dt; x += v * dt   (a from the store's current forces)
+	void KickDrift(ParticleStore& particles, float dt);
+
+	// Verlet halves: v += cached a * dt/2, x += v * dt / v += new a * dt/2
+	void HalfKickDrift(ParticleStore& particles, float dt);
+	void HalfKick(ParticleStore& particles, float dt);
+
+	// Midpoint: y_half = y0 + dt/2 * f(y0) (semi-implicit half step), then
+	// y = y0 + dt * f(y_half)
+	void MidpointHalf(ParticleStore& particles, float dt);
+	void MidpointFull(ParticleStore& particles, float dt);
+
+	// RK4: accumulate weight * k_stage and move the store to y0 + c * k_stage
+	void RungeKuttaStage(ParticleStore& particles, float weight, float c, bool first);
+	void RungeKuttaFinish(ParticleStore& particles, float dt);
+
+	// Bogacki-Shampine: store k_stage, move the store to y0 + h * Σ a_j k_j
+	void EmbeddedStage(ParticleStore& particles, int stage, float h);
+	float EmbeddedError(const ParticleStore& particles, float h) const;
+};
+
+template <typename EvaluateFn>
+void ExplicitIntegrator::Step(ExplicitScheme scheme, ParticleStore& particles, float dt, EvaluateFn&& evaluate)
+{
+	switch (scheme)
+	{
+	case ExplicitScheme::SymplecticEuler:
+		Step<ExplicitScheme::SymplecticEuler>(particles, dt, evaluate);
+		break;
+	case ExplicitScheme::VelocityVerlet:
+		Step<ExplicitScheme::VelocityVerlet>(particles, dt, evaluate);
+		break;
+	case ExplicitScheme::Midpoint:
+		Step<ExplicitScheme::Midpoint>(particles, dt, evaluate);
+		break;
+	case ExplicitScheme::RK4:
+		Step<ExplicitScheme::RK4>(particles, dt, evaluate);
+		break;
+	}
+}
+
+template <ExplicitScheme Scheme, typename EvaluateFn>
+void ExplicitIntegrator::Step(ParticleStore& particles, float dt, EvaluateFn&& evaluate)
+{
+	Resize(particles.Size());
+
+	if constexpr (Scheme == ExplicitScheme::SymplecticEuler)
+	{
+		evaluate();
+		KickDrift(particles, dt);
+	}
+	else if constexpr (Scheme == ExplicitScheme::VelocityVerlet)
+	{
+		if (!m_HasAccelerations)
+		{
+			evaluate();
+			StoreAccelerations(particles);
+		}
+		HalfKickDrift(particles, dt);
+		evaluate();
+		StoreAccelerations(particles);
+		HalfKick(particles, dt);
+		m_HasAccelerations = true;
+	}
+	else if constexpr (Scheme == ExplicitScheme::Midpoint)
+	{
+		SaveStart(particles);
+		evaluate();
+		MidpointHalf(particles, dt);
+		evaluate();
+		MidpointFull(particles, dt);
+	}
+	else if constexpr (Scheme == ExplicitScheme::RK4)
+	{
+		SaveStart(particles);
+		evaluate();
+		RungeKuttaStage(particles, 1.0f, 0.5f * dt, true);
+		evaluate();
+		RungeKuttaStage(particles, 2.0f, 0.5f * dt, false);
+		evaluate();
+		RungeKuttaStage(particles, 2.0f, dt, false);
+		evaluate();
+		RungeKuttaStage(particles, 1.0f, 0.0f, false);
+		RungeKuttaFinish(particles, dt);
+	}
+}
+
+template <typename EvaluateFn>
+float ExplicitIntegrator::StepEmbedded(ParticleStore& particles, float h, EvaluateFn&& evaluate)
+{
+	Resize(particles.Size());
+	SaveStart(particles);
+
+	for (int stage = 0; stage < 3; stage++)
+	{
+		evaluate();
+		EmbeddedStage(particles, stage, h);
+	}
+
+	// k4 at the 3rd-order solution (first-same-as-last) gives the error
+	evaluate();
+	return EmbeddedError(particles, h);
+}
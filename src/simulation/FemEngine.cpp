@@ -0,0 +1,351 @@
+#include "FemEngine.h"
+#include "Parallel.h"
+#include <algorithm>
+
+static const size_t TET_GRAIN = 256;
+static const size_t BLOCK_GRAIN = 1024;
+static const size_t NODE_GRAIN = 2048;
+
+// Warm-started rotation extraction iterations per step
+static const int ROTATION_ITERATIONS = 3;
+
+// Material bounds: ν -> 1/2 makes λ (and the system) blow up
+static const float FEM_MAX_POISSON = 0.49f;
+static const float FEM_MIN_YOUNGS = 1.0f;
+
+// Wall contact stiffness as h² k / m: a node predicted to end the step
+// beyond a wall lands 100/101 of the way back to it
+static const float FEM_CONTACT_STIFFNESS = 100.0f;
+
+void FemEngine::Build(const std::vector<glm::vec3>& surface, const std::vector<Triangle>& triangles, int resolution)
+{
+	resolution = std::max(1, resolution);
+	m_BuiltResolution = resolution;
+	m_Mesh = Tetrahedralizer::Build(surface, triangles, resolution);
+
+	size_t nodeCount = m_Mesh.positions.size();
+	size_t tetCount = m_Mesh.tets.size();
+
+	m_RestInverses.resize(tetCount);
+	m_RestVolumes.resize(tetCount);
+	std::vector<SpringEdge> edges;
+	edges.reserve(6 * tetCount);
+	for (size_t t = 0; t < tetCount; t++)
+	{
+		const glm::uvec4& tet = m_Mesh.tets[t];
+		const glm::vec3& x0 = m_Mesh.positions[tet[0]];
+		glm::mat3 dm(m_Mesh.positions[tet[1]] - x0, m_Mesh.positions[tet[2]] - x0, m_Mesh.positions[tet[3]] - x0);
+		m_RestInverses[t] = glm::inverse(dm);
+		m_RestVolumes[t] = glm::determinant(dm) / 6.0f;
+
+		for (int i = 0; i < 4; i++)
+			for (int j = i + 1; j < 4; j++)
+				edges.push_back({ tet[i], tet[j] });
+	}
+	m_System.BuildStructure(nodeCount, edges);
+
+	// Every (node i, node j) block of every tet, gathered per BSR block
+	std::vector<uint32_t> rows, values;
+	rows.reserve(16 * tetCount);
+	values.reserve(16 * tetCount);
+	for (size_t t = 0; t < tetCount; t++)
+		for (int i = 0; i < 4; i++)
+			for (int j = 0; j < 4; j++)
+			{
+				rows.push_back(m_System.FindBlock(m_Mesh.tets[t][i], m_Mesh.tets[t][j]));
+				values.push_back(static_cast<uint32_t>(16 * t + 4 * i + j));
+			}
+	m_BlockEntries.Build(m_System.GetBlockCount(), rows, values);
+
+	rows.clear();
+	values.clear();
+	for (size_t t = 0; t < tetCount; t++)
+		for (int corner = 0; corner < 4; corner++)
+		{
+			rows.push_back(m_Mesh.tets[t][corner]);
+			values.push_back(static_cast<uint32_t>(4 * t + corner));
+		}
+	m_NodeCorners.Build(nodeCount, rows, values);
+
+	m_Stiffness.resize(16 * tetCount);
+	m_Rotated.resize(16 * tetCount);
+	m_ElementForces.resize(4 * tetCount);
+	m_Rotations = ClusterMoments();
+	m_Rotations.Resize(tetCount);
+
+	m_Positions = m_Mesh.positions;
+	m_Velocities.assign(nodeCount, glm::vec3(0.0f));
+	m_Dv.assign(nodeCount, glm::vec3(0.0f));
+	m_Rhs.resize(nodeCount);
+	m_Product.resize(nodeCount);
+	m_Masses.resize(nodeCount);
+	m_InverseMasses.resize(nodeCount);
+	m_Preconditioner.resize(nodeCount);
+	m_LastSolve = PcgResult();
+
+	// Stiffness and masses follow on the first step
+	m_BuiltYoungsModulus = -1.0f;
+}
+
+bool FemEngine::NeedsBuild(size_t particleCount, const SimulationParams& params) const
+{
+	return m_Mesh.surfaceCount != particleCount || m_BuiltResolution != std::max(1, params.femResolution);
+}
+
+void FemEngine::FollowSurface(const ParticleStore& particles)
+{
+	size_t n = std::min(particles.Size(), m_Mesh.surfaceCount);
+	if (n == 0) return;
+
+	const auto& positions = particles.GetPositions();
+	const auto& velocities = particles.GetVelocities();
+	glm::dvec3 shift(0.0), velocity(0.0);
+	for (size_t i = 0; i < n; i++)
+	{
+		shift += glm::dvec3(positions[i] - m_Mesh.positions[i]);
+		velocity += glm::dvec3(velocities[i]);
+	}
+	shift /= static_cast<double>(n);
+	velocity /= static_cast<double>(n);
+
+	for (size_t i = m_Mesh.surfaceCount; i < m_Positions.size(); i++)
+	{
+		m_Positions[i] = m_Mesh.positions[i] + glm::vec3(shift);
+		m_Velocities[i] = glm::vec3(velocity);
+	}
+}
+
+void FemEngine::Reset()
+{
+	m_Positions = m_Mesh.positions;
+	m_Velocities.assign(m_Positions.size(), glm::vec3(0.0f));
+	m_Dv.assign(m_Positions.size(), glm::vec3(0.0f));
+	m_Rotations = ClusterMoments();
+	m_Rotations.Resize(GetTetCount());
+	m_LastSolve = PcgResult();
+}
+
+// Rest-frame element stiffness of linear elasticity, per node pair
+//   K_ij = V (λ g_i g_jᵀ + μ g_j g_iᵀ + μ (g_i · g_j) I)
+// with g_i the gradient of node i's shape function (rows of Dm⁻¹, and
+// g_0 = -g_1 - g_2 - g_3), plus lumped masses ρ V / 4 per corner
+void FemEngine::UpdateMaterial(const SimulationParams& params)
+{
+	if (m_BuiltYoungsModulus == params.femYoungsModulus && m_BuiltPoissonRatio == params.femPoissonRatio &&
+		m_BuiltDensity == params.femDensity)
+		return;
+	m_BuiltYoungsModulus = params.femYoungsModulus;
+	m_BuiltPoissonRatio = params.femPoissonRatio;
+	m_BuiltDensity = params.femDensity;
+
+	float youngs = std::max(FEM_MIN_YOUNGS, params.femYoungsModulus);
+	float poisson = glm::clamp(params.femPoissonRatio, 0.0f, FEM_MAX_POISSON);
+	float density = std::max(1e-3f, params.femDensity);
+	float lambda = youngs * poisson / ((1.0f + poisson) * (1.0f - 2.0f * poisson));
+	float mu = youngs / (2.0f * (1.0f + poisson));
+
+	ParallelFor(0, GetTetCount(), TET_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t t = first; t < last; t++)
+		{
+			const glm::mat3& inverse = m_RestInverses[t];
+			glm::vec3 g[4];
+			for (int k = 0; k < 3; k++)
+				g[k + 1] = glm::vec3(inverse[0][k], inverse[1][k], inverse[2][k]);
+			g[0] = -(g[1] + g[2] + g[3]);
+
+			float volume = m_RestVolumes[t];
+			for (int i = 0; i < 4; i++)
+				for (int j = 0; j < 4; j++)
+					m_Stiffness[16 * t + 4 * i + j] = volume * (lambda * glm::outerProduct(g[i], g[j]) +
+						mu * glm::outerProduct(g[j], g[i]) + mu * glm::dot(g[i], g[j]) * glm::mat3(1.0f));
+		}
+	});
+
+	std::fill(m_Masses.begin(), m_Masses.end(), 0.0f);
+	float total = 0.0f;
+	for (size_t t = 0; t < GetTetCount(); t++)
+	{
+		float corner = 0.25f * density * m_RestVolumes[t];
+		for (int k = 0; k < 4; k++)
+			m_Masses[m_Mesh.tets[t][k]] += corner;
+		total += 4.0f * corner;
+	}
+
+	// The tetrahedralizer gives every surface node a tet unless the input
+	// is degenerate; a node left without one still gets an average mass
+	size_t massive = std::count_if(m_Masses.begin(), m_Masses.end(), [](float m) { return m > 0.0f; });
+	float fallback = massive > 0 ? total / static_cast<float>(massive) : params.particleMass;
+	for (float& m : m_Masses)
+		if (m <= 0.0f) m = fallback;
+}
+
+void FemEngine::Step(ParticleStore& particles, const SimulationParams& params,
+					 const ColliderBox& collider, float dt)
+{
+	size_t n = particles.Size();
+	if (n == 0 || m_Mesh.surfaceCount != n) return;
+	UpdateMaterial(params);
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	size_t nodeCount = m_Positions.size();
+
+	// Surface nodes from the particles; pinned particles stay pinned
+	ParallelFor(0, nodeCount, NODE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			bool pinned = i < n && inverseMasses[i] == 0.0f;
+			if (i < n)
+			{
+				m_Positions[i] = positions[i];
+				m_Velocities[i] = pinned ? glm::vec3(0.0f) : velocities[i];
+			}
+			m_InverseMasses[i] = pinned ? 0.0f : 1.0f / m_Masses[i];
+		}
+	});
+
+	AssembleElements();
+	AssembleSystem(params, collider, dt);
+	m_LastSolve = m_Pcg.Solve(m_System, m_Preconditioner, m_Rhs, m_InverseMasses, m_Dv,
+							  FEM_MAX_ITERATIONS, FEM_TOLERANCE);
+
+	// v' = v + dv, x' = x + h v', surface back to the particles (the
+	// collider response is already part of the solve)
+	ParallelFor(0, nodeCount, NODE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			if (m_InverseMasses[i] == 0.0f) continue;
+			m_Velocities[i] += m_Dv[i];
+			m_Positions[i] += dt * m_Velocities[i];
+			if (i < n)
+			{
+				positions[i] = m_Positions[i];
+				velocities[i] = m_Velocities[i];
+			}
+		}
+	});
+}
+
+// Per tet: F = Ds Dm⁻¹, its rotation R, the rotated stiffness blocks and
+// the elastic forces -R K (Rᵀ x - X). Displacements are taken relative to
+// node 0, which leaves the forces unchanged (K's block rows sum to zero)
+// and keeps the rounding independent of the distance from the origin.
+void FemEngine::AssembleElements()
+{
+	ParallelFor(0, GetTetCount(), TET_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t t = first; t < last; t++)
+		{
+			const glm::uvec4& tet = m_Mesh.tets[t];
+			const glm::vec3& x0 = m_Positions[tet[0]];
+			glm::mat3 ds(m_Positions[tet[1]] - x0, m_Positions[tet[2]] - x0, m_Positions[tet[3]] - x0);
+			glm::mat3 f = ds * m_RestInverses[t];
+			for (int col = 0; col < 3; col++)
+				for (int row = 0; row < 3; row++)
+					m_Rotations.a[3 * col + row][t] = f[col][row];
+		}
+
+		ShapeMatchingKernels::ExtractRotations(m_Rotations, first, last, ROTATION_ITERATIONS);
+
+		for (size_t t = first; t < last; t++)
+		{
+			const glm::uvec4& tet = m_Mesh.tets[t];
+			glm::mat3 r = m_Rotations.GetRotation(t);
+			glm::mat3 rt = glm::transpose(r);
+
+			glm::vec3 displacement[4];
+			displacement[0] = glm::vec3(0.0f);
+			const glm::vec3& x0 = m_Positions[tet[0]];
+			const glm::vec3& rest0 = m_Mesh.positions[tet[0]];
+			for (int j = 1; j < 4; j++)
+				displacement[j] = rt * (m_Positions[tet[j]] - x0) - (m_Mesh.positions[tet[j]] - rest0);
+
+			for (int i = 0; i < 4; i++)
+			{
+				glm::vec3 force(0.0f);
+				for (int j = 0; j < 4; j++)
+				{
+					const glm::mat3& k = m_Stiffness[16 * t + 4 * i + j];
+					force += k * displacement[j];
+					m_Rotated[16 * t + 4 * i + j] = r * k * rt;
+				}
+				m_ElementForces[4 * t + i] = -(r * force);
+			}
+		}
+	});
+}
+
+// A = M + (h β + h²) Σ R K Rᵀ, gathered per block, and
+// b = h (f_el + f_ext) - (A - M) v, gathered per node. External force is
+// applied to the surface nodes only, matching what the particle-based
+// models receive per body.
+//
+// The collider walls are linearized penalty springs in the same solve: a
+// node whose x + h v lies beyond a wall gets k (wall - x) along its axis
+// and h² k on its diagonal. Projecting and reflecting after the solve
+// instead leaves the solve unaware of the floor, so a resting body settles
+// squashed against it. Wall contact has no restitution or friction.
+void FemEngine::AssembleSystem(const SimulationParams& params, const ColliderBox& collider, float dt)
+{
+	float scale = dt * std::max(0.0f, params.femDamping) + dt * dt;
+	auto& blocks = m_System.GetBlocks();
+	ParallelFor(0, blocks.size(), BLOCK_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t b = first; b < last; b++)
+		{
+			glm::mat3 sum(0.0f);
+			for (uint32_t k = m_BlockEntries.RowBegin(b); k < m_BlockEntries.RowEnd(b); k++)
+				sum += m_Rotated[m_BlockEntries.entries[k]];
+			blocks[b] = scale * sum;
+		}
+	});
+	m_System.Multiply(m_Velocities, m_Product);
+
+	glm::vec3 gravity(0.0f, params.gravityStrength, 0.0f);
+	size_t surfaceCount = m_Mesh.surfaceCount;
+	ParallelFor(0, m_Positions.size(), NODE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			float mass = m_Masses[i];
+			glm::mat3& diagonal = blocks[m_System.GetDiagonalBlock(i)];
+			diagonal += mass * glm::mat3(1.0f);
+
+			if (m_InverseMasses[i] == 0.0f)
+			{
+				m_Rhs[i] = glm::vec3(0.0f);
+				m_Dv[i] = glm::vec3(0.0f);
+				m_Preconditioner[i] = glm::mat3(0.0f);
+				continue;
+			}
+
+			glm::vec3 force = mass * gravity;
+			if (i < surfaceCount) force += params.externalForce;
+			for (uint32_t k = m_NodeCorners.RowBegin(i); k < m_NodeCorners.RowEnd(i); k++)
+				force += m_ElementForces[m_NodeCorners.entries[k]];
+
+			glm::vec3 rhs = dt * force - m_Product[i];
+			if (collider.enabled)
+			{
+				float contact = FEM_CONTACT_STIFFNESS * mass;   // h² k
+				for (int a = 0; a < 3; a++)
+				{
+					float predicted = m_Positions[i][a] + dt * m_Velocities[i][a];
+					float wall;
+					if (predicted < collider.min[a]) wall = collider.min[a];
+					else if (predicted > collider.max[a]) wall = collider.max[a];
+					else continue;
+					diagonal[a][a] += contact;
+					rhs[a] += contact * (wall - predicted) / dt;
+				}
+			}
+
+			m_Rhs[i] = rhs;
+			m_Preconditioner[i] = glm::inverse(diagonal);
+		}
+	});
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "ParticleStore.h"
+#include "CsrAdjacency.h"
+#include "BlockSparseMatrix.h"
+#include "BlockPcg.h"
+#include "ShapeMatchingKernels.h"
+#include "Tetrahedralizer.h"
+#include "SimulationParams.h"
+#include "ColliderBox.h"
+
+const int FEM_MAX_ITERATIONS = 100;
+const float FEM_TOLERANCE = 1e-4f;
+
+// Co-rotational linear FEM on a tetrahedral mesh (Müller & Gross 2004),
+// stepped with linearized backward Euler:
+//   (M + (h β + h²) K_R) dv = h (f_el + f_ext) - (h β + h²) K_R v,
+//   v' = v + dv,   x' = x + h v'
+// Per tet F = Ds Dm⁻¹, R is the polar rotation of F, K_R = R K Rᵀ and
+// f_el = -R K (Rᵀ x - X), so rigid rotations cost no energy and large
+// rotations do not inflate the body the way plain linear FEM does. β is
+// stiffness-proportional Rayleigh damping. The rest-frame element
+// stiffness K is cached per material; each step rotates it per tet in
+// parallel, gathers the blocks into a BSR matrix whose structure is built
+// once per mesh, and solves with block-Jacobi PCG warm-started from the
+// previous dv. Solving for dv rather than v' keeps the tolerance relative
+// to the forces, so a falling body's momentum does not drown them.
+// The surface nodes are the body's particles: Step reads their state and
+// writes it back, while the interior nodes live here.
+class FemEngine
+{
+private:
+	TetMesh m_Mesh;
+	std::vector<glm::mat3> m_RestInverses;   // per tet: Dm⁻¹
+	std::vector<float> m_RestVolumes;        // per tet
+	std::vector<glm::mat3> m_Stiffness;      // 16 per tet: K_ij in the rest frame, at 16 t + 4 i + j
+	std::vector<glm::mat3> m_Rotated;        // 16 per tet: R K_ij Rᵀ
+	std::vector<glm::vec3> m_ElementForces;  // 4 per tet
+	ClusterMoments m_Rotations;              // per tet: F and its warm-started rotation
+
+	BlockSparseMatrix m_System;
+	CsrAdjacency m_BlockEntries;             // BSR block -> its entries in m_Rotated
+	CsrAdjacency m_NodeCorners;              // node -> 4 t + corner
+	std::vector<glm::mat3> m_Preconditioner; // inverted diagonal blocks, zero for pinned nodes
+
+	std::vector<glm::vec3> m_Positions;
+	std::vector<glm::vec3> m_Velocities;
+	std::vector<glm::vec3> m_Dv;
+	std::vector<glm::vec3> m_Rhs;
+	std::vector<glm::vec3> m_Product;        // (h β + h²) K_R v
+	std::vector<float> m_Masses;             // lumped
+	std::vector<float> m_InverseMasses;
+	BlockPcg m_Pcg;
+	PcgResult m_LastSolve;
+
+	// Values the mesh and element stiffness were built for
+	int m_BuiltResolution = -1;
+	float m_BuiltYoungsModulus = -1.0f;
+	float m_BuiltPoissonRatio = -1.0f;
+	float m_BuiltDensity = -1.0f;
+
+public:
+	FemEngine() = default;
+
+	// Tetrahedralizes the rest surface (the body's particles, in order)
+	void Build(const std::vector<glm::vec3>& surface, const std::vector<Triangle>& triangles, int resolution);
+	bool NeedsBuild(size_t particleCount, const SimulationParams& params) const;
+
+	// Moves the interior nodes with the surface's center of mass and mean
+	// velocity, for a mesh built while the body is away from its rest pose
+	void FollowSurface(const ParticleStore& particles);
+
+	// Advances one physics step of `dt`, with the collider walls in the solve
+	void Step(ParticleStore& particles, const SimulationParams& params,
+			  const ColliderBox& collider, float dt);
+
+	// Interior nodes and rotations back to rest (the particles are back at rest)
+	void Reset();
+
+	inline size_t GetTetCount() const { return m_Mesh.tets.size(); }
+	inline size_t GetNodeCount() const { return m_Mesh.positions.size(); }
+	inline const PcgResult& GetLastSolve() const { return m_LastSolve; }
+
+private:
+	void UpdateMaterial(const SimulationParams& params);
+	void AssembleElements();
+	void AssembleSystem(const SimulationParams& params, const ColliderBox& collider, float dt);
+};
@@ -0,0 +1,126 @@
+#include "ImplicitSolver.h"
+#include "Parallel.h"
+#include <cmath>
+
+static const size_t SPRING_GRAIN = 4096;
+static const size_t PARTICLE_GRAIN = 2048;
+
+void ImplicitSolver::Build(size_t particleCount, const SpringTopology& springs)
+{
+	const auto& edges = springs.GetEdges();
+	m_System.BuildStructure(particleCount, edges);
+
+	size_t springCount = edges.size();
+	m_BlockAB.resize(springCount);
+	m_BlockBA.resize(springCount);
+	for (size_t s = 0; s < springCount; s++)
+	{
+		m_BlockAB[s] = m_System.FindBlock(edges[s].a, edges[s].b);
+		m_BlockBA[s] = m_System.FindBlock(edges[s].b, edges[s].a);
+	}
+
+	m_StiffnessBlocks.assign(springCount, glm::mat3(0.0f));
+	m_SpringBlocks.assign(springCount, glm::mat3(0.0f));
+	m_Preconditioner.assign(particleCount, glm::mat3(0.0f));
+
+	m_Rhs.assign(particleCount, glm::vec3(0.0f));
+	ClearWarmStart();
+}
+
+void ImplicitSolver::ClearWarmStart()
+{
+	m_Dv.assign(m_Rhs.size(), glm::vec3(0.0f));
+}
+
+void ImplicitSolver::Assemble(const ParticleStore& particles, const SpringTopology& springs, float dt)
+{
+	const auto& positions = particles.GetPositions();
+	const auto& velocities = particles.GetVelocities();
+	const auto& forces = particles.GetForces();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	const auto& edges = springs.GetEdges();
+	const auto& restLengths = springs.GetRestLengths();
+	const auto& stiffness = springs.GetStiffness();
+	const auto& damping = springs.GetDamping();
+
+	// Per-spring Jacobians. Under compression the transverse term is dropped
+	// (clamped at zero) so the matrix stays positive definite.
+	ParallelFor(0, springs.Size(), SPRING_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t s = first; s < last; s++)
+		{
+			glm::vec3 diff = positions[edges[s].a] - positions[edges[s].b];
+			float dist = glm::length(diff);
+			if (dist < 1e-8f)
+			{
+				m_StiffnessBlocks[s] = glm::mat3(0.0f);
+				m_SpringBlocks[s] = glm::mat3(0.0f);
+				continue;
+			}
+
+			glm::vec3 dir = diff / dist;
+			glm::mat3 dirOuter = glm::outerProduct(dir, dir);
+			float transverse = std::fmax(0.0f, 1.0f - restLengths[s] / dist);
+
+			glm::mat3 K = stiffness[s] * (dirOuter + transverse * (glm::mat3(1.0f) - dirOuter));
+			m_StiffnessBlocks[s] = K;
+			m_SpringBlocks[s] = (dt * damping[s]) * dirOuter + (dt * dt) * K;
+		}
+	});
+
+	// Rows are filled per particle through the spring adjacency, so each
+	// thread writes only its own rows of the matrix and right-hand side
+	const CsrAdjacency& adjacency = springs.GetParticleSprings();
+	auto& blocks = m_System.GetBlocks();
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			float mass = particles.GetMass(static_cast<ParticleId>(i));
+			glm::mat3 diagonal = mass * glm::mat3(1.0f);
+			glm::vec3 stiffnessTerm(0.0f);
+
+			for (uint32_t k = adjacency.RowBegin(i); k < adjacency.RowEnd(i); k++)
+			{
+				uint32_t entry = adjacency.entries[k];
+				uint32_t s = entry >> 1;
+				bool isEndB = (entry & 1u) != 0;
+				ParticleId other = isEndB ? edges[s].a : edges[s].b;
+
+				diagonal += m_SpringBlocks[s];
+				blocks[isEndB ? m_BlockBA[s] : m_BlockAB[s]] = -m_SpringBlocks[s];
+
+				// (dF/dx v)_i = K (v_other - v_i)
+				stiffnessTerm += m_StiffnessBlocks[s] * (velocities[other] - velocities[i]);
+			}
+
+			blocks[m_System.GetDiagonalBlock(i)] = diagonal;
+			m_Rhs[i] = dt * forces[i] + (dt * dt) * stiffnessTerm;
+
+			// Block-Jacobi; pinned particles get a zero preconditioner and rhs
+			if (inverseMasses[i] == 0.0f)
+			{
+				m_Preconditioner[i] = glm::mat3(0.0f);
+				m_Rhs[i] = glm::vec3(0.0f);
+				m_Dv[i] = glm::vec3(0.0f);
+			}
+			else
+			{
+				m_Preconditioner[i] = glm::inverse(diagonal);
+			}
+		}
+	});
+}
+
+void ImplicitSolver::Solve(const ParticleStore& particles, const SpringTopology& springs, float dt)
+{
+	size_t n = particles.Size();
+	if (m_Rhs.size() != n) Build(n, springs);
+
+	Assemble(particles, springs, dt);
+
+	PcgResult result = m_Pcg.Solve(m_System, m_Preconditioner, m_Rhs, particles.GetInverseMasses(), m_Dv,
+								   IMPLICIT_MAX_ITERATIONS, IMPLICIT_TOLERANCE);
+	m_LastIterations = result.iterations;
+	m_LastResidual = result.residual;
+}
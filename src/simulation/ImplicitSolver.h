@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "ParticleStore.h"
+#include "SpringTopology.h"
+#include "BlockSparseMatrix.h"
+#include "BlockPcg.h"
+
+const int IMPLICIT_MAX_ITERATIONS = 100;
+const float IMPLICIT_TOLERANCE = 1e-5f;
+
+// Baraff-Witkin backward Euler step for the spring network:
+//   (M - h dF/dv - h^2 dF/dx) dv = h (f + h dF/dx v)
+// The system matrix is assembled into a BSR matrix whose structure is built
+// once per topology, then solved with block-Jacobi preconditioned conjugate
+// gradients warm-started from the previous step's dv.
+class ImplicitSolver
+{
+private:
+	BlockSparseMatrix m_System;
+
+	// Per spring: BSR block indices of (a, b) and (b, a)
+	std::vector<uint32_t> m_BlockAB;
+	std::vector<uint32_t> m_BlockBA;
+
+	// Per spring: stiffness Jacobian K and system contribution h*c*nn^T + h^2*K
+	std::vector<glm::mat3> m_StiffnessBlocks;
+	std::vector<glm::mat3> m_SpringBlocks;
+
+	// Inverted diagonal blocks (zero for pinned particles, which filters them out)
+	std::vector<glm::mat3> m_Preconditioner;
+
+	std::vector<glm::vec3> m_Rhs;
+	std::vector<glm::vec3> m_Dv;
+	BlockPcg m_Pcg;
+
+	int m_LastIterations = 0;
+	float m_LastResidual = 0.0f;
+
+public:
+	ImplicitSolver() = default;
+
+	// Symbolic phase; call again whenever the spring topology changes
+	void Build(size_t particleCount, const SpringTopology& springs);
+
+	// Solves for dv using the forces currently accumulated in `particles`
+	// (which must include the spring/damping forces). Result in GetVelocityChange().
+	void Solve(const ParticleStore& particles, const SpringTopology& springs, float dt);
+
+	// Drops the warm start (after a reset or teleport)
+	void ClearWarmStart();
+
+	inline const std::vector<glm::vec3>& GetVelocityChange() const { return m_Dv; }
+	inline int GetLastIterations() const { return m_LastIterations; }
+	inline float GetLastResidual() const { return m_LastResidual; }
+
+private:
+	void Assemble(const ParticleStore& particles, const SpringTopology& springs, float dt);
+};
@@ -0,0 +1,118 @@
+#include "MeshCollider.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+static const size_t PARTICLE_GRAIN = 1024;
+
+void MeshCollider::Build(std::vector<glm::vec3> positions, std::vector<Triangle> triangles)
+{
+	m_Positions = std::move(positions);
+	m_Triangles = std::move(triangles);
+	m_Bvh.Build(m_Triangles, m_Positions, BvhSplit::Sah);
+}
+
+size_t MeshCollider::Resolve(ParticleStore& particles, const glm::mat4& localToCollider,
+							 const glm::mat4& colliderToLocal, float thickness, float restitution, float dt) const
+{
+	if (m_Triangles.empty()) return 0;
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+
+	// A collider-space distance is at most the local one over the smallest
+	// scale, so searching that far never misses a face
+	glm::mat3 linear(colliderToLocal);
+	float minScale = std::min(glm::length(linear[0]), std::min(glm::length(linear[1]), glm::length(linear[2])));
+	if (minScale < 1e-8f) return 0;
+	float inverseScale = 1.0f / minScale;
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(linear));
+
+	return ParallelReduce(0, positions.size(), PARTICLE_GRAIN, size_t(0),
+		[&](size_t first, size_t last)
+		{
+			size_t contacts = 0;
+			for (size_t i = first; i < last; i++)
+			{
+				glm::vec3& p = positions[i];
+				glm::vec3& v = velocities[i];
+
+				// Deep enough to catch a particle that crossed the surface this step
+				float reach = thickness + glm::length(v) * dt;
+				glm::vec3 q = glm::vec3(localToCollider * glm::vec4(p, 1.0f));
+
+				BvhHit hit;
+				if (!m_Bvh.FindClosest(q, reach * inverseScale, m_Triangles, m_Positions, hit))
+					continue;
+
+				const Triangle& tri = m_Triangles[hit.triangle];
+				const glm::vec3& a = m_Positions[tri.vertex[0]];
+				glm::vec3 normal = normalMatrix * glm::cross(m_Positions[tri.vertex[1]] - a,
+															 m_Positions[tri.vertex[2]] - a);
+				float length = glm::length(normal);
+				if (length < 1e-12f) continue;
+				normal /= length;
+
+				glm::vec3 closest = glm::vec3(colliderToLocal * glm::vec4(hit.point, 1.0f));
+				float separation = glm::dot(p - closest, normal);
+				if (separation >= thickness || separation < -reach) continue;
+
+				p += (thickness - separation) * normal;
+
+				float vn = glm::dot(v, normal);
+				if (vn < 0.0f)
+					v -= (1.0f + restitution) * vn * normal;
+				contacts++;
+			}
+			return contacts;
+		},
+		[](size_t a, size_t b) { return a + b; });
+}
+
+size_t MeshCollider::ResolveSwept(ParticleStore& particles, const std::vector<glm::vec3>& startPositions,
+								  const glm::mat4& localToCollider, const glm::mat4& colliderToLocal,
+								  float thickness, float restitution) const
+{
+	if (m_Triangles.empty() || startPositions.size() != particles.Size()) return 0;
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(colliderToLocal)));
+
+	return ParallelReduce(0, positions.size(), PARTICLE_GRAIN, size_t(0),
+		[&](size_t first, size_t last)
+		{
+			size_t contacts = 0;
+			for (size_t i = first; i < last; i++)
+			{
+				glm::vec3& p = positions[i];
+				glm::vec3& v = velocities[i];
+				if (p == startPositions[i]) continue;
+
+				BvhHit hit;
+				if (!m_Bvh.IntersectSegment(glm::vec3(localToCollider * glm::vec4(startPositions[i], 1.0f)),
+											glm::vec3(localToCollider * glm::vec4(p, 1.0f)),
+											m_Triangles, m_Positions, hit))
+					continue;
+
+				const Triangle& tri = m_Triangles[hit.triangle];
+				const glm::vec3& a = m_Positions[tri.vertex[0]];
+				glm::vec3 normal = normalMatrix * glm::cross(m_Positions[tri.vertex[1]] - a,
+															 m_Positions[tri.vertex[2]] - a);
+				float length = glm::length(normal);
+				if (length < 1e-12f) continue;
+				normal /= length;
+
+				// End point projected onto the contact plane, lifted by the thickness
+				glm::vec3 contact = glm::vec3(colliderToLocal * glm::vec4(hit.point, 1.0f));
+				p += (thickness - glm::dot(p - contact, normal)) * normal;
+
+				float vn = glm::dot(v, normal);
+				if (vn < 0.0f)
+					v -= (1.0f + restitution) * vn * normal;
+				contacts++;
+			}
+			return contacts;
+		},
+		[](size_t a, size_t b) { return a + b; });
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Geometry.h"
+#include "ParticleStore.h"
+#include "TriangleBvh.h"
+
+// Static triangle mesh that particles collide with, e.g. a loaded Model.
+// The triangles are kept in the mesh's own (collider) space under an SAH
+// TriangleBvh built once; moving, rotating or scaling the model only
+// changes the transforms handed to Resolve. Each particle asks the BVH for
+// its nearest face within the distance it can have travelled this step,
+// measures the signed separation along that face's outward normal
+// (counter-clockwise winding) and, when closer than the thickness or
+// behind the face, is projected back out with its normal velocity
+// reflected. Particles only write themselves, so the batch runs in parallel
+// and costs O(particles * log(triangles)).
+class MeshCollider
+{
+private:
+	std::vector<glm::vec3> m_Positions;
+	std::vector<Triangle> m_Triangles;
+	TriangleBvh m_Bvh;
+
+public:
+	MeshCollider() = default;
+
+	void Build(std::vector<glm::vec3> positions, std::vector<Triangle> triangles);
+
+	// localToCollider maps simulation space into the mesh's space and
+	// colliderToLocal back; returns the number of particles corrected
+	size_t Resolve(ParticleStore& particles, const glm::mat4& localToCollider, const glm::mat4& colliderToLocal,
+				   float thickness, float restitution, float dt) const;
+
+	// Continuous pass: a particle whose path from startPositions crosses a
+	// face from the front is put back in front of that face, keeping its
+	// tangential motion; run before Resolve so nothing tunnels through
+	// thin parts of the mesh
+	size_t ResolveSwept(ParticleStore& particles, const std::vector<glm::vec3>& startPositions,
+						const glm::mat4& localToCollider, const glm::mat4& colliderToLocal,
+						float thickness, float restitution) const;
+
+	inline bool IsEmpty() const { return m_Triangles.empty(); }
+	inline size_t GetTriangleCount() const { return m_Triangles.size(); }
+	inline const TriangleBvh& GetBvh() const { return m_Bvh; }
+	inline const std::vector<glm::vec3>& GetPositions() const { return m_Positions; }
+	inline const std::vector<Triangle>& GetTriangles() const { return m_Triangles; }
+};
+
+// A collider placed in the scene for one frame
+struct MeshColliderInstance
+{
+	const MeshCollider* collider = nullptr;
+	glm::mat4 localToCollider = glm::mat4(1.0f);
+	glm::mat4 colliderToLocal = glm::mat4(1.0f);
+};
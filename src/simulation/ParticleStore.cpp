@@ -0,0 +1,47 @@
+#include "ParticleStore.h"
+
+ParticleId ParticleStore::Add(const glm::vec3& position, float mass)
+{
+	ParticleId id = static_cast<ParticleId>(m_Positions.size());
+
+	m_Positions.push_back(position);
+	m_Velocities.push_back(glm::vec3(0.0f));
+	m_Forces.push_back(glm::vec3(0.0f));
+	m_InverseMasses.push_back(mass > 0.0f ? 1.0f / mass : 0.0f);
+
+	return id;
+}
+
+void ParticleStore::Reserve(size_t count)
+{
+	m_Positions.reserve(count);
+	m_Velocities.reserve(count);
+	m_Forces.reserve(count);
+	m_InverseMasses.reserve(count);
+}
+
+void ParticleStore::Clear()
+{
+	m_Positions.clear();
+	m_Velocities.clear();
+	m_Forces.clear();
+	m_InverseMasses.clear();
+}
+
+void ParticleStore::SetMass(ParticleId id, float mass)
+{
+	m_InverseMasses[id] = mass > 0.0f ? 1.0f / mass : 0.0f;
+}
+
+void ParticleStore::SetUniformMass(float mass)
+{
+	float inverseMass = mass > 0.0f ? 1.0f / mass : 0.0f;
+	for (auto& w : m_InverseMasses)
+		w = inverseMass;
+}
+
+void ParticleStore::ClearForces()
+{
+	for (auto& f : m_Forces)
+		f = glm::vec3(0.0f);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+const float PARTICLE_MASS = 0.5f;
+
+// Particles are addressed by their index into the store
+using ParticleId = uint32_t;
+
+// Structure-of-arrays particle storage.
+// Each attribute lives in its own contiguous array so the PhysicsEngine
+// loops stream through memory instead of chasing one pointer per particle.
+class ParticleStore
+{
+private:
+	std::vector<glm::vec3> m_Positions;
+	std::vector<glm::vec3> m_Velocities;
+	std::vector<glm::vec3> m_Forces;
+	std::vector<float> m_InverseMasses;
+
+public:
+	ParticleStore() = default;
+
+	ParticleId Add(const glm::vec3& position, float mass = PARTICLE_MASS);
+	void Reserve(size_t count);
+	void Clear();
+
+	void SetMass(ParticleId id, float mass);
+	void SetUniformMass(float mass);
+	void ClearForces();
+
+	inline size_t Size() const { return m_Positions.size(); }
+	inline float GetMass(ParticleId id) const
+	{
+		return m_InverseMasses[id] > 0.0f ? 1.0f / m_InverseMasses[id] : 0.0f;
+	}
+
+	inline std::vector<glm::vec3>& GetPositions() { return m_Positions; }
+	inline std::vector<glm::vec3>& GetVelocities() { return m_Velocities; }
+	inline std::vector<glm::vec3>& GetForces() { return m_Forces; }
+	inline std::vector<float>& GetInverseMasses() { return m_InverseMasses; }
+
+	inline const std::vector<glm::vec3>& GetPositions() const { return m_Positions; }
+	inline const std::vector<glm::vec3>& GetVelocities() const { return m_Velocities; }
+	inline const std::vector<glm::vec3>& GetForces() const { return m_Forces; }
+	inline const std::vector<float>& GetInverseMasses() const { return m_InverseMasses; }
+};
@@ -1,93 +1,189 @@
 #include "PhysicsEngine.h"
-#include <unordered_map>
+#include "Parallel.h"
+#include <algorithm>
 #include <cmath>
 
+// Minimum work per thread; smaller bodies simply run on the calling thread
+static const size_t SPRING_GRAIN = 4096;
+static const size_t FACE_GRAIN = 4096;
+static const size_t PARTICLE_GRAIN = 2048;
+
 // Eq. 1: F_gi^t = m_i * g
-void PhysicsEngine::ApplyGravity(std::vector<std::shared_ptr<Particle>>& particles,
-								 float gravityStrength)
+void PhysicsEngine::ApplyGravity(ParticleStore& particles, float gravityStrength)
 {
-	for (auto& p : particles)
+	auto& forces = particles.GetForces();
+	size_t n = particles.Size();
+	for (size_t i = 0; i < n; i++)
 	{
-		float fy = p->GetMass() * gravityStrength;
-		p->AddForce(glm::vec3(0.0f, fy, 0.0f));
+		float fy = particles.GetMass(static_cast<ParticleId>(i)) * gravityStrength;
+		forces[i] += glm::vec3(0.0f, fy, 0.0f);
 	}
 }
 
 // Continuous external force (e.g. wind, push) applied to every particle
-void PhysicsEngine::ApplyExternalForce(std::vector<std::shared_ptr<Particle>>& particles,
-										const glm::vec3& force)
+void PhysicsEngine::ApplyExternalForce(ParticleStore& particles, const glm::vec3& force)
 {
 	if (force.x == 0.0f && force.y == 0.0f && force.z == 0.0f) return;
-	for (auto& p : particles)
-		p->AddForce(force);
+	for (auto& f : particles.GetForces())
+		f += force;
 }
 
-// Eq. 2: F_si^t = Σ k_ij * (|x_j - x_i| - l_ij^0) * (x_j - x_i) / |x_j - x_i|
-// Eq. 3: F_di^t = Σ k_ij * h * (v_i - v_j) projected onto spring direction
-void PhysicsEngine::ApplySpringDampingForces(std::vector<std::shared_ptr<Spring>>& springs,
-											 float springK, float dampingK)
+// Spring force (Eq. 2) + Damping force (Eq. 3) projected onto spring axis,
+// evaluated 4/8/16 springs at a time; each range writes its own springs
+void PhysicsEngine::EvaluateSpringForces(const ParticleStore& particles, SpringTopology& springs)
 {
-	for (auto& spring : springs)
+	const auto& positions = particles.GetPositions();
+	const auto& velocities = particles.GetVelocities();
+	const auto& edges = springs.GetEdges();
+	auto& springForces = springs.GetSpringForces();
+
+	ParallelFor(0, springs.Size(), SPRING_GRAIN, [&](size_t first, size_t last)
 	{
-		auto p1 = spring->GetEndOne();
-		auto p2 = spring->GetEndTwo();
+		SpringKernels::Evaluate(positions.data(), velocities.data(),
+								edges.data(), springs.GetRestLengths().data(),
+								springs.GetStiffness().data(), springs.GetDamping().data(),
+								first, last, springForces.data());
+	});
+}
+
+// Eq. 5: P = V^{-1} * n * R * T  (temperature T=1 assumed for simplicity)
+float PhysicsEngine::CalculatePressure(float volume, unsigned int moles)
+{
+	if (volume <= 0.0f) return 0.0f;
+	return (1.0f / volume) * moles * GAS_CONSTANT_R;
+}
 
-		glm::vec3 diff = p1->GetPosition() - p2->GetPosition();
-		float distance = glm::length(diff);
+// Fused face pass: one cross product per triangle feeds both the signed
+// volume (divergence theorem, a · (b × c) = a · ((b - a) × (c - a))) and the
+// area-weighted outward normal stored per face for the vertex gather
+template <typename Precision>
+float PhysicsEngine::ComputeSurface(const ParticleStore& particles, SurfaceTopology& surface)
+{
+	using Scalar = typename Precision::Scalar;
+	using Accumulator = typename Precision::Accumulator;
+	using Vec3 = typename Precision::Vec3;
 
-		if (distance == 0.0f) continue;
+	const auto& positions = particles.GetPositions();
+	const auto& faces = surface.GetTriangles();
+	auto& faceVectors = surface.GetFaceVectors();
 
-		glm::vec3 direction = diff / distance;
-		glm::vec3 relVel = p1->GetVelocity() - p2->GetVelocity();
+	Accumulator volume = ParallelReduce(0, faces.size(), FACE_GRAIN, Accumulator(),
+		[&](size_t first, size_t last)
+		{
+			Accumulator partial;
+			for (size_t f = first; f < last; f++)
+			{
+				const Triangle& face = faces[f];
+				Vec3 v1(positions[face.vertex[0]]);
+				Vec3 crossProduct = TriangleCrossProduct(v1,
+					Vec3(positions[face.vertex[1]]), Vec3(positions[face.vertex[2]]));
+
+				partial.Add(glm::dot(v1, crossProduct));
+
+				// Negate cross product to ensure outward-facing normals
+				// (icosphere winding produces inward normals from cross(v2-v1, v3-v1));
+				// |cross| / 2 is the face area, so this is area * n_hat
+				faceVectors[f] = glm::vec3(Scalar(-0.5) * crossProduct);
+			}
+			return partial;
+		},
+		[](Accumulator a, const Accumulator& b) { a.Merge(b); return a; });
+
+	return static_cast<float>(std::fabs(volume.Value()) / 6.0);
+}
 
-		// Spring force (Eq. 2) + Damping force (Eq. 3) projected onto spring axis
-		float forceMagnitude = (distance - spring->GetRestLength()) * springK +
-							   (glm::dot(relVel, direction)) * dampingK;
+float PhysicsEngine::ComputeSurface(PrecisionMode precision, const ParticleStore& particles,
+									SurfaceTopology& surface)
+{
+	switch (precision)
+	{
+	case PrecisionMode::Mixed:  return ComputeSurface<MixedPrecision>(particles, surface);
+	case PrecisionMode::Double: return ComputeSurface<DoublePrecision>(particles, surface);
+	default:                    return ComputeSurface<FloatPrecision>(particles, surface);
+	}
+}
 
-		glm::vec3 force = direction * forceMagnitude;
+template <typename Precision>
+float PhysicsEngine::ComputeKineticEnergy(const ParticleStore& particles, float& maxSpeed2)
+{
+	using Scalar = typename Precision::Scalar;
+	using Vec3 = typename Precision::Vec3;
 
-		// Equal and opposite forces on connected particles
-		p1->AddForce(-force);
-		p2->AddForce(force);
+	const auto& velocities = particles.GetVelocities();
+	const auto& inverseMasses = particles.GetInverseMasses();
 
-		spring->SetNormalVector(direction);
+	typename Precision::Accumulator energy;
+	Scalar maxSpeed = Scalar(0);
+	for (size_t i = 0; i < velocities.size(); i++)
+	{
+		Vec3 v(velocities[i]);
+		Scalar speed2 = glm::dot(v, v);
+		if (inverseMasses[i] > 0.0f)
+			energy.Add(Scalar(0.5) * speed2 / Scalar(inverseMasses[i]));
+		maxSpeed = std::max(maxSpeed, speed2);
 	}
+
+	maxSpeed2 = static_cast<float>(maxSpeed);
+	return static_cast<float>(energy.Value());
 }
 
-// Eq. 5: P = V^{-1} * n * R * T  (temperature T=1 assumed for simplicity)
-float PhysicsEngine::CalculatePressure(float volume, unsigned int moles)
+float PhysicsEngine::ComputeKineticEnergy(PrecisionMode precision, const ParticleStore& particles,
+										  float& maxSpeed2)
 {
-	if (volume <= 0.0f) return 0.0f;
-	return (1.0f / volume) * moles * GAS_CONSTANT_R;
+	switch (precision)
+	{
+	case PrecisionMode::Mixed:  return ComputeKineticEnergy<MixedPrecision>(particles, maxSpeed2);
+	case PrecisionMode::Double: return ComputeKineticEnergy<DoublePrecision>(particles, maxSpeed2);
+	default:                    return ComputeKineticEnergy<FloatPrecision>(particles, maxSpeed2);
+	}
 }
 
 // Eq. 6: F_pi^t = Σ a_ijk * n_hat * (1/V) * n * R * T
-void PhysicsEngine::ApplyPressureForce(std::vector<std::shared_ptr<Particle>>& particles,
-									   const std::vector<Triangle>& faces,
-									   const std::vector<Vertex>& vertices,
+// Each vertex sums the area-weighted normals of its faces once; scaled by the
+// pressure that is the force, normalized it is the smooth vertex normal
+void PhysicsEngine::ApplyPressureForce(ParticleStore& particles,
+									   SurfaceTopology& surface,
 									   float pressure)
 {
-	for (auto& face : faces)
+	const CsrAdjacency& adjacency = surface.GetVertexFaces();
+	const auto& faceVectors = surface.GetFaceVectors();
+	auto& normals = surface.GetVertexNormals();
+	auto& forces = particles.GetForces();
+
+	ParallelFor(0, adjacency.GetRowCount(), PARTICLE_GRAIN, [&](size_t first, size_t last)
 	{
-		glm::vec3 v1 = vertices[face.vertex[0]].Position;
-		glm::vec3 v2 = vertices[face.vertex[1]].Position;
-		glm::vec3 v3 = vertices[face.vertex[2]].Position;
+		for (size_t i = first; i < last; i++)
+		{
+			glm::vec3 sum(0.0f);
+			for (uint32_t k = adjacency.RowBegin(i); k < adjacency.RowEnd(i); k++)
+				sum += faceVectors[adjacency.entries[k]];
 
-		// Negate cross product to ensure outward-facing normals
-		// (icosphere winding produces inward normals from cross(v2-v1, v3-v1))
-		glm::vec3 crossProduct = -TriangleCrossProduct(v1, v2, v3);
-		float magnitude = glm::length(crossProduct);
+			forces[i] += pressure * sum;
+			float length = glm::length(sum);
+			normals[i] = (length > 0.0f) ? sum / length : glm::vec3(0.0f);
+		}
+	});
+}
 
-		if (magnitude == 0.0f) continue;
+// Normals only (used when no pressure step runs, e.g. after a reset)
+void PhysicsEngine::ComputeVertexNormals(SurfaceTopology& surface)
+{
+	const CsrAdjacency& adjacency = surface.GetVertexFaces();
+	const auto& faceVectors = surface.GetFaceVectors();
+	auto& normals = surface.GetVertexNormals();
 
-		glm::vec3 normal = crossProduct / magnitude;
-		float area = 0.5f * magnitude;
+	ParallelFor(0, adjacency.GetRowCount(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			glm::vec3 sum(0.0f);
+			for (uint32_t k = adjacency.RowBegin(i); k < adjacency.RowEnd(i); k++)
+				sum += faceVectors[adjacency.entries[k]];
 
-		// Apply pressure force to each vertex of the face
-		glm::vec3 pressureForce = pressure * area * normal;
-		for (unsigned int i = 0; i < face.GetVertexCount(); ++i)
-			particles[face.vertex[i]]->AddForce(pressureForce);
-	}
+			float length = glm::length(sum);
+			normals[i] = (length > 0.0f) ? sum / length : glm::vec3(0.0f);
+		}
+	});
 }
 
 float PhysicsEngine::CalculateAABBVolume(const glm::vec3& bbMin, const glm::vec3& bbMax)
@@ -118,150 +214,119 @@ float PhysicsEngine::CalculateBoundingEllipsoidVolume(const glm::vec3& bbMin, co
 	return (4.0f / 3.0f) * PI * a * b * c;
 }
 
-// Addition 1: Exact volume via divergence theorem
-// V = Σ (1/6) * a · (b × c)  for each triangular face
-float PhysicsEngine::CalculateExactVolume(const std::vector<Triangle>& faces,
-										  const std::vector<Vertex>& vertices)
+// Symplectic (semi-implicit) Euler: the position update uses the new velocity
+void PhysicsEngine::Integrate(ParticleStore& particles, float stepSize)
 {
-	float volume = 0.0f;
-	for (const auto& face : faces)
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& forces = particles.GetForces();
+	const auto& inverseMasses = particles.GetInverseMasses();
+
+	size_t n = particles.Size();
+	for (size_t i = 0; i < n; i++)
 	{
-		const glm::vec3& a = vertices[face.vertex[0]].Position;
-		const glm::vec3& b = vertices[face.vertex[1]].Position;
-		const glm::vec3& c = vertices[face.vertex[2]].Position;
-		volume += glm::dot(a, glm::cross(b, c));
+		glm::vec3 acceleration = forces[i] * inverseMasses[i];
+		velocities[i] += acceleration * stepSize;
+		positions[i] += velocities[i] * stepSize;
 	}
-	return std::fabs(volume) / 6.0f;
 }
 
-// Velocity Verlet integration
-void PhysicsEngine::Integrate(std::vector<std::shared_ptr<Particle>>& particles,
-							  float stepSize)
+// Baraff-Witkin backward Euler: the solver assembles
+//   (M - h dF/dv - h^2 dF/dx) dv = h (f + h dF/dx v)
+// into its BSR matrix and solves it with block-Jacobi PCG; the accumulated
+// forces (gravity, external, pressure) are part of f. Then v += dv, x += h v.
+void PhysicsEngine::IntegrateImplicit(ParticleStore& particles,
+									   const SpringTopology& springs,
+									   ImplicitSolver& solver,
+									   float dt)
 {
-	for (auto& particle : particles)
-	{
-		glm::vec3 acceleration = particle->GetForceAccumulated() / particle->GetMass();
-		glm::vec3 velocity = particle->GetVelocity() + acceleration * stepSize;
-		glm::vec3 position = particle->GetPosition() + velocity * stepSize;
+	solver.Solve(particles, springs, dt);
 
-		particle->SetVelocity(velocity);
-		particle->SetPosition(position);
-	}
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& dv = solver.GetVelocityChange();
+
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			velocities[i] += dv[i];
+			positions[i] += velocities[i] * dt;
+		}
+	});
 }
 
-// Simplified implicit (backward Euler) integration
-// Spring/damping forces are solved implicitly via Jacobians.
-// Explicit forces (gravity, pressure) are applied as a direct velocity kick
-// since they don't cause stiffness-related instability.
-void PhysicsEngine::IntegrateImplicit(std::vector<std::shared_ptr<Particle>>& particles,
-									   std::vector<std::shared_ptr<Spring>>& springs,
-									   const std::vector<glm::vec3>& explicitForces,
-									   float springK, float dampingK, float dt)
+// Paper Section 3.2.4, Eq. 8: Point vs AABB collision + response
+void PhysicsEngine::ResolveCollisions(ParticleStore& particles, const ColliderBox& collider)
 {
-	size_t n = particles.size();
+	if (!collider.enabled) return;
 
-	// Apply explicit forces (gravity + pressure) as velocity kick
-	for (size_t i = 0; i < n; i++)
-	{
-		glm::vec3 v = particles[i]->GetVelocity();
-		v += (explicitForces[i] / particles[i]->GetMass()) * dt;
-		particles[i]->SetVelocity(v);
-	}
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
 
-	// Map particle pointer -> index for Jacobian accumulation
-	std::unordered_map<Particle*, size_t> indexMap;
-	indexMap.reserve(n);
+	size_t n = particles.Size();
 	for (size_t i = 0; i < n; i++)
-		indexMap[particles[i].get()] = i;
-
-	// Per-particle Jacobian accumulators
-	std::vector<glm::mat3> dFdx(n, glm::mat3(0.0f));
-	std::vector<glm::mat3> dFdv(n, glm::mat3(0.0f));
-
-	glm::mat3 I(1.0f);
-
-	// Accumulate Jacobians from each spring
-	for (auto& spring : springs)
-	{
-		Particle* p1 = spring->GetEndOne().get();
-		Particle* p2 = spring->GetEndTwo().get();
+		collider.ResolveCollision(positions[i], velocities[i]);
+}
 
-		size_t idx1 = indexMap[p1];
-		size_t idx2 = indexMap[p2];
+void PhysicsEngine::ClearForces(ParticleStore& particles)
+{
+	particles.ClearForces();
+}
 
-		glm::vec3 diff = p1->GetPosition() - p2->GetPosition();
-		float dist = glm::length(diff);
-		if (dist < 1e-8f) continue;
+// Ericson, Real-Time Collision Detection 5.1.5: Voronoi regions of the
+// vertices and edges first, the face interior last
+glm::vec3 PhysicsEngine::ClosestPointOnTriangle(const glm::vec3& p, const glm::vec3& a,
+												 const glm::vec3& b, const glm::vec3& c,
+												 glm::vec3& weights)
+{
+	glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+	float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f) { weights = glm::vec3(1, 0, 0); return a; }
 
-		glm::vec3 dir = diff / dist;
-		float l0 = spring->GetRestLength();
+	glm::vec3 bp = p - b;
+	float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3) { weights = glm::vec3(0, 1, 0); return b; }
 
-		// Jacobian of spring force on particle i w.r.t. x_i:
-		// dF/dx = -k * [(1 - l0/r)*I + (l0/r) * dir*dir^T]
-		float ratio = l0 / dist;
-		glm::mat3 dirOuter = glm::outerProduct(dir, dir);
-		glm::mat3 Jx = -springK * ((1.0f - ratio) * I + ratio * dirOuter);
+	float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+	{
+		float v = d1 / (d1 - d3);
+		weights = glm::vec3(1.0f - v, v, 0.0f);
+		return a + v * ab;
+	}
 
-		dFdx[idx1] += Jx;
-		dFdx[idx2] += Jx;
+	glm::vec3 cp = p - c;
+	float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6) { weights = glm::vec3(0, 0, 1); return c; }
 
-		// Jacobian of damping force: dF/dv = -c * I (simplified)
-		glm::mat3 Jv = -dampingK * I;
-		dFdv[idx1] += Jv;
-		dFdv[idx2] += Jv;
+	float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+	{
+		float w = d2 / (d2 - d6);
+		weights = glm::vec3(1.0f - w, 0.0f, w);
+		return a + w * ac;
 	}
 
-	// Implicit solve for spring/damping only:
-	// (m*I - dt*dFdv - dt^2*dFdx) * dv = dt*F_sd + dt^2*dFdx*v
-	// where F_sd = spring + damping forces (in ForceAccumulated)
-	for (size_t i = 0; i < n; i++)
+	float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
 	{
-		float mass = particles[i]->GetMass();
-		glm::vec3 Fsd = particles[i]->GetForceAccumulated();
-		glm::vec3 v = particles[i]->GetVelocity();
-
-		glm::mat3 A = mass * I - dt * dFdv[i] - dt * dt * dFdx[i];
-		glm::vec3 b = dt * Fsd + dt * dt * dFdx[i] * v;
-
-		float det = glm::determinant(A);
-		glm::vec3 dv;
-		if (std::fabs(det) < 1e-12f)
-		{
-			// Fallback to explicit if singular
-			dv = (Fsd / mass) * dt;
-		}
-		else
-		{
-			dv = glm::inverse(A) * b;
-		}
-
-		glm::vec3 newVel = v + dv;
-		glm::vec3 newPos = particles[i]->GetPosition() + newVel * dt;
-
-		particles[i]->SetVelocity(newVel);
-		particles[i]->SetPosition(newPos);
+		float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		weights = glm::vec3(0.0f, 1.0f - w, w);
+		return b + w * (c - b);
 	}
-}
 
-// Paper Section 3.2.4, Eq. 8: Point vs AABB collision + response
-void PhysicsEngine::ResolveCollisions(std::vector<std::shared_ptr<Particle>>& particles,
-									  const ColliderBox& collider)
-{
-	if (!collider.enabled) return;
-
-	for (auto& particle : particles)
-		collider.ResolveCollision(particle);
+	float denom = 1.0f / (va + vb + vc);
+	float v = vb * denom;
+	float w = vc * denom;
+	weights = glm::vec3(1.0f - v - w, v, w);
+	return a + ab * v + ac * w;
 }
 
-void PhysicsEngine::ClearForces(std::vector<std::shared_ptr<Particle>>& particles)
-{
-	for (auto& p : particles)
-		p->ClearForce();
-}
-
-glm::vec3 PhysicsEngine::TriangleCrossProduct(const glm::vec3& v1,
-											   const glm::vec3& v2,
-											   const glm::vec3& v3)
-{
-	return glm::cross(v2 - v1, v3 - v1);
-}
+// Instantiations for the policies in Precision.h
+template float PhysicsEngine::ComputeSurface<FloatPrecision>(const ParticleStore&, SurfaceTopology&);
+template float PhysicsEngine::ComputeSurface<MixedPrecision>(const ParticleStore&, SurfaceTopology&);
+template float PhysicsEngine::ComputeSurface<DoublePrecision>(const ParticleStore&, SurfaceTopology&);
+template float PhysicsEngine::ComputeKineticEnergy<FloatPrecision>(const ParticleStore&, float&);
+template float PhysicsEngine::ComputeKineticEnergy<MixedPrecision>(const ParticleStore&, float&);
+template float PhysicsEngine::ComputeKineticEnergy<DoublePrecision>(const ParticleStore&, float&);
@@ -3,10 +3,14 @@
 #include <vector>
 #include <memory>
 #include <glm/glm.hpp>
-#include "Particle.h"
-#include "Spring.h"
+#include "ParticleStore.h"
+#include "SpringTopology.h"
+#include "SpringKernels.h"
+#include "SurfaceTopology.h"
+#include "ImplicitSolver.h"
 #include "ColliderBox.h"
 #include "SimulationParams.h"
+#include "Precision.h"
 #include "Geometry.h"
 
 // Gas constant R (J/(mol*K)) — paper Eq. 4
@@ -19,62 +23,84 @@ const float GAS_CONSTANT_R = 8.3145f;
 //   Eq. 5-6: Internal pressure force
 //   Eq. 7: Net force accumulation
 //   Eq. 8-9: AABB collision detection & response
+// The reductions (volume, kinetic energy) are templated on a Precision
+// policy and instantiated for FloatPrecision, MixedPrecision and
+// DoublePrecision; the PrecisionMode overloads pick one at runtime.
 class PhysicsEngine
 {
 public:
 	// Eq. 1: F_gi = m_i * g
-	static void ApplyGravity(std::vector<std::shared_ptr<Particle>>& particles,
-							 float gravityStrength);
+	static void ApplyGravity(ParticleStore& particles, float gravityStrength);
 
 	// Continuous external force applied uniformly to all particles
-	static void ApplyExternalForce(std::vector<std::shared_ptr<Particle>>& particles,
-								    const glm::vec3& force);
+	static void ApplyExternalForce(ParticleStore& particles, const glm::vec3& force);
 
 	// Eq. 2 & 3: Spring force + Damping force combined
 	// F_si = Σ k_ij * (|x_j - x_i| - l_ij^0) * (x_j - x_i) / |x_j - x_i|
 	// F_di = Σ k_ij * h * (v_i - v_j) projected onto spring direction
-	static void ApplySpringDampingForces(std::vector<std::shared_ptr<Spring>>& springs,
-										 float springK, float dampingK);
+	// k_ij and the damping coefficient are read per spring from the topology.
+	// Writes the force on each spring's second particle into
+	// springs.GetSpringForces() through the runtime-dispatched SpringKernels;
+	// the StepPipeline force stages gather them per particle
+	static void EvaluateSpringForces(const ParticleStore& particles, SpringTopology& springs);
 
 	// Eq. 5: P = V^{-1} * n * R * T  (T=1 assumed)
 	static float CalculatePressure(float volume, unsigned int moles);
 
+	// Single streaming pass over the faces: returns the exact (divergence
+	// theorem) volume and stores each face's area-weighted outward normal
+	template <typename Precision = FloatPrecision>
+	static float ComputeSurface(const ParticleStore& particles, SurfaceTopology& surface);
+	static float ComputeSurface(PrecisionMode precision, const ParticleStore& particles,
+								SurfaceTopology& surface);
+
+	// Total kinetic energy Σ ½ m v²; also reports the largest squared speed
+	template <typename Precision = FloatPrecision>
+	static float ComputeKineticEnergy(const ParticleStore& particles, float& maxSpeed2);
+	static float ComputeKineticEnergy(PrecisionMode precision, const ParticleStore& particles,
+									  float& maxSpeed2);
+
 	// Eq. 6: F_pi = Σ a_ijk * n_hat * (1/V) * n * R * T
-	static void ApplyPressureForce(std::vector<std::shared_ptr<Particle>>& particles,
-								   const std::vector<Triangle>& faces,
-								   const std::vector<Vertex>& vertices,
+	// Per-vertex gather of the face vectors from ComputeSurface; also writes
+	// the smooth vertex normals used for rendering
+	static void ApplyPressureForce(ParticleStore& particles,
+								   SurfaceTopology& surface,
 								   float pressure);
+	static void ComputeVertexNormals(SurfaceTopology& surface);
 
 	// Volume computation methods (Addition 1: Section 3.2.3a)
 	static float CalculateAABBVolume(const glm::vec3& bbMin, const glm::vec3& bbMax);
 	static float CalculateBoundingSphereVolume(const glm::vec3& bbMin, const glm::vec3& bbMax);
 	static float CalculateBoundingEllipsoidVolume(const glm::vec3& bbMin, const glm::vec3& bbMax);
-	static float CalculateExactVolume(const std::vector<Triangle>& faces,
-									  const std::vector<Vertex>& vertices);
 
-	// Forward Euler integration: v += a*dt, x += v*dt
-	static void Integrate(std::vector<std::shared_ptr<Particle>>& particles,
-						  float stepSize);
+	// Symplectic Euler integration: v += a*dt, x += v*dt
+	static void Integrate(ParticleStore& particles, float stepSize);
 
-	// Simplified implicit (backward Euler) integration
-	// Implicit solve for spring/damping only; explicit forces (gravity, pressure)
-	// are passed in separately and added as an explicit velocity kick.
-	static void IntegrateImplicit(std::vector<std::shared_ptr<Particle>>& particles,
-								   std::vector<std::shared_ptr<Spring>>& springs,
-								   const std::vector<glm::vec3>& explicitForces,
-								   float springK, float dampingK, float stepSize);
+	// Backward Euler (Baraff-Witkin): springs/damping are linearized and
+	// solved implicitly by the PCG solver; the other accumulated forces
+	// (gravity, external, pressure) enter the right-hand side as-is
+	static void IntegrateImplicit(ParticleStore& particles,
+								   const SpringTopology& springs,
+								   ImplicitSolver& solver,
+								   float stepSize);
 
 	// Eq. 8: Point vs AABB collision detection and response
 	// Paper Section 3.3 Step 7(b)(c)
-	static void ResolveCollisions(std::vector<std::shared_ptr<Particle>>& particles,
-								  const ColliderBox& collider);
+	static void ResolveCollisions(ParticleStore& particles, const ColliderBox& collider);
+
+	// Closest point on triangle abc to p, with its barycentric weights
+	static glm::vec3 ClosestPointOnTriangle(const glm::vec3& p, const glm::vec3& a,
+											const glm::vec3& b, const glm::vec3& c,
+											glm::vec3& weights);
 
 	// Clear all accumulated forces (start of each timestep)
-	static void ClearForces(std::vector<std::shared_ptr<Particle>>& particles);
+	static void ClearForces(ParticleStore& particles);
 
 private:
 	// Helper: compute cross product of triangle edges for normal/area
-	static glm::vec3 TriangleCrossProduct(const glm::vec3& v1,
-										  const glm::vec3& v2,
-										  const glm::vec3& v3);
+	template <typename Vec3>
+	static Vec3 TriangleCrossProduct(const Vec3& v1, const Vec3& v2, const Vec3& v3)
+	{
+		return glm::cross(v2 - v1, v3 - v1);
+	}
 };
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Scalar policies for the PhysicsEngine reductions (volume, energy).
+// Particle state is always stored as float; a policy picks the type the
+// per-element arithmetic runs in and the accumulator the elements are
+// summed into:
+//   FloatPrecision:  float math, float sum (fastest, loses digits on
+//                    large meshes as every term is rounded into the total)
+//   MixedPrecision:  float math, compensated double sum
+//   DoublePrecision: positions promoted to double, double sum (reference)
+
+// Plain running sum in T
+template <typename T>
+struct PlainSum
+{
+	T sum = T(0);
+
+	template <typename U>
+	inline void Add(U x) { sum += static_cast<T>(x); }
+	inline void Merge(const PlainSum& o) { sum += o.sum; }
+	inline double Value() const { return static_cast<double>(sum); }
+};
+
+// Neumaier (improved Kahan) summation in double: the rounding error of
+// every addition is carried in a second term and added back at the end
+struct CompensatedSum
+{
+	double sum = 0.0;
+	double compensation = 0.0;
+
+	inline void Add(double x)
+	{
+		double t = sum + x;
+		if (glm::abs(sum) >= glm::abs(x)) compensation += (sum - t) + x;
+		else                              compensation += (x - t) + sum;
+		sum = t;
+	}
+	inline void Merge(const CompensatedSum& o)
+	{
+		Add(o.sum);
+		compensation += o.compensation;
+	}
+	inline double Value() const { return sum + compensation; }
+};
+
+struct FloatPrecision
+{
+	using Scalar = float;
+	using Vec3 = glm::vec3;
+	using Accumulator = PlainSum<float>;
+};
+
+struct MixedPrecision
+{
+	using Scalar = float;
+	using Vec3 = glm::vec3;
+	using Accumulator = CompensatedSum;
+};
+
+struct DoublePrecision
+{
+	using Scalar = double;
+	using Vec3 = glm::dvec3;
+	using Accumulator = PlainSum<double>;
+};
@@ -0,0 +1,90 @@
+#include "PrecisionBenchmark.h"
+#include "PhysicsEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+template <typename Fn>
+static float BestOf(int repetitions, const Fn& fn)
+{
+	float best = std::numeric_limits<float>::max();
+	for (int r = 0; r < std::max(1, repetitions); r++)
+	{
+		auto t0 = std::chrono::high_resolution_clock::now();
+		fn();
+		auto t1 = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration<float, std::milli>(t1 - t0).count());
+	}
+	return best;
+}
+
+std::vector<PrecisionBenchmarkResult> PrecisionBenchmark::Run(const ParticleStore& particles,
+															   const SurfaceTopology& surface,
+															   size_t minFaces, int repetitions)
+{
+	std::vector<PrecisionBenchmarkResult> results;
+	size_t n = particles.Size();
+	const auto& triangles = surface.GetTriangles();
+	if (n == 0 || triangles.empty()) return results;
+
+	// Grid of copies, spaced so they do not overlap
+	const auto& positions = particles.GetPositions();
+	glm::vec3 bbMin = positions[0], bbMax = positions[0];
+	for (const glm::vec3& p : positions)
+	{
+		bbMin = glm::min(bbMin, p);
+		bbMax = glm::max(bbMax, p);
+	}
+	glm::vec3 extent = bbMax - bbMin;
+	float spacing = 1.5f * std::max(extent.x, std::max(extent.y, extent.z)) + 1e-3f;
+
+	size_t copies = std::max<size_t>(1, (minFaces + triangles.size() - 1) / triangles.size());
+	size_t side = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(copies))));
+
+	ParticleStore tiled;
+	std::vector<Triangle> tiledTriangles;
+	tiled.Reserve(copies * n);
+	tiledTriangles.reserve(copies * triangles.size());
+	for (size_t c = 0; c < copies; c++)
+	{
+		glm::vec3 offset = spacing * glm::vec3(static_cast<float>(c % side),
+											   static_cast<float>((c / side) % side),
+											   static_cast<float>(c / (side * side)));
+		unsigned int base = static_cast<unsigned int>(tiled.Size());
+		for (size_t i = 0; i < n; i++)
+		{
+			ParticleId id = tiled.Add(positions[i] + offset,
+									  particles.GetMass(static_cast<ParticleId>(i)));
+			tiled.GetVelocities()[id] = particles.GetVelocities()[i];
+		}
+		for (const Triangle& t : triangles)
+			tiledTriangles.push_back({ base + t.vertex[0], base + t.vertex[1], base + t.vertex[2] });
+	}
+
+	SurfaceTopology tiledSurface;
+	tiledSurface.Build(tiledTriangles, tiled.Size());
+
+	for (int m = 0; m < PRECISION_MODE_COUNT; m++)
+	{
+		PrecisionBenchmarkResult result;
+		result.mode = static_cast<PrecisionMode>(m);
+		result.faces = tiledTriangles.size();
+		result.volumeMs = BestOf(repetitions, [&]()
+		{
+			result.volume = PhysicsEngine::ComputeSurface(result.mode, tiled, tiledSurface);
+		});
+		float maxSpeed2 = 0.0f;
+		result.energyMs = BestOf(repetitions, [&]()
+		{
+			PhysicsEngine::ComputeKineticEnergy(result.mode, tiled, maxSpeed2);
+		});
+		results.push_back(result);
+	}
+
+	double reference = results[static_cast<int>(PrecisionMode::Double)].volume;
+	for (PrecisionBenchmarkResult& result : results)
+		result.relativeError = (reference > 0.0) ? std::fabs(result.volume - reference) / reference : 0.0;
+
+	return results;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vector>
+#include "ParticleStore.h"
+#include "SurfaceTopology.h"
+#include "SimulationParams.h"
+
+// Faces the benchmark mesh is tiled up to (the size where float volume
+// sums visibly lose digits)
+const size_t PRECISION_BENCHMARK_FACES = 1000000;
+
+struct PrecisionBenchmarkResult
+{
+	PrecisionMode mode = PrecisionMode::Float;
+	size_t faces = 0;               // faces of the tiled mesh
+	float volumeMs = 0.0f;          // best ComputeSurface pass (ms)
+	float energyMs = 0.0f;          // best ComputeKineticEnergy pass (ms)
+	double volume = 0.0;
+	double relativeError = 0.0;     // volume vs. the Double run
+};
+
+// Cost and accuracy of the PhysicsEngine reductions in every PrecisionMode.
+// The body's surface is tiled into a grid of translated copies until it has
+// at least minFaces faces, so the volume sum runs over a production-sized
+// mesh with large coordinates; each pass is timed best of `repetitions`.
+class PrecisionBenchmark
+{
+public:
+	static std::vector<PrecisionBenchmarkResult> Run(const ParticleStore& particles,
+													 const SurfaceTopology& surface,
+													 size_t minFaces = PRECISION_BENCHMARK_FACES,
+													 int repetitions = 5);
+};
@@ -0,0 +1,166 @@
+#include "ProjectiveDynamicsSolver.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+static const size_t SPRING_GRAIN = 4096;
+static const size_t PARTICLE_GRAIN = 2048;
+
+void ProjectiveDynamicsSolver::Build(size_t particleCount, const SpringTopology& springs)
+{
+	m_Factor.Analyze(particleCount, springs.GetEdges());
+
+	m_Diagonal.assign(particleCount, 0.0f);
+	m_OffDiagonal.assign(springs.Size(), 0.0f);
+	m_StartPositions.assign(particleCount, glm::vec3(0.0f));
+	m_Inertial.assign(particleCount, glm::vec3(0.0f));
+	m_Projections.assign(springs.Size(), glm::vec3(0.0f));
+	m_Rhs.assign(particleCount, glm::vec3(0.0f));
+
+	// Force a numeric factorization on the next step
+	m_FactoredStep = -1.0f;
+}
+
+void ProjectiveDynamicsSolver::UpdateFactorization(const ParticleStore& particles,
+												   const SpringTopology& springs,
+												   const SimulationParams& params, float h)
+{
+	// Compared whether or not the last attempt succeeded: a singular system
+	// stays on the explicit fallback without refactoring every step
+	if (h == m_FactoredStep &&
+		params.springConstant == m_FactoredStiffness &&
+		params.dampingConstant == m_FactoredDamping &&
+		params.particleMass == m_FactoredMass)
+		return;
+
+	const auto& inverseMasses = particles.GetInverseMasses();
+	const auto& edges = springs.GetEdges();
+	const auto& stiffness = springs.GetStiffness();
+	const auto& damping = springs.GetDamping();
+
+	for (size_t i = 0; i < m_Diagonal.size(); i++)
+		m_Diagonal[i] = inverseMasses[i] > 0.0f ? 1.0f / inverseMasses[i] : 0.0f;
+
+	for (size_t s = 0; s < edges.size(); s++)
+	{
+		float w = h * damping[s] + h * h * stiffness[s];
+		m_OffDiagonal[s] = -w;
+		m_Diagonal[edges[s].a] += w;
+		m_Diagonal[edges[s].b] += w;
+	}
+
+	// A failed attempt leaves Step on its explicit fallback; its inputs are
+	// still recorded so it is only retried once they change
+	m_Singular = !m_Factor.Factorize(m_Diagonal, m_OffDiagonal);
+	if (!m_Singular)
+		m_Factorizations++;
+
+	m_FactoredStep = h;
+	m_FactoredStiffness = params.springConstant;
+	m_FactoredDamping = params.dampingConstant;
+	m_FactoredMass = params.particleMass;
+}
+
+// Local step: closest rest-length configuration of every spring
+void ProjectiveDynamicsSolver::ProjectSprings(const ParticleStore& particles, const SpringTopology& springs)
+{
+	const auto& positions = particles.GetPositions();
+	const auto& edges = springs.GetEdges();
+	const auto& restLengths = springs.GetRestLengths();
+
+	ParallelFor(0, springs.Size(), SPRING_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t s = first; s < last; s++)
+		{
+			glm::vec3 diff = positions[edges[s].b] - positions[edges[s].a];
+			float dist = glm::length(diff);
+			m_Projections[s] = (dist > 1e-8f) ? (restLengths[s] / dist) * diff : glm::vec3(0.0f);
+		}
+	});
+}
+
+void ProjectiveDynamicsSolver::Step(ParticleStore& particles, const SpringTopology& springs,
+									const SimulationParams& params)
+{
+	size_t n = particles.Size();
+	if (m_StartPositions.size() != n || m_Projections.size() != springs.Size())
+		Build(n, springs);
+
+	float h = params.GetPhysicsStep();
+	UpdateFactorization(particles, springs, params, h);
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& forces = particles.GetForces();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	const auto& stiffness = springs.GetStiffness();
+	const auto& damping = springs.GetDamping();
+	const CsrAdjacency& adjacency = springs.GetParticleSprings();
+	const auto& edges = springs.GetEdges();
+
+	// Inertial prediction y, which is also the initial guess
+	ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			m_StartPositions[i] = positions[i];
+			positions[i] += h * velocities[i] + (h * h * inverseMasses[i]) * forces[i];
+		}
+	});
+
+	if (!m_Factor.IsFactored())
+	{
+		// Singular system (e.g. massless particle without springs): stay explicit
+		for (size_t i = 0; i < n; i++)
+			velocities[i] = (positions[i] - m_StartPositions[i]) / h;
+		return;
+	}
+
+	// M y + h C x0
+	ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			float mass = inverseMasses[i] > 0.0f ? 1.0f / inverseMasses[i] : 0.0f;
+			glm::vec3 sum = mass * positions[i];
+			for (uint32_t e = adjacency.RowBegin(i); e < adjacency.RowEnd(i); e++)
+			{
+				uint32_t s = adjacency.entries[e] >> 1;
+				ParticleId other = (adjacency.entries[e] & 1u) ? edges[s].a : edges[s].b;
+				sum += (h * damping[s]) * (m_StartPositions[i] - m_StartPositions[other]);
+			}
+			m_Inertial[i] = sum;
+		}
+	});
+
+	int iterations = std::max(1, params.pdIterations);
+	for (int it = 0; it < iterations; it++)
+	{
+		ProjectSprings(particles, springs);
+
+		// Global step rhs: + h^2 k d on endpoint b, - h^2 k d on endpoint a
+		ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				glm::vec3 sum = m_Inertial[i];
+				for (uint32_t e = adjacency.RowBegin(i); e < adjacency.RowEnd(i); e++)
+				{
+					uint32_t s = adjacency.entries[e] >> 1;
+					float sign = (adjacency.entries[e] & 1u) ? 1.0f : -1.0f;
+					sum += (sign * h * h * stiffness[s]) * m_Projections[s];
+				}
+				m_Rhs[i] = sum;
+			}
+		});
+
+		m_Factor.Solve(m_Rhs);
+		positions.swap(m_Rhs);
+	}
+
+	ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			velocities[i] = (positions[i] - m_StartPositions[i]) / h;
+	});
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "ParticleStore.h"
+#include "SpringTopology.h"
+#include "SparseCholesky.h"
+#include "SimulationParams.h"
+
+// Projective Dynamics for the spring network (Liu et al. 2013,
+// Bouaziz et al. 2014). Each spring's energy k/2 |x_b - x_a - d|^2 is
+// minimized by alternating
+//   local  - d = l0 * (x_b - x_a) / |x_b - x_a|   (parallel over springs)
+//   global - (M + h C + h^2 L) x = M y + h C x0 + h^2 J d
+// where L / C are the stiffness / damping weighted graph Laplacians and
+// y = x0 + h v0 + h^2 M^-1 f_ext. The global matrix is constant, so it is
+// factored once and every iteration is a gather plus a back-substitution.
+// Spring damping enters the matrix as an isotropic (Rayleigh) term.
+// Gravity, external and pressure forces are taken from the particle store.
+class ProjectiveDynamicsSolver
+{
+private:
+	SparseCholesky m_Factor;
+	std::vector<float> m_Diagonal;
+	std::vector<float> m_OffDiagonal;
+
+	std::vector<glm::vec3> m_StartPositions;
+	std::vector<glm::vec3> m_Inertial;       // M y + h C x0 (iteration-invariant part of the rhs)
+	std::vector<glm::vec3> m_Projections;    // d per spring
+	std::vector<glm::vec3> m_Rhs;
+
+	// Values the last factorization attempt was made for
+	float m_FactoredStep = -1.0f;
+	float m_FactoredStiffness = -1.0f;
+	float m_FactoredDamping = -1.0f;
+	float m_FactoredMass = -1.0f;
+	int m_Factorizations = 0;    // successful ones
+	bool m_Singular = false;     // the last attempt failed
+
+public:
+	ProjectiveDynamicsSolver() = default;
+
+	// Symbolic phase (ordering, elimination tree); call again whenever the
+	// spring topology changes
+	void Build(size_t particleCount, const SpringTopology& springs);
+
+	// Advances one physics step using the forces accumulated in `particles`
+	// (which must not include the spring/damping forces)
+	void Step(ParticleStore& particles, const SpringTopology& springs,
+			  const SimulationParams& params);
+
+	inline int GetFactorizationCount() const { return m_Factorizations; }
+	inline bool IsSingular() const { return m_Singular; }
+	inline size_t GetFactorNonZeros() const { return m_Factor.GetFactorNonZeros(); }
+
+private:
+	// Numeric refactorization; only runs when dt, k, c or the mass changed
+	void UpdateFactorization(const ParticleStore& particles, const SpringTopology& springs,
+							 const SimulationParams& params, float h);
+	void ProjectSprings(const ParticleStore& particles, const SpringTopology& springs);
+};
@@ -0,0 +1,131 @@
+#include "SelfCollision.h"
+#include "PhysicsEngine.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <limits>
+
+static const size_t PARTICLE_GRAIN = 2048;
+static const size_t FACE_GRAIN = 4096;
+
+void SelfCollision::Build(const ParticleStore& particles, const SpringTopology& springs)
+{
+	const auto& restLengths = springs.GetRestLengths();
+	double sum = 0.0;
+	for (float length : restLengths)
+		sum += length;
+	float mean = restLengths.empty() ? 1.0f : static_cast<float>(sum / restLengths.size());
+
+	// Two rest lengths: a face box then covers ~4 cells instead of ~10,
+	// which more than pays for the extra candidates per query
+	m_Hash.SetCellSize(std::max(2.0f * mean, 1e-4f));
+
+	m_Displacements.assign(particles.Size(), glm::vec3(0.0f));
+	m_VelocityChanges.assign(particles.Size(), glm::vec3(0.0f));
+	m_ContactCount = 0;
+}
+
+void SelfCollision::Resolve(ParticleStore& particles, const SurfaceTopology& surface, float thickness)
+{
+	size_t n = particles.Size();
+	if (m_Displacements.size() != n)
+	{
+		m_Displacements.assign(n, glm::vec3(0.0f));
+		m_VelocityChanges.assign(n, glm::vec3(0.0f));
+	}
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& triangles = surface.GetTriangles();
+
+	// A particle sits about 0.87 rest lengths from a neighbouring face it
+	// does not share (across a shared edge); capping the shell at half a
+	// rest length (the cell is two) keeps it from pushing them apart
+	thickness = std::min(thickness, 0.25f * m_Hash.GetCellSize());
+
+	m_FaceMin.resize(triangles.size());
+	m_FaceMax.resize(triangles.size());
+	ParallelFor(0, triangles.size(), FACE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t f = first; f < last; f++)
+		{
+			const Triangle& tri = triangles[f];
+			const glm::vec3& a = positions[tri.vertex[0]];
+			const glm::vec3& b = positions[tri.vertex[1]];
+			const glm::vec3& c = positions[tri.vertex[2]];
+			m_FaceMin[f] = glm::min(a, glm::min(b, c)) - thickness;
+			m_FaceMax[f] = glm::max(a, glm::max(b, c)) + thickness;
+		}
+	});
+
+	m_Hash.Build(triangles.size(), [&](size_t f, glm::vec3& bMin, glm::vec3& bMax)
+	{
+		bMin = m_FaceMin[f];
+		bMax = m_FaceMax[f];
+	});
+
+	// Contacts from the current (unmodified) positions
+	ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			const glm::vec3& p = positions[i];
+			float bestDistance = std::numeric_limits<float>::max();
+			glm::vec3 bestPoint(0.0f), bestWeights(0.0f);
+			uint32_t bestFace = UINT32_MAX;
+
+			m_Hash.Query(p, [&](uint32_t f)
+			{
+				// Most candidates only share the bucket, not the box
+				if (glm::any(glm::lessThan(p, m_FaceMin[f])) || glm::any(glm::greaterThan(p, m_FaceMax[f])))
+					return;
+
+				const Triangle& tri = triangles[f];
+				if (tri.vertex[0] == i || tri.vertex[1] == i || tri.vertex[2] == i) return;
+
+				glm::vec3 weights;
+				glm::vec3 q = PhysicsEngine::ClosestPointOnTriangle(p, positions[tri.vertex[0]],
+					positions[tri.vertex[1]], positions[tri.vertex[2]], weights);
+				float distance = glm::length(p - q);
+				if (distance < bestDistance)
+				{
+					bestDistance = distance;
+					bestPoint = q;
+					bestWeights = weights;
+					bestFace = f;
+				}
+			});
+
+			m_Displacements[i] = glm::vec3(0.0f);
+			m_VelocityChanges[i] = glm::vec3(0.0f);
+			if (bestFace == UINT32_MAX || bestDistance >= thickness || bestDistance < 1e-12f)
+				continue;
+
+			// Push straight away from the closest point, back to the thickness
+			glm::vec3 direction = (p - bestPoint) / bestDistance;
+			m_Displacements[i] = (thickness - bestDistance) * direction;
+
+			const Triangle& tri = triangles[bestFace];
+			glm::vec3 faceVelocity = bestWeights.x * velocities[tri.vertex[0]] +
+									 bestWeights.y * velocities[tri.vertex[1]] +
+									 bestWeights.z * velocities[tri.vertex[2]];
+			float approach = glm::dot(velocities[i] - faceVelocity, direction);
+			if (approach < 0.0f)
+				m_VelocityChanges[i] = -approach * direction;
+		}
+	});
+
+	m_ContactCount = ParallelReduce(0, n, PARTICLE_GRAIN, size_t(0),
+		[&](size_t first, size_t last)
+		{
+			size_t contacts = 0;
+			for (size_t i = first; i < last; i++)
+			{
+				if (m_Displacements[i] == glm::vec3(0.0f)) continue;
+				positions[i] += m_Displacements[i];
+				velocities[i] += m_VelocityChanges[i];
+				contacts++;
+			}
+			return contacts;
+		},
+		[](size_t a, size_t b) { return a + b; });
+}
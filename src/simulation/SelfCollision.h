@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "ParticleStore.h"
+#include "SpringTopology.h"
+#include "SurfaceTopology.h"
+#include "SpatialHash.h"
+
+// Particle vs triangle contacts within one body, so a folding surface
+// cannot pass through itself. Each step the surface triangles (boxes grown
+// by the thickness) are hashed into a SpatialHash with cells two mean
+// spring rest lengths wide; every particle then looks up the single cell
+// it sits in, box-tests the faces found there and is projected to
+// `thickness` away from the nearest one it does not belong to, losing its
+// approaching relative velocity. Particles only write themselves, so the
+// whole pass is linear and parallel.
+class SelfCollision
+{
+private:
+	SpatialHash m_Hash;
+	std::vector<glm::vec3> m_FaceMin;     // face boxes grown by the thickness
+	std::vector<glm::vec3> m_FaceMax;
+	std::vector<glm::vec3> m_Displacements;
+	std::vector<glm::vec3> m_VelocityChanges;
+	size_t m_ContactCount = 0;
+
+public:
+	SelfCollision() = default;
+
+	// Cell size from the mean rest length; call again when the topology changes
+	void Build(const ParticleStore& particles, const SpringTopology& springs);
+
+	// thickness is capped at half the cell size
+	void Resolve(ParticleStore& particles, const SurfaceTopology& surface, float thickness);
+
+	inline size_t GetContactCount() const { return m_ContactCount; }
+};
@@ -0,0 +1,151 @@
+#include "ShapeMatchingKernels.h"
+#include "SpringKernels.h"
+#include "SimdSupport.h"
+#include <cmath>
+
+// Keeps ω finite when the cluster has collapsed (A = 0)
+static const float ROTATION_EPSILON = 1e-9f;
+
+void ShapeMatchingKernels::ExtractRotationsScalar(ClusterMoments& clusters, size_t first, size_t last,
+												  int iterations)
+{
+	for (size_t c = first; c < last; c++)
+	{
+		float a[9];
+		for (int k = 0; k < 9; k++)
+			a[k] = clusters.a[k][c];
+		float x = clusters.q[0][c], y = clusters.q[1][c], z = clusters.q[2][c], w = clusters.q[3][c];
+
+		for (int it = 0; it < iterations; it++)
+		{
+			// Columns of R(q)
+			float r[9] = {
+				1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y),
+				2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x),
+				2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y) };
+
+			float ox = 0.0f, oy = 0.0f, oz = 0.0f, dot = 0.0f;
+			for (int col = 0; col < 3; col++)
+			{
+				const float* rc = r + 3 * col;
+				const float* ac = a + 3 * col;
+				ox += rc[1] * ac[2] - rc[2] * ac[1];
+				oy += rc[2] * ac[0] - rc[0] * ac[2];
+				oz += rc[0] * ac[1] - rc[1] * ac[0];
+				dot += rc[0] * ac[0] + rc[1] * ac[1] + rc[2] * ac[2];
+			}
+
+			// Half-angle vector; q <- normalize((1, ω/2) q)
+			float scale = 0.5f / (std::fabs(dot) + ROTATION_EPSILON);
+			ox *= scale; oy *= scale; oz *= scale;
+
+			float nw = w - (ox * x + oy * y + oz * z);
+			float nx = x + ox * w + (oy * z - oz * y);
+			float ny = y + oy * w + (oz * x - ox * z);
+			float nz = z + oz * w + (ox * y - oy * x);
+			float inverse = 1.0f / std::sqrt(nx * nx + ny * ny + nz * nz + nw * nw);
+			x = nx * inverse; y = ny * inverse; z = nz * inverse; w = nw * inverse;
+		}
+
+		clusters.q[0][c] = x; clusters.q[1][c] = y; clusters.q[2][c] = z; clusters.q[3][c] = w;
+	}
+}
+
+#if SOFTBODY_X86
+
+SOFTBODY_TARGET("avx2")
+static void ExtractRotationsAVX2(ClusterMoments& clusters, size_t first, size_t last, int iterations)
+{
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 two = _mm256_set1_ps(2.0f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 epsilon = _mm256_set1_ps(ROTATION_EPSILON);
+	const __m256 signBit = _mm256_set1_ps(-0.0f);
+
+	size_t c = first;
+	for (; c + 8 <= last; c += 8)
+	{
+		__m256 a[9];
+		for (int k = 0; k < 9; k++)
+			a[k] = _mm256_loadu_ps(clusters.a[k].data() + c);
+		__m256 x = _mm256_loadu_ps(clusters.q[0].data() + c);
+		__m256 y = _mm256_loadu_ps(clusters.q[1].data() + c);
+		__m256 z = _mm256_loadu_ps(clusters.q[2].data() + c);
+		__m256 w = _mm256_loadu_ps(clusters.q[3].data() + c);
+
+		for (int it = 0; it < iterations; it++)
+		{
+			__m256 xx = _mm256_mul_ps(x, x), yy = _mm256_mul_ps(y, y), zz = _mm256_mul_ps(z, z);
+			__m256 xy = _mm256_mul_ps(x, y), xz = _mm256_mul_ps(x, z), yz = _mm256_mul_ps(y, z);
+			__m256 wx = _mm256_mul_ps(w, x), wy = _mm256_mul_ps(w, y), wz = _mm256_mul_ps(w, z);
+
+			__m256 r[9] = {
+				_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(yy, zz))),
+				_mm256_mul_ps(two, _mm256_add_ps(xy, wz)),
+				_mm256_mul_ps(two, _mm256_sub_ps(xz, wy)),
+				_mm256_mul_ps(two, _mm256_sub_ps(xy, wz)),
+				_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, zz))),
+				_mm256_mul_ps(two, _mm256_add_ps(yz, wx)),
+				_mm256_mul_ps(two, _mm256_add_ps(xz, wy)),
+				_mm256_mul_ps(two, _mm256_sub_ps(yz, wx)),
+				_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(xx, yy))) };
+
+			__m256 ox = _mm256_setzero_ps(), oy = _mm256_setzero_ps(), oz = _mm256_setzero_ps();
+			__m256 dot = _mm256_setzero_ps();
+			for (int col = 0; col < 3; col++)
+			{
+				const __m256* rc = r + 3 * col;
+				const __m256* ac = a + 3 * col;
+				ox = _mm256_add_ps(ox, _mm256_sub_ps(_mm256_mul_ps(rc[1], ac[2]), _mm256_mul_ps(rc[2], ac[1])));
+				oy = _mm256_add_ps(oy, _mm256_sub_ps(_mm256_mul_ps(rc[2], ac[0]), _mm256_mul_ps(rc[0], ac[2])));
+				oz = _mm256_add_ps(oz, _mm256_sub_ps(_mm256_mul_ps(rc[0], ac[1]), _mm256_mul_ps(rc[1], ac[0])));
+				dot = _mm256_add_ps(dot, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(rc[0], ac[0]),
+																	 _mm256_mul_ps(rc[1], ac[1])),
+													   _mm256_mul_ps(rc[2], ac[2])));
+			}
+
+			__m256 scale = _mm256_div_ps(half, _mm256_add_ps(_mm256_andnot_ps(signBit, dot), epsilon));
+			ox = _mm256_mul_ps(ox, scale);
+			oy = _mm256_mul_ps(oy, scale);
+			oz = _mm256_mul_ps(oz, scale);
+
+			__m256 nw = _mm256_sub_ps(w, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(ox, x), _mm256_mul_ps(oy, y)),
+													   _mm256_mul_ps(oz, z)));
+			__m256 nx = _mm256_add_ps(_mm256_add_ps(x, _mm256_mul_ps(ox, w)),
+									  _mm256_sub_ps(_mm256_mul_ps(oy, z), _mm256_mul_ps(oz, y)));
+			__m256 ny = _mm256_add_ps(_mm256_add_ps(y, _mm256_mul_ps(oy, w)),
+									  _mm256_sub_ps(_mm256_mul_ps(oz, x), _mm256_mul_ps(ox, z)));
+			__m256 nz = _mm256_add_ps(_mm256_add_ps(z, _mm256_mul_ps(oz, w)),
+									  _mm256_sub_ps(_mm256_mul_ps(ox, y), _mm256_mul_ps(oy, x)));
+			__m256 norm2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(nx, nx), _mm256_mul_ps(ny, ny)),
+										 _mm256_add_ps(_mm256_mul_ps(nz, nz), _mm256_mul_ps(nw, nw)));
+			__m256 inverse = _mm256_div_ps(one, _mm256_sqrt_ps(norm2));
+			x = _mm256_mul_ps(nx, inverse);
+			y = _mm256_mul_ps(ny, inverse);
+			z = _mm256_mul_ps(nz, inverse);
+			w = _mm256_mul_ps(nw, inverse);
+		}
+
+		_mm256_storeu_ps(clusters.q[0].data() + c, x);
+		_mm256_storeu_ps(clusters.q[1].data() + c, y);
+		_mm256_storeu_ps(clusters.q[2].data() + c, z);
+		_mm256_storeu_ps(clusters.q[3].data() + c, w);
+	}
+
+	ShapeMatchingKernels::ExtractRotationsScalar(clusters, c, last, iterations);
+}
+
+#endif // SOFTBODY_X86
+
+void ShapeMatchingKernels::ExtractRotations(ClusterMoments& clusters, size_t first, size_t last, int iterations)
+{
+#if SOFTBODY_X86
+	SimdLevel level = SpringKernels::GetActiveLevel();
+	if (level == SimdLevel::AVX2 || level == SimdLevel::AVX512)
+	{
+		ExtractRotationsAVX2(clusters, first, last, iterations);
+		return;
+	}
+#endif
+	ExtractRotationsScalar(clusters, first, last, iterations);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Per-cluster shape matching state in structure-of-arrays form, so the
+// kernels can load eight clusters with one instruction. a[3 * col + row]
+// holds the moment matrix A_pq = Σ m p qᵀ (p: current, q: rest offsets
+// from the cluster's center of mass); q[0..3] = (x, y, z, w) is the
+// cluster's rotation, which the kernels refine in place.
+struct ClusterMoments
+{
+	std::vector<float> a[9];
+	std::vector<float> q[4];
+
+	inline size_t Size() const { return q[3].size(); }
+
+	// New clusters start at the identity rotation
+	void Resize(size_t count)
+	{
+		for (auto& column : a)
+			column.resize(count, 0.0f);
+		for (int k = 0; k < 3; k++)
+			q[k].resize(count, 0.0f);
+		q[3].resize(count, 1.0f);
+	}
+
+	// Rotation matrix of cluster c's quaternion
+	glm::mat3 GetRotation(size_t c) const
+	{
+		float x = q[0][c], y = q[1][c], z = q[2][c], w = q[3][c];
+		return glm::mat3(
+			1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + w * z), 2.0f * (x * z - w * y),
+			2.0f * (x * y - w * z), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + w * x),
+			2.0f * (x * z + w * y), 2.0f * (y * z - w * x), 1.0f - 2.0f * (x * x + y * y));
+	}
+};
+
+// Rotational part of A_pq for clusters [first, last) by the iterative
+// extraction of Müller et al. 2016 ("A Robust Method to Extract the
+// Rotational Part of Deformations"): each iteration turns R by
+// ω = Σ r_i × a_i / |Σ r_i · a_i| and renormalizes the quaternion, so
+// there is no eigen-decomposition, no sin/cos and no branch. Warm started
+// from the previous step's rotation, a few iterations per step track the
+// polar rotation, and a degenerate (planar or collinear) cluster keeps its
+// last rotation instead of flipping. The AVX2 path runs 8 clusters per
+// iteration (AVX-512 CPUs use it too); other CPUs, and the remainder,
+// take the scalar path.
+class ShapeMatchingKernels
+{
+public:
+	static void ExtractRotations(ClusterMoments& clusters, size_t first, size_t last, int iterations);
+
+	static void ExtractRotationsScalar(ClusterMoments& clusters, size_t first, size_t last, int iterations);
+};
@@ -0,0 +1,299 @@
+#include "ShapeMatchingSolver.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const size_t PARTICLE_GRAIN = 2048;
+static const size_t CLUSTER_GRAIN = 64;
+
+// Fewer members cannot fix a rotation (A_pq has rank < 3 for < 4 points)
+static const uint32_t SHAPE_MIN_CLUSTER_SIZE = 4;
+
+// Warm-started rotation extraction iterations per step
+static const int ROTATION_ITERATIONS = 3;
+
+// A particle's mass is split evenly over its clusters, so every cluster's
+// pull sums to zero momentum and so does the mean over the clusters.
+// Pinned particles (zero inverse mass) weigh like unit masses.
+inline float ShapeMatchingSolver::GetEntryMass(const std::vector<float>& inverseMasses, uint32_t i) const
+{
+	float mass = inverseMasses[i] > 0.0f ? 1.0f / inverseMasses[i] : 1.0f;
+	return mass / static_cast<float>(m_ParticleEntries.RowEnd(i) - m_ParticleEntries.RowBegin(i));
+}
+
+void ShapeMatchingSolver::Build(const ParticleStore& particles, const std::vector<glm::vec3>& restPositions,
+								int resolution, float overlap)
+{
+	size_t n = restPositions.size();
+	resolution = std::max(1, resolution);
+	overlap = std::max(0.0f, overlap);
+	m_BuiltResolution = resolution;
+	m_BuiltOverlap = overlap;
+
+	glm::vec3 lo(0.0f), hi(0.0f);
+	if (n > 0)
+	{
+		lo = hi = restPositions[0];
+		for (const auto& p : restPositions)
+		{
+			lo = glm::min(lo, p);
+			hi = glm::max(hi, p);
+		}
+	}
+	glm::vec3 cell = glm::max(hi - lo, glm::vec3(1e-6f)) / static_cast<float>(resolution);
+	glm::vec3 reach = 0.5f * cell * (1.0f + overlap);
+
+	auto cellCenter = [&](int cx, int cy, int cz)
+	{
+		return lo + (glm::vec3(cx, cy, cz) + 0.5f) * cell;
+	};
+
+	// Every grown cell containing the particle
+	std::vector<uint32_t> cellRows, cellValues;
+	std::vector<uint32_t> cellCounts(static_cast<size_t>(resolution) * resolution * resolution, 0);
+	for (size_t i = 0; i < n; i++)
+	{
+		glm::vec3 local = (restPositions[i] - lo) / cell - 0.5f;
+		glm::vec3 spread = reach / cell;
+		glm::ivec3 first = glm::clamp(glm::ivec3(glm::ceil(local - spread)), glm::ivec3(0), glm::ivec3(resolution - 1));
+		glm::ivec3 last = glm::clamp(glm::ivec3(glm::floor(local + spread)), glm::ivec3(0), glm::ivec3(resolution - 1));
+		for (int cz = first.z; cz <= last.z; cz++)
+			for (int cy = first.y; cy <= last.y; cy++)
+				for (int cx = first.x; cx <= last.x; cx++)
+				{
+					uint32_t index = static_cast<uint32_t>((cz * resolution + cy) * resolution + cx);
+					cellRows.push_back(index);
+					cellValues.push_back(static_cast<uint32_t>(i));
+					cellCounts[index]++;
+				}
+	}
+
+	// Keep the populated cells, numbered in grid order
+	const uint32_t dropped = ~0u;
+	std::vector<uint32_t> clusterOf(cellCounts.size(), dropped);
+	std::vector<glm::vec3> keptCenters;
+	for (size_t index = 0; index < cellCounts.size(); index++)
+	{
+		if (cellCounts[index] < SHAPE_MIN_CLUSTER_SIZE) continue;
+		clusterOf[index] = static_cast<uint32_t>(keptCenters.size());
+		int cx = static_cast<int>(index % resolution);
+		int cy = static_cast<int>((index / resolution) % resolution);
+		int cz = static_cast<int>(index / (static_cast<size_t>(resolution) * resolution));
+		keptCenters.push_back(cellCenter(cx, cy, cz));
+	}
+
+	std::vector<uint32_t> rows, values;
+	std::vector<bool> covered(n, false);
+	if (keptCenters.empty())
+	{
+		// Too few particles for the grid: one cluster holds the whole body
+		keptCenters.push_back(0.5f * (lo + hi));
+		for (size_t i = 0; i < n; i++)
+		{
+			rows.push_back(0);
+			values.push_back(static_cast<uint32_t>(i));
+		}
+	}
+	else
+	{
+		for (size_t k = 0; k < cellRows.size(); k++)
+		{
+			uint32_t cluster = clusterOf[cellRows[k]];
+			if (cluster == dropped) continue;
+			rows.push_back(cluster);
+			values.push_back(cellValues[k]);
+			covered[cellValues[k]] = true;
+		}
+		for (size_t i = 0; i < n; i++)
+		{
+			if (covered[i]) continue;
+			uint32_t nearest = 0;
+			float best = std::numeric_limits<float>::max();
+			for (size_t c = 0; c < keptCenters.size(); c++)
+			{
+				glm::vec3 d = restPositions[i] - keptCenters[c];
+				float distance2 = glm::dot(d, d);
+				if (distance2 < best)
+				{
+					best = distance2;
+					nearest = static_cast<uint32_t>(c);
+				}
+			}
+			rows.push_back(nearest);
+			values.push_back(static_cast<uint32_t>(i));
+		}
+	}
+
+	size_t clusterCount = keptCenters.size();
+	m_ClusterMembers.Build(clusterCount, rows, values);
+
+	std::vector<uint32_t> entryIndices(m_ClusterMembers.entries.size());
+	for (size_t k = 0; k < entryIndices.size(); k++)
+		entryIndices[k] = static_cast<uint32_t>(k);
+	m_ParticleEntries.Build(n, m_ClusterMembers.entries, entryIndices);
+
+	// Rest offsets from each cluster's rest center of mass. Summed in
+	// double: any bias left in Σ m q is a constant force on the body.
+	m_RestOffsets.resize(m_ClusterMembers.entries.size());
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		glm::dvec3 sum(0.0);
+		double mass = 0.0;
+		for (uint32_t k = m_ClusterMembers.RowBegin(c); k < m_ClusterMembers.RowEnd(c); k++)
+		{
+			uint32_t i = m_ClusterMembers.entries[k];
+			double m = GetEntryMass(particles.GetInverseMasses(), i);
+			sum += m * glm::dvec3(restPositions[i]);
+			mass += m;
+		}
+		glm::vec3 center(sum / mass);
+		for (uint32_t k = m_ClusterMembers.RowBegin(c); k < m_ClusterMembers.RowEnd(c); k++)
+			m_RestOffsets[k] = restPositions[m_ClusterMembers.entries[k]] - center;
+	}
+
+	m_Goals.resize(m_RestOffsets.size());
+	m_Centers.resize(clusterCount);
+	m_Predicted.resize(n);
+	m_Moments = ClusterMoments();
+	m_Moments.Resize(clusterCount);
+}
+
+bool ShapeMatchingSolver::NeedsBuild(size_t particleCount, const SimulationParams& params) const
+{
+	return m_ParticleEntries.GetRowCount() != particleCount ||
+		   m_BuiltResolution != std::max(1, params.shapeClusters) ||
+		   m_BuiltOverlap != std::max(0.0f, params.shapeOverlap);
+}
+
+void ShapeMatchingSolver::ResetRotations()
+{
+	m_Moments = ClusterMoments();
+	m_Moments.Resize(GetClusterCount());
+}
+
+void ShapeMatchingSolver::Step(ParticleStore& particles, const SimulationParams& params,
+							   const ColliderBox& collider, float dt)
+{
+	size_t n = particles.Size();
+	if (n == 0 || m_Predicted.size() != n) return;
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	glm::vec3 gravity(0.0f, params.gravityStrength, 0.0f);
+
+	// Predict with gravity and external forces
+	ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			glm::vec3 v = velocities[i];
+			if (inverseMasses[i] > 0.0f)
+				v += dt * (gravity + params.externalForce * inverseMasses[i]);
+			m_Predicted[i] = positions[i] + dt * v;
+			if (collider.enabled) collider.ProjectPosition(m_Predicted[i]);
+		}
+	});
+
+	// Each iteration fits the goals to predictions already outside the
+	// collider, pulls towards the mean goal and projects again, so resting
+	// contacts carry the body's weight into every cluster
+	float alpha = glm::clamp(params.shapeStiffness, 0.0f, 1.0f);
+	int iterations = std::max(1, params.shapeIterations);
+	for (int it = 0; it < iterations; it++)
+	{
+		ComputeMoments(particles);
+		ParallelFor(0, GetClusterCount(), CLUSTER_GRAIN, [&](size_t first, size_t last)
+		{
+			ShapeMatchingKernels::ExtractRotations(m_Moments, first, last, ROTATION_ITERATIONS);
+		});
+		ComputeGoals();
+
+		ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				if (inverseMasses[i] <= 0.0f) continue;
+
+				uint32_t begin = m_ParticleEntries.RowBegin(i);
+				uint32_t end = m_ParticleEntries.RowEnd(i);
+				glm::vec3 goal(0.0f);
+				for (uint32_t k = begin; k < end; k++)
+					goal += m_Goals[m_ParticleEntries.entries[k]];
+				goal /= static_cast<float>(end - begin);
+
+				m_Predicted[i] += alpha * (goal - m_Predicted[i]);
+				if (collider.enabled) collider.ProjectPosition(m_Predicted[i]);
+			}
+		});
+	}
+
+	// Velocities from the position change, restitution for contacts
+	float inverseDt = 1.0f / dt;
+	ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			velocities[i] = (m_Predicted[i] - positions[i]) * inverseDt;
+			positions[i] = m_Predicted[i];
+			if (collider.enabled) collider.ResolveCollision(positions[i], velocities[i]);
+		}
+	});
+}
+
+void ShapeMatchingSolver::ComputeMoments(const ParticleStore& particles)
+{
+	const auto& inverseMasses = particles.GetInverseMasses();
+	ParallelFor(0, GetClusterCount(), CLUSTER_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t c = first; c < last; c++)
+		{
+			uint32_t begin = m_ClusterMembers.RowBegin(c);
+			uint32_t end = m_ClusterMembers.RowEnd(c);
+
+			// Summed relative to the first member, so the rounding scales
+			// with the cluster's size rather than its distance from the origin
+			glm::vec3 origin = m_Predicted[m_ClusterMembers.entries[begin]];
+			glm::vec3 sum(0.0f);
+			float mass = 0.0f;
+			for (uint32_t k = begin; k < end; k++)
+			{
+				uint32_t i = m_ClusterMembers.entries[k];
+				float m = GetEntryMass(inverseMasses, i);
+				sum += m * (m_Predicted[i] - origin);
+				mass += m;
+			}
+			glm::vec3 center = origin + sum / mass;
+			m_Centers[c] = center;
+
+			glm::mat3 a(0.0f);
+			for (uint32_t k = begin; k < end; k++)
+			{
+				uint32_t i = m_ClusterMembers.entries[k];
+				float m = GetEntryMass(inverseMasses, i);
+				glm::vec3 p = m * (m_Predicted[i] - center);
+				const glm::vec3& q = m_RestOffsets[k];
+				a[0] += p * q.x;
+				a[1] += p * q.y;
+				a[2] += p * q.z;
+			}
+			for (int col = 0; col < 3; col++)
+				for (int row = 0; row < 3; row++)
+					m_Moments.a[3 * col + row][c] = a[col][row];
+		}
+	});
+}
+
+void ShapeMatchingSolver::ComputeGoals()
+{
+	ParallelFor(0, GetClusterCount(), CLUSTER_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t c = first; c < last; c++)
+		{
+			glm::mat3 r = m_Moments.GetRotation(c);
+			for (uint32_t k = m_ClusterMembers.RowBegin(c); k < m_ClusterMembers.RowEnd(c); k++)
+				m_Goals[k] = m_Centers[c] + r * m_RestOffsets[k];
+		}
+	});
+}
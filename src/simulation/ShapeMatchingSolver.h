@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "ParticleStore.h"
+#include "CsrAdjacency.h"
+#include "ShapeMatchingKernels.h"
+#include "SimulationParams.h"
+#include "ColliderBox.h"
+
+// Meshless shape matching (Müller et al. 2005) over overlapping clusters.
+// The rest shape is cut into a grid of clusters whose cells are grown by
+// the overlap fraction, so neighbouring clusters share particles. Per
+// pass, for every cluster
+//   c = Σ m x / Σ m,  A_pq = Σ m (x - c) qᵀ,  R = rotation of A_pq,
+// every member gets the goal g = c + R q, and each particle moves
+// alpha * (g - x) towards the mean of its clusters' goals. There are no
+// springs or pressure, the cost is linear in particles plus cluster
+// memberships, and with alpha <= 1 a pass cannot overshoot its goals, so
+// the step is stable at any dt. Gravity and external forces are explicit;
+// more passes per step carry contact forces further through the clusters.
+class ShapeMatchingSolver
+{
+private:
+	CsrAdjacency m_ClusterMembers;          // cluster -> member particles
+	CsrAdjacency m_ParticleEntries;         // particle -> its entries in m_ClusterMembers
+	std::vector<glm::vec3> m_RestOffsets;   // per entry: rest position - rest center of mass
+	std::vector<glm::vec3> m_Goals;         // per entry
+	std::vector<glm::vec3> m_Centers;       // per cluster
+	std::vector<glm::vec3> m_Predicted;     // per particle
+	ClusterMoments m_Moments;
+
+	// Values the clusters were built for
+	int m_BuiltResolution = -1;
+	float m_BuiltOverlap = -1.0f;
+
+public:
+	ShapeMatchingSolver() = default;
+
+	// Clusters the rest shape on a resolution^3 grid over its bounds;
+	// cells with fewer than SHAPE_MIN_CLUSTER_SIZE members are dropped and
+	// their particles join the nearest remaining cluster
+	void Build(const ParticleStore& particles, const std::vector<glm::vec3>& restPositions,
+			   int resolution, float overlap);
+	bool NeedsBuild(size_t particleCount, const SimulationParams& params) const;
+
+	// Advances one physics step of `dt`, including the collider response
+	void Step(ParticleStore& particles, const SimulationParams& params,
+			  const ColliderBox& collider, float dt);
+
+	// Rotations back to identity (the particles are back at rest)
+	void ResetRotations();
+
+	inline size_t GetClusterCount() const { return m_ClusterMembers.GetRowCount(); }
+	inline size_t GetMembershipCount() const { return m_ClusterMembers.entries.size(); }
+
+private:
+	float GetEntryMass(const std::vector<float>& inverseMasses, uint32_t i) const;
+	void ComputeMoments(const ParticleStore& particles);
+	void ComputeGoals();
+};
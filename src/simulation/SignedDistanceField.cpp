@@ -0,0 +1,381 @@
+#include "SignedDistanceField.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+static const size_t POINT_GRAIN = 1024;
+static const size_t PARTICLE_GRAIN = 2048;
+static const uint32_t SDF_CACHE_VERSION = 2;
+static const char SDF_CACHE_MAGIC[4] = { 'S', 'D', 'F', 'B' };
+
+void SignedDistanceField::Bake(const MeshCollider& mesh, int resolution)
+{
+	m_Distances.clear();
+	m_Size = glm::ivec3(0);
+	if (mesh.IsEmpty()) return;
+
+	const auto& positions = mesh.GetPositions();
+	const auto& triangles = mesh.GetTriangles();
+	const TriangleBvh& bvh = mesh.GetBvh();
+
+	glm::vec3 lo = bvh.GetMin();
+	glm::vec3 hi = bvh.GetMax();
+	glm::vec3 extent = hi - lo;
+	resolution = std::max(resolution, 4);
+	m_CellSize = std::max(std::max(extent.x, std::max(extent.y, extent.z)) / resolution, 1e-4f);
+	m_Band = SDF_BAND_CELLS * m_CellSize;
+
+	// The band must fit around the mesh, and the flood fill needs an empty border
+	glm::vec3 padding(m_Band + m_CellSize);
+	m_Origin = lo - padding;
+	m_Size = glm::ivec3(glm::ceil((extent + 2.0f * padding) / m_CellSize)) + 1;
+	size_t count = static_cast<size_t>(m_Size.x) * m_Size.y * m_Size.z;
+	m_Distances.assign(count, m_Band);
+
+	// Unsigned distance in the band; points within half a cell diagonal
+	// of the surface are the barrier of the flood fill
+	const float surfaceDistance = 0.5f * std::sqrt(3.0f) * m_CellSize;
+	std::vector<uint8_t> state(count, 0);   // 0 empty, 1 surface (signed), 2 surface (negative), 3 outside
+	ParallelFor(0, count, POINT_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			int x = static_cast<int>(i % m_Size.x);
+			int y = static_cast<int>((i / m_Size.x) % m_Size.y);
+			int z = static_cast<int>(i / (static_cast<size_t>(m_Size.x) * m_Size.y));
+			glm::vec3 p = m_Origin + glm::vec3(x, y, z) * m_CellSize;
+
+			BvhHit hit;
+			if (!bvh.FindClosest(p, m_Band, triangles, positions, hit)) continue;
+			m_Distances[i] = hit.distance;
+			if (hit.distance >= surfaceDistance) continue;
+
+			const Triangle& tri = triangles[hit.triangle];
+			const glm::vec3& a = positions[tri.vertex[0]];
+			glm::vec3 normal = glm::cross(positions[tri.vertex[1]] - a, positions[tri.vertex[2]] - a);
+			state[i] = glm::dot(p - hit.point, normal) < 0.0f ? 2 : 1;
+		}
+	});
+
+	// Flood fill the empty points from the border (6-connected)
+	std::vector<size_t> stack;
+	auto visit = [&](int x, int y, int z)
+	{
+		size_t i = Index(x, y, z);
+		if (state[i] != 0) return;
+		state[i] = 3;
+		stack.push_back(i);
+	};
+	for (int z = 0; z < m_Size.z; z++)
+		for (int y = 0; y < m_Size.y; y++)
+			for (int x = 0; x < m_Size.x; x++)
+				if (x == 0 || y == 0 || z == 0 || x == m_Size.x - 1 || y == m_Size.y - 1 || z == m_Size.z - 1)
+					visit(x, y, z);
+	while (!stack.empty())
+	{
+		size_t i = stack.back();
+		stack.pop_back();
+		int x = static_cast<int>(i % m_Size.x);
+		int y = static_cast<int>((i / m_Size.x) % m_Size.y);
+		int z = static_cast<int>(i / (static_cast<size_t>(m_Size.x) * m_Size.y));
+		if (x > 0) visit(x - 1, y, z);
+		if (x < m_Size.x - 1) visit(x + 1, y, z);
+		if (y > 0) visit(x, y - 1, z);
+		if (y < m_Size.y - 1) visit(x, y + 1, z);
+		if (z > 0) visit(x, y, z - 1);
+		if (z < m_Size.z - 1) visit(x, y, z + 1);
+	}
+
+	// Empty points the fill did not reach are inside. They get their full
+	// distance, so a particle that tunnelled past the band is still pushed
+	// out along a useful gradient
+	ParallelFor(0, count, POINT_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			if (state[i] == 0 && m_Distances[i] >= m_Band)
+			{
+				int x = static_cast<int>(i % m_Size.x);
+				int y = static_cast<int>((i / m_Size.x) % m_Size.y);
+				int z = static_cast<int>(i / (static_cast<size_t>(m_Size.x) * m_Size.y));
+				BvhHit hit;
+				if (bvh.FindClosest(m_Origin + glm::vec3(x, y, z) * m_CellSize, std::numeric_limits<float>::max(),
+									triangles, positions, hit))
+					m_Distances[i] = hit.distance;
+			}
+			if (state[i] == 0 || state[i] == 2)
+				m_Distances[i] = -m_Distances[i];
+		}
+	});
+}
+
+uint64_t SignedDistanceField::HashMesh(const MeshCollider& mesh, int resolution)
+{
+	// FNV-1a over the geometry and everything that changes the bake
+	uint64_t hash = 14695981039346656037ull;
+	auto mix = [&hash](const void* data, size_t size)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	};
+
+	const auto& positions = mesh.GetPositions();
+	const auto& triangles = mesh.GetTriangles();
+	uint32_t version = SDF_CACHE_VERSION;
+	float band = SDF_BAND_CELLS;
+	mix(&version, sizeof(version));
+	mix(&resolution, sizeof(resolution));
+	mix(&band, sizeof(band));
+	if (!positions.empty()) mix(positions.data(), positions.size() * sizeof(glm::vec3));
+	if (!triangles.empty()) mix(triangles.data(), triangles.size() * sizeof(Triangle));
+	return hash;
+}
+
+bool SignedDistanceField::BakeCached(const MeshCollider& mesh, int resolution, const std::string& cacheDirectory)
+{
+	uint64_t hash = HashMesh(mesh, resolution);
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.sdf", static_cast<unsigned long long>(hash));
+	std::string path = cacheDirectory + "/" + name;
+
+	if (Load(path, hash)) return true;
+
+	Bake(mesh, resolution);
+
+	std::error_code error;
+	std::filesystem::create_directories(cacheDirectory, error);
+	if (error || !Save(path, hash))
+		std::cout << "WARNING::SDF::Could not write cache file " << path << std::endl;
+	return false;
+}
+
+bool SignedDistanceField::Load(const std::string& path, uint64_t hash)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return false;
+
+	char magic[4];
+	uint64_t storedHash = 0;
+	glm::ivec3 size;
+	glm::vec3 origin;
+	float cellSize = 0.0f, band = 0.0f;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&storedHash), sizeof(storedHash));
+	file.read(reinterpret_cast<char*>(&size), sizeof(size));
+	file.read(reinterpret_cast<char*>(&origin), sizeof(origin));
+	file.read(reinterpret_cast<char*>(&cellSize), sizeof(cellSize));
+	file.read(reinterpret_cast<char*>(&band), sizeof(band));
+	if (!file || std::memcmp(magic, SDF_CACHE_MAGIC, sizeof(magic)) != 0 || storedHash != hash ||
+		glm::any(glm::lessThan(size, glm::ivec3(2))))
+		return false;
+
+	std::vector<float> distances(static_cast<size_t>(size.x) * size.y * size.z);
+	file.read(reinterpret_cast<char*>(distances.data()), distances.size() * sizeof(float));
+	if (!file) return false;
+
+	m_Size = size;
+	m_Origin = origin;
+	m_CellSize = cellSize;
+	m_Band = band;
+	m_Distances = std::move(distances);
+	return true;
+}
+
+bool SignedDistanceField::Save(const std::string& path, uint64_t hash) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file) return false;
+
+	file.write(SDF_CACHE_MAGIC, sizeof(SDF_CACHE_MAGIC));
+	file.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+	file.write(reinterpret_cast<const char*>(&m_Size), sizeof(m_Size));
+	file.write(reinterpret_cast<const char*>(&m_Origin), sizeof(m_Origin));
+	file.write(reinterpret_cast<const char*>(&m_CellSize), sizeof(m_CellSize));
+	file.write(reinterpret_cast<const char*>(&m_Band), sizeof(m_Band));
+	file.write(reinterpret_cast<const char*>(m_Distances.data()), m_Distances.size() * sizeof(float));
+	return static_cast<bool>(file);
+}
+
+bool SignedDistanceField::Sample(const glm::vec3& p, float& distance, glm::vec3& gradient) const
+{
+	if (m_Distances.empty()) return false;
+
+	glm::vec3 g = (p - m_Origin) / m_CellSize;
+	glm::vec3 upper = glm::vec3(m_Size - 1);
+	if (glm::any(glm::lessThan(g, glm::vec3(0.0f))) || glm::any(glm::greaterThan(g, upper)))
+		return false;
+
+	glm::ivec3 c = glm::min(glm::ivec3(g), m_Size - 2);
+	glm::vec3 f = g - glm::vec3(c);
+
+	float d000 = m_Distances[Index(c.x, c.y, c.z)];
+	float d100 = m_Distances[Index(c.x + 1, c.y, c.z)];
+	float d010 = m_Distances[Index(c.x, c.y + 1, c.z)];
+	float d110 = m_Distances[Index(c.x + 1, c.y + 1, c.z)];
+	float d001 = m_Distances[Index(c.x, c.y, c.z + 1)];
+	float d101 = m_Distances[Index(c.x + 1, c.y, c.z + 1)];
+	float d011 = m_Distances[Index(c.x, c.y + 1, c.z + 1)];
+	float d111 = m_Distances[Index(c.x + 1, c.y + 1, c.z + 1)];
+
+	// Trilinear interpolation and its exact partial derivatives
+	float d00 = d000 + (d100 - d000) * f.x;
+	float d10 = d010 + (d110 - d010) * f.x;
+	float d01 = d001 + (d101 - d001) * f.x;
+	float d11 = d011 + (d111 - d011) * f.x;
+	float d0 = d00 + (d10 - d00) * f.y;
+	float d1 = d01 + (d11 - d01) * f.y;
+	distance = d0 + (d1 - d0) * f.z;
+
+	float gx0 = (d100 - d000) + ((d110 - d010) - (d100 - d000)) * f.y;
+	float gx1 = (d101 - d001) + ((d111 - d011) - (d101 - d001)) * f.y;
+	gradient.x = gx0 + (gx1 - gx0) * f.z;
+	gradient.y = (d10 - d00) + ((d11 - d01) - (d10 - d00)) * f.z;
+	gradient.z = d1 - d0;
+	gradient /= m_CellSize;
+	return true;
+}
+
+size_t SignedDistanceField::Resolve(ParticleStore& particles, const glm::mat4& localToCollider,
+									float thickness, float restitution) const
+{
+	if (m_Distances.empty()) return 0;
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+
+	// phi(A p) has gradient A^T grad(phi); to first order the surface is
+	// phi / |A^T grad(phi)| away along that direction, under any scale
+	glm::mat3 linearTranspose = glm::transpose(glm::mat3(localToCollider));
+
+	return ParallelReduce(0, positions.size(), PARTICLE_GRAIN, size_t(0),
+		[&](size_t first, size_t last)
+		{
+			size_t contacts = 0;
+			for (size_t i = first; i < last; i++)
+			{
+				glm::vec3& p = positions[i];
+				glm::vec3& v = velocities[i];
+
+				float distance;
+				glm::vec3 gradient;
+				if (!Sample(glm::vec3(localToCollider * glm::vec4(p, 1.0f)), distance, gradient))
+					continue;
+
+				glm::vec3 normal = linearTranspose * gradient;
+				float length = glm::length(normal);
+				if (length < 1e-8f) continue;
+				normal /= length;
+
+				float separation = distance / length;
+				if (separation >= thickness) continue;
+
+				p += (thickness - separation) * normal;
+
+				float vn = glm::dot(v, normal);
+				if (vn < 0.0f)
+					v -= (1.0f + restitution) * vn * normal;
+				contacts++;
+			}
+			return contacts;
+		},
+		[](size_t a, size_t b) { return a + b; });
+}
+
+bool SignedDistanceField::TraceSegment(const glm::vec3& start, const glm::vec3& end, float& fraction) const
+{
+	glm::vec3 segment = end - start;
+	float length = glm::length(segment);
+	if (length < 1e-8f) return false;
+
+	// Sphere tracing: the field bounds the free distance, outside the grid
+	// and close to the surface the march falls back to quarter-cell steps
+	float minStep = 0.25f * m_CellSize;
+	float previous = 0.0f;
+	float t = 0.0f;
+	for (int k = 0; k < SDF_TRACE_STEPS; k++)
+	{
+		float distance;
+		glm::vec3 gradient;
+		bool inside = Sample(start + segment * (t / length), distance, gradient);
+		if (inside && distance < 0.0f)
+		{
+			if (t == 0.0f) return false;    // started inside: the discrete pass handles it
+
+			// Bisect between the last free sample and this one
+			float lo = previous, hi = t;
+			for (int b = 0; b < SDF_TRACE_BISECTIONS; b++)
+			{
+				float mid = 0.5f * (lo + hi);
+				if (Sample(start + segment * (mid / length), distance, gradient) && distance < 0.0f)
+					hi = mid;
+				else
+					lo = mid;
+			}
+			fraction = lo / length;
+			return true;
+		}
+		if (t >= length) return false;
+
+		previous = t;
+		t = std::min(length, t + (inside ? std::max(distance, minStep) : minStep));
+	}
+	return false;
+}
+
+size_t SignedDistanceField::ResolveSwept(ParticleStore& particles, const std::vector<glm::vec3>& startPositions,
+										 const glm::mat4& localToCollider, float thickness, float restitution) const
+{
+	if (m_Distances.empty() || startPositions.size() != particles.Size()) return 0;
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	glm::mat3 linearTranspose = glm::transpose(glm::mat3(localToCollider));
+
+	return ParallelReduce(0, positions.size(), PARTICLE_GRAIN, size_t(0),
+		[&](size_t first, size_t last)
+		{
+			size_t contacts = 0;
+			for (size_t i = first; i < last; i++)
+			{
+				glm::vec3& p = positions[i];
+				glm::vec3& v = velocities[i];
+				const glm::vec3& start = startPositions[i];
+
+				float fraction;
+				glm::vec3 colliderStart = glm::vec3(localToCollider * glm::vec4(start, 1.0f));
+				glm::vec3 colliderEnd = glm::vec3(localToCollider * glm::vec4(p, 1.0f));
+				if (!TraceSegment(colliderStart, colliderEnd, fraction))
+					continue;
+
+				float distance;
+				glm::vec3 gradient;
+				if (!Sample(glm::mix(colliderStart, colliderEnd, fraction), distance, gradient))
+					continue;
+				glm::vec3 normal = linearTranspose * gradient;
+				float length = glm::length(normal);
+				if (length < 1e-8f) continue;
+				normal /= length;
+
+				// Affine maps keep segment fractions, so the contact is at the same fraction locally
+				glm::vec3 contact = glm::mix(start, p, fraction);
+				p += (thickness - glm::dot(p - contact, normal)) * normal;
+
+				float vn = glm::dot(v, normal);
+				if (vn < 0.0f)
+					v -= (1.0f + restitution) * vn * normal;
+				contacts++;
+			}
+			return contacts;
+		},
+		[](size_t a, size_t b) { return a + b; });
+}
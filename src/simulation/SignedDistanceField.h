@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "ParticleStore.h"
+#include "MeshCollider.h"
+
+const int SDF_DEFAULT_RESOLUTION = 64;
+const float SDF_BAND_CELLS = 3.0f;
+const int SDF_TRACE_STEPS = 256;
+const int SDF_TRACE_BISECTIONS = 8;
+
+// Narrow-band signed distance field of a static triangle mesh, sampled on
+// a regular grid in the mesh's own space (negative inside).
+// Bake asks the mesh's BVH for the nearest face of every grid point, in
+// parallel, but outside the mesh only within SDF_BAND_CELLS cells of the
+// surface; farther points store the band width. Signs come from a flood
+// fill of the empty points from the grid border (points it cannot reach
+// are inside and get their exact distance); points the surface passes
+// close to take the sign of their nearest face. Open meshes therefore
+// behave as thin shells.
+// A baked field is cached on disk under the hash of the geometry and the
+// bake settings, so loading the same model again skips the bake.
+// Collision is a trilinear lookup plus its analytic gradient: constant
+// cost per particle regardless of the triangle count.
+class SignedDistanceField
+{
+private:
+	glm::vec3 m_Origin = glm::vec3(0.0f);
+	glm::ivec3 m_Size = glm::ivec3(0);      // grid points per axis
+	float m_CellSize = 1.0f;
+	float m_Band = 0.0f;
+	std::vector<float> m_Distances;         // x fastest
+
+public:
+	SignedDistanceField() = default;
+
+	// resolution: cells along the longest axis of the mesh
+	void Bake(const MeshCollider& mesh, int resolution = SDF_DEFAULT_RESOLUTION);
+
+	// Loads the cached field for this mesh and resolution from cacheDirectory,
+	// or bakes and stores it; returns true on a cache hit
+	bool BakeCached(const MeshCollider& mesh, int resolution, const std::string& cacheDirectory);
+
+	// Distance and gradient at p; false outside the grid
+	bool Sample(const glm::vec3& p, float& distance, glm::vec3& gradient) const;
+
+	// localToCollider maps simulation space into the mesh's space; returns
+	// the number of particles corrected
+	size_t Resolve(ParticleStore& particles, const glm::mat4& localToCollider,
+				   float thickness, float restitution) const;
+
+	// Continuous pass: sphere-traces each particle's path from startPositions
+	// and puts particles that crossed into the surface back at the crossing
+	size_t ResolveSwept(ParticleStore& particles, const std::vector<glm::vec3>& startPositions,
+						const glm::mat4& localToCollider, float thickness, float restitution) const;
+
+	inline bool IsEmpty() const { return m_Distances.empty(); }
+	inline glm::ivec3 GetSize() const { return m_Size; }
+	inline size_t GetByteSize() const { return m_Distances.size() * sizeof(float); }
+
+	static uint64_t HashMesh(const MeshCollider& mesh, int resolution);
+
+private:
+	// First crossing into the surface along start-end, as a fraction of it
+	bool TraceSegment(const glm::vec3& start, const glm::vec3& end, float& fraction) const;
+
+	bool Load(const std::string& path, uint64_t hash);
+	bool Save(const std::string& path, uint64_t hash) const;
+
+	inline size_t Index(int x, int y, int z) const
+	{
+		return static_cast<size_t>(x) + static_cast<size_t>(m_Size.x) * (static_cast<size_t>(y) + static_cast<size_t>(m_Size.y) * z);
+	}
+};
+
+// A baked field placed in the scene for one frame
+struct SdfColliderInstance
+{
+	const SignedDistanceField* field = nullptr;
+	glm::mat4 localToCollider = glm::mat4(1.0f);
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+// Shared by the SIMD kernel translation units only (pulls in the intrinsic
+// headers): SOFTBODY_X86 is 1 when building for x86, where
+// SOFTBODY_TARGET(isa) compiles one function for an instruction set beyond
+// the baseline (MSVC needs no attribute) and cpuid is available for the
+// runtime dispatch.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define SOFTBODY_X86 1
+	#include <immintrin.h>
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#include <intrin.h>
+		#define SOFTBODY_TARGET(isa)
+	#else
+		#include <cpuid.h>
+		#define SOFTBODY_TARGET(isa) __attribute__((target(isa)))
+	#endif
+#else
+	#define SOFTBODY_X86 0
+#endif
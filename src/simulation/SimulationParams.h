@@ -3,8 +3,28 @@
 #include "ColliderBox.h"
 #include <glm/glm.hpp>
 
-enum class IntegrationMethod { ForwardEuler, Midpoint, ImplicitEuler };
+enum class IntegrationMethod { ForwardEuler, Midpoint, ImplicitEuler, XPBD, VelocityVerlet, RK4, AdaptiveRK23, ProjectiveDynamics };
 enum class VolumeMethod { AABB, BoundingSphere, BoundingEllipsoid, DivergenceTheorem };
+enum class PrecisionMode { Float, Mixed, Double };
+enum class SoftbodyModel { MassSpring, ShapeMatching, Fem };
+
+// Display names, indexed by IntegrationMethod
+const char* const INTEGRATION_METHOD_NAMES[] = { "Symplectic Euler", "Midpoint (2nd Order)", "Implicit Euler", "XPBD",
+												 "Velocity Verlet", "RK4 (4th Order)", "Adaptive RK23",
+												 "Projective Dynamics" };
+const int INTEGRATION_METHOD_COUNT = sizeof(INTEGRATION_METHOD_NAMES) / sizeof(INTEGRATION_METHOD_NAMES[0]);
+
+// Display names, indexed by PrecisionMode
+const char* const PRECISION_MODE_NAMES[] = { "Float", "Mixed (float + compensated double sums)", "Double" };
+const int PRECISION_MODE_COUNT = sizeof(PRECISION_MODE_NAMES) / sizeof(PRECISION_MODE_NAMES[0]);
+
+// Display names, indexed by SoftbodyModel
+const char* const SOFTBODY_MODEL_NAMES[] = { "Mass-Spring + Pressure", "Shape Matching (meshless)",
+											 "Co-rotational FEM (volumetric)" };
+const int SOFTBODY_MODEL_COUNT = sizeof(SOFTBODY_MODEL_NAMES) / sizeof(SOFTBODY_MODEL_NAMES[0]);
+
+// Factor over the sleep thresholds above which a body's sleep count resets
+const float SLEEP_WAKE_FACTOR = 2.0f;
 
 struct SimulationMetrics
 {
@@ -12,7 +32,25 @@ struct SimulationMetrics
 	float avgPhysicsStepMs = 0.0f;  // Running average
 	float maxParticleDist  = 0.0f;  // Max distance from center of mass
 	int   simFrameCount    = 0;     // Frames since simulation started
+	int   substeps         = 0;     // Physics steps run in the last frame
+	float substepsPerSec   = 0.0f;  // Running average of physics throughput
+	int   adaptiveAccepted = 0;     // Adaptive RK23: accepted steps (total)
+	int   adaptiveRejected = 0;     // Adaptive RK23: rejected steps (total)
+	int   adaptiveTruncated = 0;    // Adaptive RK23: physics steps cut short by the attempt cap (total)
+	float adaptiveStep     = 0.0f;  // Adaptive RK23: current step size (s)
+	size_t bodyPairs       = 0;     // Body-body broad phase pairs after the last step
+	size_t bodyContacts    = 0;     // Particle-face contacts resolved in the last step
+	size_t selfContacts    = 0;     // Self-collision contacts of body 0 in the last step
+	size_t meshContacts    = 0;     // Particle contacts with model colliders in the last step
+	size_t obstacleContacts = 0;    // Particle contacts with ColliderSet obstacles in the last step
+	size_t sweptContacts   = 0;     // Particle paths stopped by continuous collision in the last step
+	size_t sleepingBodies  = 0;     // Bodies skipped by the physics step
+	int   pdFactorizations = 0;     // Projective Dynamics: successful numeric factorizations so far
+	bool  pdSingular       = false; // Projective Dynamics: the last factorization failed (explicit fallback)
+	size_t pdFactorNonZeros = 0;    // Projective Dynamics: non-zeros in the Cholesky factor
 	bool  diverged         = false; // True if any particle exceeds threshold
+	int   solverIterations = 0;     // PCG iterations of the last implicit step
+	float solverResidual   = 0.0f;  // Relative residual of the last implicit step
 };
 
 struct SimulationParams
@@ -22,9 +60,78 @@ struct SimulationParams
 	float dampingConstant = 2.0f;
 	float gravityStrength = -9.8f;
 	unsigned int moles    = 500;
-	float integrationStep = 0.011f;
+	float integrationStep = 0.011f;  // Fixed physics step (s)
+	int   maxSubsteps     = 8;       // Cap on physics steps per rendered frame
+
+	// XPBD: substeps per physics step and constraint compliance (inverse stiffness)
+	int   xpbdSubsteps         = 10;
+	float xpbdCompliance       = 1e-4f;
+	float xpbdVolumeCompliance = 0.0f;
+
+	// Adaptive RK23: step bounds (s) and position error tolerance (world units).
+	// Each physics step spans adaptiveMaxStep and is covered by as many
+	// error-controlled steps as needed.
+	float adaptiveMinStep   = 0.0005f;
+	float adaptiveMaxStep   = 0.05f;
+	float adaptiveTolerance = 1e-3f;
+
+	// Projective Dynamics: local/global iterations per physics step
+	int   pdIterations = 10;
+
+	// Soft body vs soft body contacts and the gap they keep between surfaces
+	bool  bodyCollisions = true;
+	float bodyThickness  = 0.05f;
+
+	// Particle vs own-surface contacts (off by default: closed inflated
+	// bodies rarely fold, and the pass costs about as much as the springs)
+	bool  selfCollision = false;
+	float selfThickness = 0.02f;
+
+	// Swept particle paths against model, distance-field and obstacle
+	// colliders each step, so fast bodies cannot step through thin parts
+	bool  continuousCollision = true;
+
+	// Sleeping: a body whose mean kinetic energy per particle and fastest
+	// particle stay under these for sleepSteps steps stops simulating until
+	// a contact, a parameter change or a drag wakes it. Steps between the
+	// thresholds and SLEEP_WAKE_FACTOR times them neither count nor reset.
+	bool  sleeping    = true;
+	float sleepEnergy = 1e-4f;   // J per particle
+	float sleepSpeed  = 0.05f;   // world units per second
+	int   sleepSteps  = 60;
+
+	// New bodies: the model of bodies added from the UI, the vertices kept
+	// when a Model becomes a body (0: all) and the render surface (see
+	// SurfaceEmbedding). Render detail 0 draws the simulated particles;
+	// above 0 spheres draw an icosphere refined this many levels further
+	// and models their full welded surface, carried by the simulated cage.
+	SoftbodyModel spawnModel = SoftbodyModel::MassSpring;
+	int importParticleBudget = 1000;
+	int renderDetail = 0;
+
+	// Shape matching bodies (see ShapeMatchingSolver): fraction of the way
+	// to the goal shape per pass, clusters per axis of the rest shape and
+	// how far each cluster reaches into its neighbours (fraction of a cell).
+	// They ignore the spring, pressure and integrator settings.
+	float shapeStiffness = 0.5f;
+	int   shapeClusters  = 2;
+	float shapeOverlap   = 0.5f;
+	int   shapeIterations = 4;   // match/collide passes per physics step
+
+	// FEM bodies (see FemEngine): Young's modulus (Pa), Poisson's ratio,
+	// density (kg/m^3), stiffness-proportional Rayleigh damping (s) and
+	// interior grid cells along the longest axis of the tetrahedralization.
+	// They too ignore the spring, pressure and integrator settings.
+	float femYoungsModulus = 5e4f;
+	float femPoissonRatio  = 0.3f;
+	float femDensity       = 100.0f;
+	float femDamping       = 0.01f;
+	int   femResolution    = 6;
+
 	IntegrationMethod integrationMethod = IntegrationMethod::ForwardEuler;
 	VolumeMethod volumeMethod = VolumeMethod::DivergenceTheorem;
+	// Arithmetic of the volume and energy reductions (see Precision.h)
+	PrecisionMode precision = PrecisionMode::Float;
 
 	glm::vec3 externalForce    = glm::vec3(0.0f);
 
@@ -34,4 +141,36 @@ struct SimulationParams
 	ColliderBox collider;
 	bool showColliderBox  = true;
 	bool showBoundingBox  = false;
+
+	// True if a body at rest under one set of parameters may not be at rest
+	// under the other; such changes wake every sleeping body
+	bool ChangesDynamics(const SimulationParams& o) const
+	{
+		return particleMass != o.particleMass || springConstant != o.springConstant ||
+			   dampingConstant != o.dampingConstant || gravityStrength != o.gravityStrength ||
+			   moles != o.moles || integrationStep != o.integrationStep ||
+			   xpbdSubsteps != o.xpbdSubsteps || xpbdCompliance != o.xpbdCompliance ||
+			   xpbdVolumeCompliance != o.xpbdVolumeCompliance || adaptiveMinStep != o.adaptiveMinStep ||
+			   adaptiveMaxStep != o.adaptiveMaxStep || adaptiveTolerance != o.adaptiveTolerance ||
+			   pdIterations != o.pdIterations || bodyCollisions != o.bodyCollisions ||
+			   bodyThickness != o.bodyThickness || selfCollision != o.selfCollision ||
+			   selfThickness != o.selfThickness || continuousCollision != o.continuousCollision ||
+			   sleeping != o.sleeping || sleepEnergy != o.sleepEnergy ||
+			   sleepSpeed != o.sleepSpeed || sleepSteps != o.sleepSteps ||
+			   shapeStiffness != o.shapeStiffness || shapeClusters != o.shapeClusters ||
+			   shapeOverlap != o.shapeOverlap || shapeIterations != o.shapeIterations ||
+			   femYoungsModulus != o.femYoungsModulus || femPoissonRatio != o.femPoissonRatio ||
+			   femDensity != o.femDensity || femDamping != o.femDamping || femResolution != o.femResolution ||
+			   integrationMethod != o.integrationMethod || volumeMethod != o.volumeMethod ||
+			   precision != o.precision ||
+			   externalForce != o.externalForce || objectPosition != o.objectPosition ||
+			   collider.min != o.collider.min || collider.max != o.collider.max ||
+			   collider.enabled != o.collider.enabled || collider.restitution != o.collider.restitution;
+	}
+
+	// Simulated time covered by one physics step (the clock's fixed step)
+	float GetPhysicsStep() const
+	{
+		return integrationMethod == IntegrationMethod::AdaptiveRK23 ? adaptiveMaxStep : integrationStep;
+	}
 };
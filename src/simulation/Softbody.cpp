@@ -1,11 +1,50 @@
 #include "Softbody.h"
+#include <algorithm>
+#include <cmath>
 
-Softbody::Softbody(unsigned int selector, float size, unsigned int moles)
+// Safety cap on adaptive attempts per physics step
+static const int ADAPTIVE_MAX_ATTEMPTS = 1000;
+
+static std::shared_ptr<Mesh> MakeSurfaceMesh(const SimulationSurface& surface)
 {
+	std::vector<Vertex> vertices(surface.positions.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+		vertices[i] = { surface.positions[i], glm::vec3(0.0f), glm::vec2(0.0f) };
+	return std::make_shared<Mesh>(std::move(vertices), surface.triangles);
+}
+
+Softbody::Softbody(unsigned int selector, float size, unsigned int moles, const glm::vec3& offset,
+				   SoftbodyModel model, int renderDetail)
+{
+	m_Model = model;
+
 	// load mesh: 0 = sphere, 1 = cube
 	if (selector == 0) m_Mesh = std::make_shared<Mesh>();
 	else if (selector == 1) m_Mesh = std::make_shared<Mesh>(cube::vertices, cube::triangles);
 
+	std::shared_ptr<Mesh> renderMesh;
+	if (selector == 0 && renderDetail > 0)
+		renderMesh = std::make_shared<Mesh>(2 + renderDetail);
+
+	Initialize(size, moles, offset, renderMesh);
+}
+
+Softbody::Softbody(const SimulationSurface& surface, unsigned int moles, const glm::vec3& offset,
+				   SoftbodyModel model, const SimulationSurface* renderSurface)
+{
+	m_Model = model;
+	m_Mesh = MakeSurfaceMesh(surface);
+
+	std::shared_ptr<Mesh> renderMesh;
+	if (renderSurface && !renderSurface->positions.empty())
+		renderMesh = MakeSurfaceMesh(*renderSurface);
+
+	Initialize(1.0f, moles, offset, renderMesh);
+}
+
+void Softbody::Initialize(float size, unsigned int moles, const glm::vec3& offset,
+						  std::shared_ptr<Mesh> renderMesh)
+{
 	m_Material = std::make_shared<Material>();
 
 	m_Size = size;
@@ -14,51 +53,90 @@ Softbody::Softbody(unsigned int selector, float size, unsigned int moles)
 	CalculateBoundingBox();
 
 	AddParticles();
+	for (auto& p : m_Particles.GetPositions())
+		p += offset;
 	AddSprings();
 
 	// Store initial positions for reset
-	for (auto& p : m_Particles)
-		m_InitialPositions.push_back(p->GetPosition());
+	m_InitialPositions = m_Particles.GetPositions();
+	m_PreviousPositions = m_InitialPositions;
+
+	PhysicsEngine::ComputeSurface(m_Particles, m_Surface);
+	PhysicsEngine::ComputeVertexNormals(m_Surface);
+
+	// From here on the particles only carry the render mesh
+	if (renderMesh)
+	{
+		std::vector<glm::vec3> render;
+		render.reserve(renderMesh->GetVertices().size());
+		for (const Vertex& v : renderMesh->GetVertices())
+			render.push_back(v.Position + offset);
+		m_Embedding.Build(m_InitialPositions, m_Surface.GetTriangles(), m_Surface.GetVertexNormals(),
+						  render, renderMesh->GetIndices());
+		m_Mesh = renderMesh;
+	}
+	UpdateMeshFromParticles();
 }
 
 void Softbody::AddParticles()
 {
-	for (auto& v : m_Mesh->GetVertices())
-	{
-		auto temp = std::make_shared<Particle>(v.Position);
-		m_Particles.push_back(std::move(temp));
-	}
+	const auto& vertices = m_Mesh->GetVertices();
+	m_Particles.Reserve(vertices.size());
+	for (auto& v : vertices)
+		m_Particles.Add(v.Position);
 }
 
 void Softbody::AddSprings()
 {
-	const std::vector<Triangle>& triangles = m_Mesh->GetIndices();
-	size_t size = triangles.size();
-	for (unsigned int i = 0; i < size; ++i)
+	m_Springs.Build(m_Mesh->GetIndices(), m_Particles);
+	m_Surface.Build(m_Mesh->GetIndices(), m_Particles.Size());
+	// Shape matching and FEM keep the spring topology only for self
+	// collision; their clusters/tets are built from the rest shape on the
+	// first update
+	if (m_Model == SoftbodyModel::MassSpring)
 	{
-		std::shared_ptr<Particle> p1 = m_Particles[triangles[i].vertex[0]];
-		std::shared_ptr<Particle> p2 = m_Particles[triangles[i].vertex[1]];
-		std::shared_ptr<Particle> p3 = m_Particles[triangles[i].vertex[2]];
-
-		m_Springs.push_back(MakeSpring(p1, p2));
-		m_Springs.push_back(MakeSpring(p2, p3));
-		m_Springs.push_back(MakeSpring(p3, p1));
+		m_ImplicitSolver.Build(m_Particles.Size(), m_Springs);
+		m_XpbdSolver.Build(m_Particles, m_Surface);
+		m_ProjectiveSolver.Build(m_Particles.Size(), m_Springs);
 	}
+	m_SurfaceBvh.Build(m_Surface.GetTriangles(), m_Particles.GetPositions());
+	m_SelfCollision.Build(m_Particles, m_Springs);
 }
 
-std::shared_ptr<Spring> Softbody::MakeSpring(std::shared_ptr<Particle> endOne, std::shared_ptr<Particle> endTwo)
+// XPBD and Projective Dynamics compute their own forces and volumes; every
+// other method evaluates forces through the StepPipeline
+static bool UsesForcePipeline(IntegrationMethod method)
 {
-	return std::make_shared<Spring>(endOne, endTwo);
+	return method != IntegrationMethod::XPBD && method != IntegrationMethod::ProjectiveDynamics;
+}
+
+// Bounding box of the current particle state (the mesh may lag behind
+// during multi-stage steps or show an interpolated state)
+void Softbody::CalculateParticleBounds()
+{
+	const auto& positions = m_Particles.GetPositions();
+	if (positions.empty()) return;
+
+	glm::vec3 vMin = positions[0];
+	glm::vec3 vMax = positions[0];
+	for (size_t i = 1; i < positions.size(); i++)
+	{
+		vMin = glm::min(vMin, positions[i]);
+		vMax = glm::max(vMax, positions[i]);
+	}
+
+	m_BoundingBox[0] = vMin;
+	m_BoundingBox[1] = vMax;
 }
 
 // Compute all 4 volume methods and select the active one based on params
 void Softbody::ComputeVolumes(const SimulationParams& params)
 {
-	CalculateBoundingBox();
+	CalculateParticleBounds();
 	m_VolumeAABB = PhysicsEngine::CalculateAABBVolume(m_BoundingBox[0], m_BoundingBox[1]);
 	m_VolumeSphere = PhysicsEngine::CalculateBoundingSphereVolume(m_BoundingBox[0], m_BoundingBox[1]);
 	m_VolumeEllipsoid = PhysicsEngine::CalculateBoundingEllipsoidVolume(m_BoundingBox[0], m_BoundingBox[1]);
-	m_VolumeExact = PhysicsEngine::CalculateExactVolume(m_Mesh->GetIndices(), m_Mesh->GetVertices());
+	m_VolumeExact = PhysicsEngine::ComputeSurface(params.precision, m_Particles, m_Surface);
 
 	switch (params.volumeMethod)
 	{
@@ -69,156 +147,368 @@ void Softbody::ComputeVolumes(const SimulationParams& params)
 	}
 }
 
-// Helper: accumulate all forces (gravity + spring/damping + pressure)
-void Softbody::AccumulateForces(const SimulationParams& params)
+// Bounding volumes for display (the pipeline only computes the active
+// volume); without a pressure term (or pipeline) the face pass and the
+// normals are also refreshed here, once per frame
+void Softbody::UpdateDisplayVolumes(const SimulationParams& params)
+{
+	if (m_Model != SoftbodyModel::MassSpring || !StepPipeline::HasPressure(m_PipelineKey))
+	{
+		ComputeVolumes(params);
+		PhysicsEngine::ComputeVertexNormals(m_Surface);
+		return;
+	}
+
+	CalculateParticleBounds();
+	m_VolumeAABB = PhysicsEngine::CalculateAABBVolume(m_BoundingBox[0], m_BoundingBox[1]);
+	m_VolumeSphere = PhysicsEngine::CalculateBoundingSphereVolume(m_BoundingBox[0], m_BoundingBox[1]);
+	m_VolumeEllipsoid = PhysicsEngine::CalculateBoundingEllipsoidVolume(m_BoundingBox[0], m_BoundingBox[1]);
+}
+
+void Softbody::SelectPipeline(const SimulationParams& params)
 {
-	PhysicsEngine::ApplyGravity(m_Particles, params.gravityStrength);
-	PhysicsEngine::ApplyExternalForce(m_Particles, params.externalForce);
-	PhysicsEngine::ApplySpringDampingForces(m_Springs,
-		params.springConstant, params.dampingConstant);
+	int key = StepPipeline::GetKey(params);
+	if (key == m_PipelineKey) return;
 
-	ComputeVolumes(params);
+	m_PipelineKey = key;
+	m_Evaluate = StepPipeline::SelectEvaluate(key);
+	m_PipelineStep = StepPipeline::SelectStep(key);
+}
+
+StepContext Softbody::MakeStepContext(const SimulationParams& params)
+{
+	return StepContext{ m_Particles, m_Springs, m_Surface, m_Integrator, m_ImplicitSolver, params };
+}
 
-	m_PressureValue = PhysicsEngine::CalculatePressure(m_Volume, params.moles);
-	PhysicsEngine::ApplyPressureForce(m_Particles, m_Mesh->GetIndices(),
-		m_Mesh->GetVertices(), m_PressureValue);
+void Softbody::ReadStepContext(const StepContext& ctx)
+{
+	if (StepPipeline::HasPressure(m_PipelineKey))
+	{
+		m_Volume = ctx.volume;
+		m_VolumeExact = ctx.exactVolume;
+		m_PressureValue = ctx.pressure;
+	}
+	else
+	{
+		m_PressureValue = 0.0f;
+	}
 }
 
-// Helper: sync mesh vertices from particle positions
-void Softbody::UpdateMeshFromParticles()
+// Helper: sync mesh vertices from particle positions, blended between the
+// previous and current physics state by alpha (1 = current)
+void Softbody::UpdateMeshFromParticles(float alpha)
 {
-	std::vector<Vertex> vertices;
-	vertices.reserve(m_Particles.size());
-	for (auto& p : m_Particles)
-		vertices.push_back({ p->GetPosition(), glm::vec3(0.0f), glm::vec2(0.0f) });
-	m_Mesh->SetVertices(vertices);
+	const auto& positions = m_Particles.GetPositions();
+	const auto& normals = m_Surface.GetVertexNormals();
+
+	// Written in place; normals come from the last pressure pass
+	// (fused with the volume pass)
+	auto& vertices = m_Mesh->GetVerticesForWrite();
+	if (m_Embedding.IsEmpty())
+	{
+		vertices.resize(positions.size());
+		for (size_t i = 0; i < positions.size(); i++)
+		{
+			vertices[i].Position = (alpha >= 1.0f) ? positions[i]
+				: glm::mix(m_PreviousPositions[i], positions[i], alpha);
+			vertices[i].Normal = normals[i];
+		}
+	}
+	else
+	{
+		// The cage is interpolated first, then carries the render mesh
+		const std::vector<glm::vec3>* cage = &positions;
+		if (alpha < 1.0f)
+		{
+			m_DisplayPositions.resize(positions.size());
+			for (size_t i = 0; i < positions.size(); i++)
+				m_DisplayPositions[i] = glm::mix(m_PreviousPositions[i], positions[i], alpha);
+			cage = &m_DisplayPositions;
+		}
+		m_Embedding.Apply(*cage, normals, vertices);
+	}
 	CalculateBoundingBox();
+	m_MeshDirty = true;
+	m_MeshCurrent = true;
+	m_MeshAlpha = alpha;
 }
 
-// Paper Section 3.3: Full simulation algorithm
-void Softbody::Update(bool simulate, const SimulationParams& params,
+// Advances the body by `substeps` fixed steps of params.integrationStep,
+// then shows the state interpolated by alpha between the last two steps
+void Softbody::Update(int substeps, float alpha, const SimulationParams& params,
 					   const ColliderBox& collider)
 {
-	GameObject::Update(simulate, params.objectPosition);
+	BeginUpdate(substeps, params);
+	for (int i = 0; i < substeps; i++)
+		StepOnce(params, collider, i == substeps - 1);
+	EndUpdate(alpha);
+}
+
+void Softbody::BeginUpdate(int substeps, const SimulationParams& params)
+{
+	GameObject::Update(substeps > 0, params.objectPosition);
 	SetParticleMass(params.particleMass);
+	m_Springs.SetUniformCoefficients(params.springConstant, params.dampingConstant);
 
-	if (!simulate) return;
+	// Cached stage data belongs to the previous method
+	if (params.integrationMethod != m_LastMethod)
+	{
+		m_Integrator.Invalidate();
+		m_LastMethod = params.integrationMethod;
+	}
+	SelectPipeline(params);
+
+	if (m_Model == SoftbodyModel::ShapeMatching &&
+		m_ShapeMatching.NeedsBuild(m_Particles.Size(), params))
+		m_ShapeMatching.Build(m_Particles, m_InitialPositions, params.shapeClusters, params.shapeOverlap);
+	if (m_Model == SoftbodyModel::Fem && m_Fem.NeedsBuild(m_Particles.Size(), params))
+	{
+		m_Fem.Build(m_InitialPositions, m_Surface.GetTriangles(), params.femResolution);
+		m_Fem.FollowSurface(m_Particles);
+	}
+}
+
+void Softbody::StepOnce(const SimulationParams& params, const ColliderBox& collider, bool lastStep)
+{
+	if (m_Asleep) return;
 
 	// Local-space collider (subtract object translation)
 	ColliderBox localCollider = collider;
 	localCollider.min -= params.objectPosition;
 	localCollider.max -= params.objectPosition;
 
-	float dt = params.integrationStep;
+	// Only the state before the final step is needed for interpolation
+	if (lastStep)
+		m_PreviousPositions = m_Particles.GetPositions();
+	if (params.continuousCollision)
+		m_StepStartPositions = m_Particles.GetPositions();
+	else
+		m_StepStartPositions.clear();
+	Step(params, localCollider);
+	m_MeshCurrent = false;
+	if (lastStep && (m_Model != SoftbodyModel::MassSpring || UsesForcePipeline(params.integrationMethod)))
+		UpdateDisplayVolumes(params);
+
+	if (params.selfCollision)
+		m_SelfCollision.Resolve(m_Particles, m_Surface, params.selfThickness);
+
+	UpdateSleep(params);
+}
 
-	switch (params.integrationMethod)
-	{
-	case IntegrationMethod::ForwardEuler:
+void Softbody::EndUpdate(float alpha)
+{
+	// A sleeping body's mesh only needs writing once, unblended
+	if (m_MeshSettled) return;
+	if (m_Asleep)
 	{
-		PhysicsEngine::ClearForces(m_Particles);
-		AccumulateForces(params);
-		PhysicsEngine::Integrate(m_Particles, dt);
-		PhysicsEngine::ResolveCollisions(m_Particles, localCollider);
-		break;
+		alpha = 1.0f;
+		m_MeshSettled = true;
 	}
+	else if (m_MeshCurrent && alpha == m_MeshAlpha)
+		return;
+	UpdateMeshFromParticles(alpha);
+}
+
+void Softbody::UploadChangedBuffers()
+{
+	if (!m_MeshDirty) return;
+	UploadBuffers();
+	m_MeshDirty = false;
+}
 
-	case IntegrationMethod::Midpoint:
+// Hysteresis on the sleep count: quiet steps count towards sleeping,
+// clearly moving steps reset it, steps in between leave it alone, so a
+// body hovering at the thresholds neither sleeps early nor never sleeps
+void Softbody::UpdateSleep(const SimulationParams& params)
+{
+	if (!params.sleeping)
 	{
-		// Save original state
-		size_t n = m_Particles.size();
-		std::vector<glm::vec3> origPos(n), origVel(n);
-		for (size_t i = 0; i < n; i++)
-		{
-			origPos[i] = m_Particles[i]->GetPosition();
-			origVel[i] = m_Particles[i]->GetVelocity();
-		}
+		m_QuietSteps = 0;
+		return;
+	}
 
-		// Compute forces at current state
-		PhysicsEngine::ClearForces(m_Particles);
-		AccumulateForces(params);
+	float maxSpeed2 = 0.0f;
+	float energy = PhysicsEngine::ComputeKineticEnergy(params.precision, m_Particles, maxSpeed2);
+	if (m_Particles.Size() > 0)
+		energy /= static_cast<float>(m_Particles.Size());
+
+	float speed2 = params.sleepSpeed * params.sleepSpeed;
+	float wake2 = SLEEP_WAKE_FACTOR * SLEEP_WAKE_FACTOR;
+	if (energy < params.sleepEnergy && maxSpeed2 < speed2)
+		m_QuietSteps++;
+	else if (energy > SLEEP_WAKE_FACTOR * params.sleepEnergy || maxSpeed2 > wake2 * speed2)
+		m_QuietSteps = 0;
+
+	if (m_QuietSteps < params.sleepSteps) return;
+
+	// Settle exactly where the body is
+	m_Asleep = true;
+	for (auto& v : m_Particles.GetVelocities())
+		v = glm::vec3(0.0f);
+	m_PreviousPositions = m_Particles.GetPositions();
+	m_StepStartPositions.clear();
+}
 
-		// Half-step: move particles to midpoint
-		float halfDt = dt * 0.5f;
-		for (size_t i = 0; i < n; i++)
-		{
-			glm::vec3 a = m_Particles[i]->GetForceAccumulated() / m_Particles[i]->GetMass();
-			glm::vec3 vHalf = origVel[i] + a * halfDt;
-			glm::vec3 xHalf = origPos[i] + vHalf * halfDt;
-			m_Particles[i]->SetVelocity(vHalf);
-			m_Particles[i]->SetPosition(xHalf);
-		}
+void Softbody::Wake()
+{
+	m_Asleep = false;
+	m_QuietSteps = 0;
+	m_MeshSettled = false;
+	m_MeshCurrent = false;
+}
 
-		// Update mesh so pressure/volume uses half-step geometry
-		UpdateMeshFromParticles();
+void Softbody::OnDynamicsChanged()
+{
+	m_Integrator.Invalidate();
+	Wake();
+}
 
-		// Recompute forces at half-step state
-		PhysicsEngine::ClearForces(m_Particles);
-		AccumulateForces(params);
+void Softbody::RefitSurfaceBvh(float margin)
+{
+	m_SurfaceBvh.Refit(m_Surface.GetTriangles(), m_Particles.GetPositions(), margin);
+}
 
-		// Full step from original state using half-step forces
-		for (size_t i = 0; i < n; i++)
-		{
-			glm::vec3 aHalf = m_Particles[i]->GetForceAccumulated() / m_Particles[i]->GetMass();
-			glm::vec3 newVel = origVel[i] + aHalf * dt;
-			glm::vec3 newPos = origPos[i] + newVel * dt;
-			m_Particles[i]->SetVelocity(newVel);
-			m_Particles[i]->SetPosition(newPos);
-		}
+// Paper Section 3.3: Full simulation algorithm (one fixed step)
+void Softbody::Step(const SimulationParams& params, const ColliderBox& localCollider)
+{
+	float dt = params.GetPhysicsStep();
 
-		PhysicsEngine::ResolveCollisions(m_Particles, localCollider);
-		break;
+	// Meshless: no springs, pressure or integrator choice
+	if (m_Model == SoftbodyModel::ShapeMatching)
+	{
+		m_ShapeMatching.Step(m_Particles, params, localCollider, dt);
+		m_PressureValue = 0.0f;
+		return;
 	}
 
-	case IntegrationMethod::ImplicitEuler:
+	// Volumetric: its own implicit step over the tet mesh
+	if (m_Model == SoftbodyModel::Fem)
 	{
-		size_t n = m_Particles.size();
+		m_Fem.Step(m_Particles, params, localCollider, dt);
+		m_PressureValue = 0.0f;
+		return;
+	}
+
+	// The fixed-step explicit schemes and implicit Euler run as one
+	// specialized pipeline
+	if (m_PipelineStep)
+	{
+		StepContext ctx = MakeStepContext(params);
+		m_PipelineStep(ctx, localCollider, dt);
+		ReadStepContext(ctx);
+		return;
+	}
 
-		// 1) Collect explicit forces: gravity + external + pressure
+	switch (params.integrationMethod)
+	{
+	case IntegrationMethod::ProjectiveDynamics:
+	{
+		// Springs/damping are solved by the prefactored local/global
+		// iterations; gravity, external and pressure forces are explicit
 		PhysicsEngine::ClearForces(m_Particles);
 		PhysicsEngine::ApplyGravity(m_Particles, params.gravityStrength);
 		PhysicsEngine::ApplyExternalForce(m_Particles, params.externalForce);
-
 		ComputeVolumes(params);
 		m_PressureValue = PhysicsEngine::CalculatePressure(m_Volume, params.moles);
-		PhysicsEngine::ApplyPressureForce(m_Particles, m_Mesh->GetIndices(),
-			m_Mesh->GetVertices(), m_PressureValue);
-
-		std::vector<glm::vec3> explicitForces(n);
-		for (size_t i = 0; i < n; i++)
-			explicitForces[i] = m_Particles[i]->GetForceAccumulated();
+		PhysicsEngine::ApplyPressureForce(m_Particles, m_Surface, m_PressureValue);
 
-		// 2) Collect spring/damping forces only (for implicit solve)
-		PhysicsEngine::ClearForces(m_Particles);
-		PhysicsEngine::ApplySpringDampingForces(m_Springs,
-			params.springConstant, params.dampingConstant);
-
-		// 3) Implicit integrate: explicit kick for gravity/pressure,
-		//    implicit solve for stiff spring/damping forces
-		PhysicsEngine::IntegrateImplicit(m_Particles, m_Springs,
-			explicitForces, params.springConstant, params.dampingConstant, dt);
+		m_ProjectiveSolver.Step(m_Particles, m_Springs, params);
 		PhysicsEngine::ResolveCollisions(m_Particles, localCollider);
 		break;
 	}
+
+	case IntegrationMethod::AdaptiveRK23:
+	{
+		AdvanceAdaptive(params, localCollider, dt);
+		break;
 	}
 
-	UpdateMeshFromParticles();
+	case IntegrationMethod::XPBD:
+	{
+		// Constraint-based: springs, gas volume and collider are all
+		// projected inside the solver's own substeps
+		m_XpbdSolver.Step(m_Particles, m_Springs, m_Surface, params, localCollider);
+		ComputeVolumes(params);
+		m_PressureValue = m_XpbdSolver.GetPressure();
+		break;
+	}
+
+	default:
+		break;
+	}
 }
 
-void Softbody::Reset()
+// Covers `duration` with error-controlled Bogacki-Shampine steps. A step is
+// accepted when its error estimate is within tolerance (or the controller
+// is already at the minimum size); either way the next size follows
+// h * 0.9 * err^(-1/3). Time left over when the attempt cap is hit is
+// dropped and counted in m_TruncatedSteps.
+void Softbody::AdvanceAdaptive(const SimulationParams& params, const ColliderBox& localCollider,
+							   float duration)
 {
-	for (size_t i = 0; i < m_Particles.size(); ++i)
+	float minStep = std::max(1e-6f, std::min(params.adaptiveMinStep, params.adaptiveMaxStep));
+	float maxStep = params.adaptiveMaxStep;
+	float tolerance = std::max(1e-9f, params.adaptiveTolerance);
+	if (m_AdaptiveStep <= 0.0f) m_AdaptiveStep = maxStep;
+
+	StepContext ctx = MakeStepContext(params);
+	auto evaluate = [&]() { m_Evaluate(ctx); };
+
+	float remaining = duration;
+	int attempts = 0;
+	while (remaining > 1e-7f && attempts++ < ADAPTIVE_MAX_ATTEMPTS)
 	{
-		m_Particles[i]->SetPosition(m_InitialPositions[i]);
-		m_Particles[i]->SetVelocity(glm::vec3(0.0f));
-		m_Particles[i]->ClearForce();
-	}
+		// minStep bounds the controller only; the last step may be shorter
+		// so the steps never run past `duration`
+		float proposed = std::max(minStep, m_AdaptiveStep);
+		float h = std::min(remaining, proposed);
+		float error = m_Integrator.StepEmbedded(m_Particles, h, evaluate) / tolerance;
 
-	std::vector<Vertex> vertices;
-	for (auto& p : m_Particles)
-		vertices.push_back({ p->GetPosition(), glm::vec3(0.0f), glm::vec2(0.0f) });
-	m_Mesh->SetVertices(vertices);
+		if (error <= 1.0f || proposed <= minStep)
+		{
+			PhysicsEngine::ResolveCollisions(m_Particles, localCollider);
+			remaining -= h;
+			m_AcceptedSteps++;
 
-	CalculateBoundingBox();
+			// A step cut short by the end of the interval keeps the size
+			// the controller proposed
+			if (h < proposed) continue;
+		}
+		else
+		{
+			m_Integrator.RestoreStart(m_Particles);
+			m_RejectedSteps++;
+		}
+
+		float factor = (error > 0.0f) ? 0.9f * std::pow(error, -1.0f / 3.0f) : 5.0f;
+		factor = std::min(5.0f, std::max(0.2f, factor));
+		m_AdaptiveStep = std::min(maxStep, std::max(minStep, h * factor));
+	}
+	if (remaining > 1e-7f)
+		m_TruncatedSteps++;
+	ReadStepContext(ctx);
+}
+
+void Softbody::Reset()
+{
+	m_Particles.GetPositions() = m_InitialPositions;
+	m_PreviousPositions = m_InitialPositions;
+	for (auto& v : m_Particles.GetVelocities())
+		v = glm::vec3(0.0f);
+	m_Particles.ClearForces();
+	m_ImplicitSolver.ClearWarmStart();
+	m_ShapeMatching.ResetRotations();
+	m_Fem.Reset();
+	m_Integrator.Invalidate();
+	m_AdaptiveStep = 0.0f;
+	m_AcceptedSteps = 0;
+	m_RejectedSteps = 0;
+	m_TruncatedSteps = 0;
+	Wake();
+
+	PhysicsEngine::ComputeSurface(m_Particles, m_Surface);
+	PhysicsEngine::ComputeVertexNormals(m_Surface);
+	UpdateMeshFromParticles();
 }
 
 void Softbody::SetPressureValue(float pressureVal)
@@ -233,6 +523,5 @@ void Softbody::SetNoOfMoles(unsigned int n)
 
 void Softbody::SetParticleMass(float mass)
 {
-	for (auto& p : m_Particles)
-		p->SetMass(mass);
+	m_Particles.SetUniformMass(mass);
 }
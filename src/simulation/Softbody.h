@@ -3,11 +3,21 @@
 #include <iostream>
 #include <vector>
 #include "GameObject.h"
-#include "Spring.h"
-#include "Particle.h"
+#include "SpringTopology.h"
+#include "ParticleStore.h"
 #include "SimulationParams.h"
 #include "ColliderBox.h"
 #include "PhysicsEngine.h"
+#include "XpbdSolver.h"
+#include "ProjectiveDynamicsSolver.h"
+#include "ShapeMatchingSolver.h"
+#include "FemEngine.h"
+#include "SurfaceBuilder.h"
+#include "SurfaceEmbedding.h"
+#include "ExplicitIntegrator.h"
+#include "StepPipeline.h"
+#include "TriangleBvh.h"
+#include "SelfCollision.h"
 
 class Softbody : public GameObject
 {
@@ -19,13 +29,79 @@ private:
 	float m_VolumeExact = 0.0f;
 	float m_PressureValue = 0.0f;
 	unsigned int m_NoOfMoles = 0;
-	std::vector<std::shared_ptr<Particle>> m_Particles;
-	std::vector<std::shared_ptr<Spring>> m_Springs;
+	SoftbodyModel m_Model = SoftbodyModel::MassSpring;
+	ParticleStore m_Particles;
+	SpringTopology m_Springs;
+	SurfaceTopology m_Surface;
+	TriangleBvh m_SurfaceBvh;
+	SelfCollision m_SelfCollision;
+	ImplicitSolver m_ImplicitSolver;
+	XpbdSolver m_XpbdSolver;
+	ProjectiveDynamicsSolver m_ProjectiveSolver;
+	ShapeMatchingSolver m_ShapeMatching;
+	FemEngine m_Fem;
+	SurfaceEmbedding m_Embedding;   // empty when the particles are the rendered vertices
+	ExplicitIntegrator m_Integrator;
+	IntegrationMethod m_LastMethod = IntegrationMethod::ForwardEuler;
+
+	// Specialized force/integrator pipeline for the current params
+	int m_PipelineKey = -1;
+	StepPipeline::EvaluateFunction m_Evaluate = nullptr;
+	StepPipeline::StepFunction m_PipelineStep = nullptr;
+
+	// Adaptive RK23 controller state
+	float m_AdaptiveStep = 0.0f;
+	int m_AcceptedSteps = 0;
+	int m_RejectedSteps = 0;
+	int m_TruncatedSteps = 0;	// physics steps left unfinished at the attempt cap
 	std::vector<glm::vec3> m_InitialPositions;
+	std::vector<glm::vec3> m_PreviousPositions;	// state before the last step, for render interpolation
+	std::vector<glm::vec3> m_StepStartPositions;	// state before the current step, for swept collisions
+	std::vector<glm::vec3> m_DisplayPositions;	// interpolated cage carrying the render mesh
+
+	// Sleeping: while asleep the body keeps its last state, volume and
+	// pressure, and its mesh is written and uploaded once
+	bool m_Asleep = false;
+	int m_QuietSteps = 0;
+	bool m_MeshSettled = false;
+	bool m_MeshDirty = true;
+	// The mesh shows the current state at m_MeshAlpha (nothing stepped since),
+	// so a paused clock writes nothing
+	bool m_MeshCurrent = false;
+	float m_MeshAlpha = 1.0f;
 
 public:
-	Softbody(unsigned int selector, float size = 1.0f, unsigned int moles = 500);
-	void Update(bool simulate, const SimulationParams& params, const ColliderBox& collider);
+	// offset: initial displacement of the particles in simulation space.
+	// Shape matching bodies skip the spring-network solvers entirely.
+	// renderDetail > 0 draws a sphere as an icosphere refined that many
+	// more levels, carried by the simulated one (cubes ignore it).
+	Softbody(unsigned int selector, float size = 1.0f, unsigned int moles = 500,
+			 const glm::vec3& offset = glm::vec3(0.0f), SoftbodyModel model = SoftbodyModel::MassSpring,
+			 int renderDetail = 0);
+	// Body from an arbitrary surface, e.g. an imported Model prepared by
+	// SurfaceBuilder: one particle per vertex, one spring per edge. A
+	// renderSurface in the same space is drawn instead, carried by it.
+	Softbody(const SimulationSurface& surface, unsigned int moles, const glm::vec3& offset,
+			 SoftbodyModel model = SoftbodyModel::MassSpring, const SimulationSurface* renderSurface = nullptr);
+	void Update(int substeps, float alpha, const SimulationParams& params, const ColliderBox& collider);
+
+	// Update split into its phases, for callers that interleave other work
+	// (body-body collisions) between the physics steps
+	void BeginUpdate(int substeps, const SimulationParams& params);
+	void StepOnce(const SimulationParams& params, const ColliderBox& collider, bool lastStep);
+	void EndUpdate(float alpha);
+
+	// Uploads the mesh if EndUpdate changed it since the last upload
+	void UploadChangedBuffers();
+
+	void Wake();
+	// Parameters that change the forces were edited: wakes the body and
+	// drops the integrator's cached accelerations, which used the old ones
+	void OnDynamicsChanged();
+	bool IsAsleep() const { return m_Asleep; }
+
+	// Refits the surface BVH to the current particles, boxes grown by margin
+	void RefitSurfaceBvh(float margin);
 	void Reset();
 
 	void SetPressureValue(float pressureVal);
@@ -39,16 +115,40 @@ public:
 	float GetVolumeEllipsoid() const { return m_VolumeEllipsoid; }
 	float GetVolumeExact() const { return m_VolumeExact; }
 	float GetPressure() const { return m_PressureValue; }
-	size_t GetParticleCount() const { return m_Particles.size(); }
-	size_t GetSpringCount() const { return m_Springs.size(); }
+	size_t GetParticleCount() const { return m_Particles.Size(); }
+	size_t GetSpringCount() const { return m_Springs.Size(); }
+	size_t GetRenderVertexCount() const { return m_Embedding.IsEmpty() ? m_Particles.Size() : m_Embedding.GetVertexCount(); }
+	SoftbodyModel GetModel() const { return m_Model; }
+	const ShapeMatchingSolver& GetShapeMatching() const { return m_ShapeMatching; }
+	const FemEngine& GetFem() const { return m_Fem; }
+	ParticleStore& GetParticles() { return m_Particles; }
+	const ParticleStore& GetParticles() const { return m_Particles; }
+	const SurfaceTopology& GetSurface() const { return m_Surface; }
+	const std::vector<glm::vec3>& GetStepStartPositions() const { return m_StepStartPositions; }
+	const TriangleBvh& GetSurfaceBvh() const { return m_SurfaceBvh; }
+	const SelfCollision& GetSelfCollision() const { return m_SelfCollision; }
+	const ImplicitSolver& GetImplicitSolver() const { return m_ImplicitSolver; }
+	const ProjectiveDynamicsSolver& GetProjectiveSolver() const { return m_ProjectiveSolver; }
+	float GetAdaptiveStep() const { return m_AdaptiveStep; }
+	int GetAcceptedSteps() const { return m_AcceptedSteps; }
+	int GetRejectedSteps() const { return m_RejectedSteps; }
+	int GetTruncatedSteps() const { return m_TruncatedSteps; }
 
 private:
+	void Initialize(float size, unsigned int moles, const glm::vec3& offset,
+					std::shared_ptr<Mesh> renderMesh = nullptr);
 	void AddParticles();
 	void AddSprings();
-	std::shared_ptr<Spring> MakeSpring(std::shared_ptr<Particle> endOne, std::shared_ptr<Particle> endTwo);
 
 	// Per-method simulation steps
+	void CalculateParticleBounds();
 	void ComputeVolumes(const SimulationParams& params);
-	void AccumulateForces(const SimulationParams& params);
-	void UpdateMeshFromParticles();
+	void UpdateDisplayVolumes(const SimulationParams& params);
+	void SelectPipeline(const SimulationParams& params);
+	StepContext MakeStepContext(const SimulationParams& params);
+	void ReadStepContext(const StepContext& ctx);
+	void Step(const SimulationParams& params, const ColliderBox& localCollider);
+	void UpdateSleep(const SimulationParams& params);
+	void AdvanceAdaptive(const SimulationParams& params, const ColliderBox& localCollider, float duration);
+	void UpdateMeshFromParticles(float alpha = 1.0f);
 };
@@ -0,0 +1,234 @@
+#include "SparseCholesky.h"
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <utility>
+
+// Minimum degree ordering on an explicit elimination graph: repeatedly
+// eliminate the node with the fewest neighbours and connect its neighbours
+// into a clique. Ties go to the lowest index, so the ordering is deterministic.
+void SparseCholesky::ComputeOrdering(const std::vector<SpringEdge>& edges)
+{
+	size_t n = m_Size;
+	std::vector<std::vector<uint32_t>> adjacency(n);
+	for (const SpringEdge& edge : edges)
+	{
+		if (edge.a == edge.b) continue;
+		adjacency[edge.a].push_back(edge.b);
+		adjacency[edge.b].push_back(edge.a);
+	}
+
+	std::set<std::pair<size_t, uint32_t>> queue;
+	for (uint32_t i = 0; i < n; i++)
+	{
+		auto& row = adjacency[i];
+		std::sort(row.begin(), row.end());
+		row.erase(std::unique(row.begin(), row.end()), row.end());
+		queue.insert({ row.size(), i });
+	}
+
+	m_Permutation.resize(n);
+	std::vector<uint32_t> clique;
+	std::vector<uint32_t> merged;
+	for (size_t k = 0; k < n; k++)
+	{
+		uint32_t pivot = queue.begin()->second;
+		queue.erase(queue.begin());
+		m_Permutation[k] = pivot;
+
+		clique.swap(adjacency[pivot]);
+		for (uint32_t u : clique)
+		{
+			auto& row = adjacency[u];
+			queue.erase({ row.size(), u });
+
+			merged.clear();
+			std::set_union(row.begin(), row.end(), clique.begin(), clique.end(),
+						   std::back_inserter(merged));
+			merged.erase(std::remove_if(merged.begin(), merged.end(),
+				[u, pivot](uint32_t v) { return v == u || v == pivot; }), merged.end());
+
+			row.swap(merged);
+			queue.insert({ row.size(), u });
+		}
+		clique.clear();
+	}
+
+	m_InversePermutation.resize(n);
+	for (size_t k = 0; k < n; k++)
+		m_InversePermutation[m_Permutation[k]] = static_cast<uint32_t>(k);
+}
+
+void SparseCholesky::Analyze(size_t size, const std::vector<SpringEdge>& edges)
+{
+	m_Size = size;
+	m_Factored = false;
+	ComputeOrdering(edges);
+
+	size_t n = size;
+
+	// Upper triangle of P A P^T by column: the diagonal plus one entry per edge
+	m_ColumnOffsets.assign(n + 1, 0);
+	for (size_t i = 0; i < n; i++)
+		m_ColumnOffsets[i + 1]++;
+	for (const SpringEdge& edge : edges)
+	{
+		uint32_t column = std::max(m_InversePermutation[edge.a], m_InversePermutation[edge.b]);
+		m_ColumnOffsets[column + 1]++;
+	}
+	for (size_t k = 0; k < n; k++)
+		m_ColumnOffsets[k + 1] += m_ColumnOffsets[k];
+
+	m_RowIndices.resize(m_ColumnOffsets[n]);
+	m_Values.assign(m_ColumnOffsets[n], 0.0);
+	m_DiagonalSlots.resize(n);
+	m_EdgeSlots.resize(edges.size());
+
+	std::vector<uint32_t> cursor(m_ColumnOffsets.begin(), m_ColumnOffsets.end() - 1);
+	for (size_t i = 0; i < n; i++)
+	{
+		uint32_t k = m_InversePermutation[i];
+		m_DiagonalSlots[i] = cursor[k];
+		m_RowIndices[cursor[k]++] = k;
+	}
+	for (size_t s = 0; s < edges.size(); s++)
+	{
+		uint32_t pa = m_InversePermutation[edges[s].a];
+		uint32_t pb = m_InversePermutation[edges[s].b];
+		uint32_t column = std::max(pa, pb);
+		m_EdgeSlots[s] = cursor[column];
+		m_RowIndices[cursor[column]++] = std::min(pa, pb);
+	}
+
+	// Elimination tree and column counts of L
+	m_Parent.assign(n, -1);
+	m_Flags.assign(n, -1);
+	std::vector<uint32_t> counts(n, 0);
+	for (size_t k = 0; k < n; k++)
+	{
+		m_Flags[k] = static_cast<int32_t>(k);
+		for (uint32_t p = m_ColumnOffsets[k]; p < m_ColumnOffsets[k + 1]; p++)
+		{
+			for (uint32_t i = m_RowIndices[p]; m_Flags[i] != static_cast<int32_t>(k);
+				 i = static_cast<uint32_t>(m_Parent[i]))
+			{
+				if (m_Parent[i] == -1) m_Parent[i] = static_cast<int32_t>(k);
+				counts[i]++;
+				m_Flags[i] = static_cast<int32_t>(k);
+			}
+		}
+	}
+
+	m_FactorOffsets.assign(n + 1, 0);
+	for (size_t k = 0; k < n; k++)
+		m_FactorOffsets[k + 1] = m_FactorOffsets[k] + counts[k];
+	m_FactorRows.resize(m_FactorOffsets[n]);
+	m_FactorValues.resize(m_FactorOffsets[n]);
+	m_Diagonal.assign(n, 0.0);
+
+	m_Work.assign(n, 0.0);
+	m_Pattern.assign(n, 0);
+	m_ColumnFill.assign(n, 0);
+	m_Solution.assign(n, glm::dvec3(0.0));
+}
+
+bool SparseCholesky::Factorize(const std::vector<float>& diagonal, const std::vector<float>& offDiagonal)
+{
+	m_Factored = false;
+	size_t n = m_Size;
+	if (diagonal.size() != n || offDiagonal.size() != m_EdgeSlots.size()) return false;
+
+	std::fill(m_Values.begin(), m_Values.end(), 0.0);
+	for (size_t i = 0; i < n; i++)
+		m_Values[m_DiagonalSlots[i]] += diagonal[i];
+	for (size_t s = 0; s < offDiagonal.size(); s++)
+		m_Values[m_EdgeSlots[s]] += offDiagonal[s];
+
+	// Row k of L is the solution of a sparse triangular system whose pattern
+	// is the set of etree paths from the non-zeros of column k of A
+	for (size_t k = 0; k < n; k++)
+	{
+		int32_t flag = static_cast<int32_t>(k);
+		size_t top = n;
+		m_Work[k] = 0.0;
+		m_Flags[k] = flag;
+		m_ColumnFill[k] = 0;
+
+		for (uint32_t p = m_ColumnOffsets[k]; p < m_ColumnOffsets[k + 1]; p++)
+		{
+			uint32_t i = m_RowIndices[p];
+			m_Work[i] += m_Values[p];
+
+			size_t length = 0;
+			for (; m_Flags[i] != flag; i = static_cast<uint32_t>(m_Parent[i]))
+			{
+				m_Pattern[length++] = i;
+				m_Flags[i] = flag;
+			}
+			while (length > 0)
+				m_Pattern[--top] = m_Pattern[--length];
+		}
+
+		double d = m_Work[k];
+		m_Work[k] = 0.0;
+		for (; top < n; top++)
+		{
+			uint32_t i = m_Pattern[top];
+			double yi = m_Work[i];
+			m_Work[i] = 0.0;
+
+			uint32_t end = m_FactorOffsets[i] + m_ColumnFill[i];
+			for (uint32_t p = m_FactorOffsets[i]; p < end; p++)
+				m_Work[m_FactorRows[p]] -= m_FactorValues[p] * yi;
+
+			double lki = yi / m_Diagonal[i];
+			d -= lki * yi;
+			m_FactorRows[end] = static_cast<uint32_t>(k);
+			m_FactorValues[end] = lki;
+			m_ColumnFill[i]++;
+		}
+
+		if (!(d > 0.0))
+		{
+			std::fill(m_Work.begin(), m_Work.end(), 0.0);
+			return false;
+		}
+		m_Diagonal[k] = d;
+	}
+
+	m_Factored = true;
+	return true;
+}
+
+void SparseCholesky::Solve(std::vector<glm::vec3>& b)
+{
+	if (!m_Factored || b.size() != m_Size) return;
+	size_t n = m_Size;
+
+	for (size_t k = 0; k < n; k++)
+		m_Solution[k] = glm::dvec3(b[m_Permutation[k]]);
+
+	// L y = b
+	for (size_t j = 0; j < n; j++)
+	{
+		glm::dvec3 xj = m_Solution[j];
+		for (uint32_t p = m_FactorOffsets[j]; p < m_FactorOffsets[j + 1]; p++)
+			m_Solution[m_FactorRows[p]] -= m_FactorValues[p] * xj;
+	}
+
+	// D z = y
+	for (size_t j = 0; j < n; j++)
+		m_Solution[j] /= m_Diagonal[j];
+
+	// L^T x = z
+	for (size_t j = n; j-- > 0;)
+	{
+		glm::dvec3 xj = m_Solution[j];
+		for (uint32_t p = m_FactorOffsets[j]; p < m_FactorOffsets[j + 1]; p++)
+			xj -= m_FactorValues[p] * m_Solution[m_FactorRows[p]];
+		m_Solution[j] = xj;
+	}
+
+	for (size_t k = 0; k < n; k++)
+		b[m_Permutation[k]] = glm::vec3(m_Solution[k]);
+}
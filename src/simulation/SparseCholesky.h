@@ -0,0 +1,69 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "SpringTopology.h"
+
+// Sparse LDL^T factorization of a symmetric positive definite matrix whose
+// off-diagonal pattern is the spring graph (one scalar entry per spring).
+// Split into the usual two phases:
+//   Analyze   - minimum degree ordering, elimination tree and the column
+//               counts of L; depends on the topology only
+//   Factorize - numeric up-looking factorization (Davis, "LDL", 2005);
+//               cheap enough to redo whenever the matrix values change
+// Solve handles the x, y and z right-hand sides together as one vec3 column.
+class SparseCholesky
+{
+private:
+	size_t m_Size = 0;
+
+	// Fill-reducing permutation: m_Permutation[k] is the original row
+	// eliminated k-th, m_InversePermutation maps back
+	std::vector<uint32_t> m_Permutation;
+	std::vector<uint32_t> m_InversePermutation;
+
+	// Upper triangle of the permuted matrix, compressed by column (diagonal included)
+	std::vector<uint32_t> m_ColumnOffsets;
+	std::vector<uint32_t> m_RowIndices;
+	std::vector<double> m_Values;
+	std::vector<uint32_t> m_DiagonalSlots;   // per original row
+	std::vector<uint32_t> m_EdgeSlots;       // per spring
+
+	// Strict lower triangle of L by column, and D
+	std::vector<int32_t> m_Parent;
+	std::vector<uint32_t> m_FactorOffsets;
+	std::vector<uint32_t> m_FactorRows;
+	std::vector<double> m_FactorValues;
+	std::vector<double> m_Diagonal;
+
+	// Factorization and solve workspace
+	std::vector<double> m_Work;
+	std::vector<uint32_t> m_Pattern;
+	std::vector<int32_t> m_Flags;
+	std::vector<uint32_t> m_ColumnFill;
+	std::vector<glm::dvec3> m_Solution;
+
+	bool m_Factored = false;
+
+public:
+	SparseCholesky() = default;
+
+	// Symbolic phase for an n x n matrix with one off-diagonal pair per edge
+	void Analyze(size_t size, const std::vector<SpringEdge>& edges);
+
+	// Numeric phase: diagonal[i] = A(i, i), offDiagonal[s] = A(a, b) for edge s.
+	// Returns false (and leaves the factor unusable) if a pivot is not positive.
+	bool Factorize(const std::vector<float>& diagonal, const std::vector<float>& offDiagonal);
+
+	// Overwrites b with A^-1 b
+	void Solve(std::vector<glm::vec3>& b);
+
+	inline bool IsFactored() const { return m_Factored; }
+	inline size_t GetSize() const { return m_Size; }
+	// Non-zeros in the strict lower triangle of L (fill included)
+	inline size_t GetFactorNonZeros() const { return m_FactorRows.size(); }
+
+private:
+	void ComputeOrdering(const std::vector<SpringEdge>& edges);
+};
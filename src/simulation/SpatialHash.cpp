@@ -0,0 +1,63 @@
+#include "SpatialHash.h"
+#include <algorithm>
+
+static const size_t ENTRY_GRAIN = 8192;
+static const size_t BUCKET_GRAIN = 8192;
+
+void SpatialHash::SortEntries()
+{
+	size_t bucketCount = static_cast<size_t>(m_BucketMask) + 1;
+	size_t entryCount = m_EntryItems.size();
+
+	if (m_BucketCapacity < bucketCount)
+	{
+		m_BucketCursors.reset(new std::atomic<uint32_t>[bucketCount]);
+		m_BucketCapacity = bucketCount;
+	}
+
+	// Histogram
+	ParallelFor(0, bucketCount, BUCKET_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t b = first; b < last; b++)
+			m_BucketCursors[b].store(0, std::memory_order_relaxed);
+	});
+	ParallelFor(0, entryCount, ENTRY_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t e = first; e < last; e++)
+			m_BucketCursors[m_EntryBuckets[e]].fetch_add(1, std::memory_order_relaxed);
+	});
+
+	// Exclusive prefix sum; the cursors become write positions
+	m_BucketOffsets.resize(bucketCount + 1);
+	uint32_t sum = 0;
+	for (size_t b = 0; b < bucketCount; b++)
+	{
+		m_BucketOffsets[b] = sum;
+		sum += m_BucketCursors[b].load(std::memory_order_relaxed);
+		m_BucketCursors[b].store(m_BucketOffsets[b], std::memory_order_relaxed);
+	}
+	m_BucketOffsets[bucketCount] = sum;
+
+	// Scatter; order inside a bucket depends on thread timing...
+	m_Items.resize(entryCount);
+	ParallelFor(0, entryCount, ENTRY_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t e = first; e < last; e++)
+		{
+			uint32_t slot = m_BucketCursors[m_EntryBuckets[e]].fetch_add(1, std::memory_order_relaxed);
+			m_Items[slot] = m_EntryItems[e];
+		}
+	});
+
+	// ...so each (short) bucket is sorted afterwards
+	ParallelFor(0, bucketCount, BUCKET_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t b = first; b < last; b++)
+		{
+			uint32_t begin = m_BucketOffsets[b];
+			uint32_t end = m_BucketOffsets[b + 1];
+			if (end - begin > 1)
+				std::sort(m_Items.begin() + begin, m_Items.begin() + end);
+		}
+	});
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Parallel.h"
+
+// Hashed uniform grid over axis-aligned boxes (Teschner et al. 2003).
+// Every item is entered into each cell its box overlaps; the (cell, item)
+// entries are then counting-sorted by hash bucket into one flat array, so
+// a query walks a single contiguous range. Build is linear in the number
+// of entries and runs in parallel:
+//   1. per item: count overlapped cells, then write its entries
+//   2. bucket histogram with atomic counters, prefix sum, atomic scatter
+//   3. per bucket: sort by item, which makes the layout deterministic
+// Distinct cells can share a bucket; queries just see a few extra items.
+// Items spanning more than SPATIAL_HASH_MAX_SPAN cells along an axis (an
+// exploded mesh) are left out instead of flooding the table.
+const size_t SPATIAL_HASH_GRAIN = 2048;
+const int SPATIAL_HASH_MAX_SPAN = 32;
+
+class SpatialHash
+{
+private:
+	float m_InverseCellSize = 1.0f;
+	uint32_t m_BucketMask = 0;
+
+	std::vector<uint32_t> m_ItemOffsets;     // first entry of each item
+	std::vector<uint32_t> m_EntryBuckets;
+	std::vector<uint32_t> m_EntryItems;
+
+	std::vector<uint32_t> m_BucketOffsets;   // bucket b owns m_Items[offsets[b] .. offsets[b + 1])
+	std::vector<uint32_t> m_Items;
+	std::unique_ptr<std::atomic<uint32_t>[]> m_BucketCursors;
+	size_t m_BucketCapacity = 0;
+
+public:
+	SpatialHash() = default;
+
+	void SetCellSize(float cellSize) { m_InverseCellSize = 1.0f / cellSize; }
+	inline float GetCellSize() const { return 1.0f / m_InverseCellSize; }
+
+	// bounds(item, min, max) writes the box of each item in [0, itemCount)
+	template <typename Bounds>
+	void Build(size_t itemCount, const Bounds& bounds);
+
+	// Calls fn(item) for every item entered in the bucket of the cell containing point
+	template <typename Fn>
+	void Query(const glm::vec3& point, const Fn& fn) const;
+
+	inline size_t GetEntryCount() const { return m_Items.size(); }
+
+private:
+	inline glm::ivec3 GetCell(const glm::vec3& p) const
+	{
+		return glm::ivec3(glm::floor(p * m_InverseCellSize));
+	}
+
+	inline uint32_t GetBucket(const glm::ivec3& cell) const
+	{
+		uint32_t h = (static_cast<uint32_t>(cell.x) * 73856093u) ^
+					 (static_cast<uint32_t>(cell.y) * 19349663u) ^
+					 (static_cast<uint32_t>(cell.z) * 83492791u);
+		return h & m_BucketMask;
+	}
+
+	void SortEntries();
+};
+
+template <typename Bounds>
+void SpatialHash::Build(size_t itemCount, const Bounds& bounds)
+{
+	m_ItemOffsets.resize(itemCount + 1);
+	m_ItemOffsets[0] = 0;
+
+	ParallelFor(0, itemCount, SPATIAL_HASH_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			glm::vec3 bMin, bMax;
+			bounds(i, bMin, bMax);
+			glm::vec3 span = glm::floor(bMax * m_InverseCellSize) - glm::floor(bMin * m_InverseCellSize) + 1.0f;
+			bool valid = glm::all(glm::greaterThan(span, glm::vec3(0.0f))) &&
+						 glm::all(glm::lessThanEqual(span, glm::vec3(SPATIAL_HASH_MAX_SPAN)));
+			m_ItemOffsets[i + 1] = valid ? static_cast<uint32_t>(span.x * span.y * span.z) : 0;
+		}
+	});
+	for (size_t i = 0; i < itemCount; i++)
+		m_ItemOffsets[i + 1] += m_ItemOffsets[i];
+
+	size_t entryCount = m_ItemOffsets[itemCount];
+	m_EntryBuckets.resize(entryCount);
+	m_EntryItems.resize(entryCount);
+
+	// About two buckets per entry keeps chains short
+	size_t bucketCount = 1;
+	while (bucketCount < 2 * entryCount) bucketCount <<= 1;
+	m_BucketMask = static_cast<uint32_t>(bucketCount - 1);
+
+	ParallelFor(0, itemCount, SPATIAL_HASH_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			if (m_ItemOffsets[i + 1] == m_ItemOffsets[i]) continue;
+
+			glm::vec3 bMin, bMax;
+			bounds(i, bMin, bMax);
+			glm::ivec3 lo = GetCell(bMin);
+			glm::ivec3 hi = GetCell(bMax);
+
+			uint32_t e = m_ItemOffsets[i];
+			for (int z = lo.z; z <= hi.z; z++)
+				for (int y = lo.y; y <= hi.y; y++)
+					for (int x = lo.x; x <= hi.x; x++)
+					{
+						m_EntryBuckets[e] = GetBucket(glm::ivec3(x, y, z));
+						m_EntryItems[e] = static_cast<uint32_t>(i);
+						e++;
+					}
+		}
+	});
+
+	SortEntries();
+}
+
+template <typename Fn>
+void SpatialHash::Query(const glm::vec3& point, const Fn& fn) const
+{
+	if (m_BucketOffsets.empty()) return;
+
+	uint32_t bucket = GetBucket(GetCell(point));
+	for (uint32_t k = m_BucketOffsets[bucket]; k < m_BucketOffsets[bucket + 1]; k++)
+		fn(m_Items[k]);
+}
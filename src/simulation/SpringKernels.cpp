@@ -0,0 +1,331 @@
+#include "SpringKernels.h"
+#include "SimdSupport.h"
+#include <cmath>
+
+// NOTE: this file is compiled with floating-point contraction disabled (see
+// CMakeLists.txt) so no path silently fuses a multiply-add and the vector
+// results stay bit-identical to the scalar reference below.
+
+void SpringKernels::EvaluateScalar(const glm::vec3* positions, const glm::vec3* velocities,
+								   const SpringEdge* edges, const float* restLengths,
+								   const float* stiffness, const float* damping,
+								   size_t first, size_t last, glm::vec3* out)
+{
+	for (size_t s = first; s < last; s++)
+	{
+		const glm::vec3& pa = positions[edges[s].a];
+		const glm::vec3& pb = positions[edges[s].b];
+		const glm::vec3& va = velocities[edges[s].a];
+		const glm::vec3& vb = velocities[edges[s].b];
+
+		float dx = pa.x - pb.x;
+		float dy = pa.y - pb.y;
+		float dz = pa.z - pb.z;
+		float dist = std::sqrt((dx * dx + dy * dy) + dz * dz);
+
+		if (dist == 0.0f)
+		{
+			out[s] = glm::vec3(0.0f);
+			continue;
+		}
+
+		float inv = 1.0f / dist;
+		float nx = dx * inv;
+		float ny = dy * inv;
+		float nz = dz * inv;
+
+		float rx = va.x - vb.x;
+		float ry = va.y - vb.y;
+		float rz = va.z - vb.z;
+		float proj = (rx * nx + ry * ny) + rz * nz;
+
+		float magnitude = (dist - restLengths[s]) * stiffness[s] + proj * damping[s];
+		out[s] = glm::vec3(nx * magnitude, ny * magnitude, nz * magnitude);
+	}
+}
+
+#if SOFTBODY_X86
+
+// SSE4.2: 4 springs per iteration. There is no hardware gather, so each
+// endpoint is loaded as one xyz register and four of them are transposed
+// into x/y/z lanes.
+SOFTBODY_TARGET("sse4.2")
+static inline __m128 LoadVec3(const glm::vec3& v)
+{
+	// Never reads past the vec3 (a 16-byte load could run off the array end)
+	__m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(&v.x)));
+	return _mm_insert_ps(xy, _mm_load_ss(&v.z), 0x20);
+}
+
+SOFTBODY_TARGET("sse4.2")
+static void EvaluateSSE42(const glm::vec3* positions, const glm::vec3* velocities,
+						  const SpringEdge* edges, const float* restLengths,
+						  const float* stiffness, const float* damping,
+						  size_t first, size_t last, glm::vec3* out)
+{
+	alignas(16) float f[4][4];
+
+	size_t s = first;
+	for (; s + 4 <= last; s += 4)
+	{
+		const SpringEdge* e = edges + s;
+
+		__m128 dx = _mm_sub_ps(LoadVec3(positions[e[0].a]), LoadVec3(positions[e[0].b]));
+		__m128 dy = _mm_sub_ps(LoadVec3(positions[e[1].a]), LoadVec3(positions[e[1].b]));
+		__m128 dz = _mm_sub_ps(LoadVec3(positions[e[2].a]), LoadVec3(positions[e[2].b]));
+		__m128 dw = _mm_sub_ps(LoadVec3(positions[e[3].a]), LoadVec3(positions[e[3].b]));
+		_MM_TRANSPOSE4_PS(dx, dy, dz, dw);
+
+		__m128 rx = _mm_sub_ps(LoadVec3(velocities[e[0].a]), LoadVec3(velocities[e[0].b]));
+		__m128 ry = _mm_sub_ps(LoadVec3(velocities[e[1].a]), LoadVec3(velocities[e[1].b]));
+		__m128 rz = _mm_sub_ps(LoadVec3(velocities[e[2].a]), LoadVec3(velocities[e[2].b]));
+		__m128 rw = _mm_sub_ps(LoadVec3(velocities[e[3].a]), LoadVec3(velocities[e[3].b]));
+		_MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+
+		__m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		__m128 dist = _mm_sqrt_ps(d2);
+		__m128 valid = _mm_cmpneq_ps(dist, _mm_setzero_ps());
+
+		__m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), dist);
+		__m128 nx = _mm_mul_ps(dx, inv);
+		__m128 ny = _mm_mul_ps(dy, inv);
+		__m128 nz = _mm_mul_ps(dz, inv);
+		__m128 proj = _mm_add_ps(_mm_add_ps(_mm_mul_ps(rx, nx), _mm_mul_ps(ry, ny)), _mm_mul_ps(rz, nz));
+
+		__m128 stretch = _mm_mul_ps(_mm_sub_ps(dist, _mm_loadu_ps(restLengths + s)), _mm_loadu_ps(stiffness + s));
+		__m128 magnitude = _mm_and_ps(valid, _mm_add_ps(stretch, _mm_mul_ps(proj, _mm_loadu_ps(damping + s))));
+
+		__m128 fx = _mm_and_ps(valid, _mm_mul_ps(nx, magnitude));
+		__m128 fy = _mm_and_ps(valid, _mm_mul_ps(ny, magnitude));
+		__m128 fz = _mm_and_ps(valid, _mm_mul_ps(nz, magnitude));
+		__m128 fw = _mm_setzero_ps();
+		_MM_TRANSPOSE4_PS(fx, fy, fz, fw);
+		_mm_store_ps(f[0], fx);
+		_mm_store_ps(f[1], fy);
+		_mm_store_ps(f[2], fz);
+		_mm_store_ps(f[3], fw);
+
+		for (int j = 0; j < 4; j++)
+			out[s + j] = glm::vec3(f[j][0], f[j][1], f[j][2]);
+	}
+
+	SpringKernels::EvaluateScalar(positions, velocities, edges, restLengths,
+								  stiffness, damping, s, last, out);
+}
+
+// AVX2: 8 springs per iteration with hardware gathers on the flat
+// xyz float arrays (particle i lives at float offset 3*i).
+SOFTBODY_TARGET("avx2")
+static void EvaluateAVX2(const glm::vec3* positions, const glm::vec3* velocities,
+						 const SpringEdge* edges, const float* restLengths,
+						 const float* stiffness, const float* damping,
+						 size_t first, size_t last, glm::vec3* out)
+{
+	const float* pos = &positions[0].x;
+	const float* vel = &velocities[0].x;
+	alignas(32) int ia[8], ib[8];
+	alignas(32) float f[3][8];
+
+	size_t s = first;
+	for (; s + 8 <= last; s += 8)
+	{
+		for (int j = 0; j < 8; j++)
+		{
+			ia[j] = static_cast<int>(edges[s + j].a * 3);
+			ib[j] = static_cast<int>(edges[s + j].b * 3);
+		}
+		__m256i a0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(ia));
+		__m256i b0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(ib));
+		__m256i one = _mm256_set1_epi32(1);
+		__m256i a1 = _mm256_add_epi32(a0, one), a2 = _mm256_add_epi32(a1, one);
+		__m256i b1 = _mm256_add_epi32(b0, one), b2 = _mm256_add_epi32(b1, one);
+
+		__m256 dx = _mm256_sub_ps(_mm256_i32gather_ps(pos, a0, 4), _mm256_i32gather_ps(pos, b0, 4));
+		__m256 dy = _mm256_sub_ps(_mm256_i32gather_ps(pos, a1, 4), _mm256_i32gather_ps(pos, b1, 4));
+		__m256 dz = _mm256_sub_ps(_mm256_i32gather_ps(pos, a2, 4), _mm256_i32gather_ps(pos, b2, 4));
+		__m256 d2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+		__m256 dist = _mm256_sqrt_ps(d2);
+		__m256 valid = _mm256_cmp_ps(dist, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+
+		__m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), dist);
+		__m256 nx = _mm256_mul_ps(dx, inv);
+		__m256 ny = _mm256_mul_ps(dy, inv);
+		__m256 nz = _mm256_mul_ps(dz, inv);
+
+		__m256 rx = _mm256_sub_ps(_mm256_i32gather_ps(vel, a0, 4), _mm256_i32gather_ps(vel, b0, 4));
+		__m256 ry = _mm256_sub_ps(_mm256_i32gather_ps(vel, a1, 4), _mm256_i32gather_ps(vel, b1, 4));
+		__m256 rz = _mm256_sub_ps(_mm256_i32gather_ps(vel, a2, 4), _mm256_i32gather_ps(vel, b2, 4));
+		__m256 proj = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(rx, nx), _mm256_mul_ps(ry, ny)), _mm256_mul_ps(rz, nz));
+
+		__m256 stretch = _mm256_mul_ps(_mm256_sub_ps(dist, _mm256_loadu_ps(restLengths + s)), _mm256_loadu_ps(stiffness + s));
+		__m256 magnitude = _mm256_and_ps(valid, _mm256_add_ps(stretch, _mm256_mul_ps(proj, _mm256_loadu_ps(damping + s))));
+
+		_mm256_store_ps(f[0], _mm256_and_ps(valid, _mm256_mul_ps(nx, magnitude)));
+		_mm256_store_ps(f[1], _mm256_and_ps(valid, _mm256_mul_ps(ny, magnitude)));
+		_mm256_store_ps(f[2], _mm256_and_ps(valid, _mm256_mul_ps(nz, magnitude)));
+
+		for (int j = 0; j < 8; j++)
+			out[s + j] = glm::vec3(f[0][j], f[1][j], f[2][j]);
+	}
+
+	SpringKernels::EvaluateScalar(positions, velocities, edges, restLengths,
+								  stiffness, damping, s, last, out);
+}
+
+// AVX-512: 16 springs per iteration, gathers in and scatters out.
+SOFTBODY_TARGET("avx512f")
+static void EvaluateAVX512(const glm::vec3* positions, const glm::vec3* velocities,
+						   const SpringEdge* edges, const float* restLengths,
+						   const float* stiffness, const float* damping,
+						   size_t first, size_t last, glm::vec3* out)
+{
+	const float* pos = &positions[0].x;
+	const float* vel = &velocities[0].x;
+	float* dst = &out[0].x;
+	alignas(64) int ia[16], ib[16];
+
+	const __m512i lane3 = _mm512_mullo_epi32(
+		_mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), _mm512_set1_epi32(3));
+	const __m512i one = _mm512_set1_epi32(1);
+
+	size_t s = first;
+	for (; s + 16 <= last; s += 16)
+	{
+		for (int j = 0; j < 16; j++)
+		{
+			ia[j] = static_cast<int>(edges[s + j].a * 3);
+			ib[j] = static_cast<int>(edges[s + j].b * 3);
+		}
+		__m512i a0 = _mm512_load_si512(ia);
+		__m512i b0 = _mm512_load_si512(ib);
+		__m512i a1 = _mm512_add_epi32(a0, one), a2 = _mm512_add_epi32(a1, one);
+		__m512i b1 = _mm512_add_epi32(b0, one), b2 = _mm512_add_epi32(b1, one);
+
+		__m512 dx = _mm512_sub_ps(_mm512_i32gather_ps(a0, pos, 4), _mm512_i32gather_ps(b0, pos, 4));
+		__m512 dy = _mm512_sub_ps(_mm512_i32gather_ps(a1, pos, 4), _mm512_i32gather_ps(b1, pos, 4));
+		__m512 dz = _mm512_sub_ps(_mm512_i32gather_ps(a2, pos, 4), _mm512_i32gather_ps(b2, pos, 4));
+		__m512 d2 = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)), _mm512_mul_ps(dz, dz));
+		__m512 dist = _mm512_sqrt_ps(d2);
+		__mmask16 valid = _mm512_cmp_ps_mask(dist, _mm512_setzero_ps(), _CMP_NEQ_UQ);
+
+		__m512 inv = _mm512_div_ps(_mm512_set1_ps(1.0f), dist);
+		__m512 nx = _mm512_mul_ps(dx, inv);
+		__m512 ny = _mm512_mul_ps(dy, inv);
+		__m512 nz = _mm512_mul_ps(dz, inv);
+
+		__m512 rx = _mm512_sub_ps(_mm512_i32gather_ps(a0, vel, 4), _mm512_i32gather_ps(b0, vel, 4));
+		__m512 ry = _mm512_sub_ps(_mm512_i32gather_ps(a1, vel, 4), _mm512_i32gather_ps(b1, vel, 4));
+		__m512 rz = _mm512_sub_ps(_mm512_i32gather_ps(a2, vel, 4), _mm512_i32gather_ps(b2, vel, 4));
+		__m512 proj = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(rx, nx), _mm512_mul_ps(ry, ny)), _mm512_mul_ps(rz, nz));
+
+		__m512 stretch = _mm512_mul_ps(_mm512_sub_ps(dist, _mm512_loadu_ps(restLengths + s)), _mm512_loadu_ps(stiffness + s));
+		__m512 magnitude = _mm512_maskz_add_ps(valid, stretch, _mm512_mul_ps(proj, _mm512_loadu_ps(damping + s)));
+
+		__m512i o0 = _mm512_add_epi32(lane3, _mm512_set1_epi32(static_cast<int>(s * 3)));
+		__m512i o1 = _mm512_add_epi32(o0, one), o2 = _mm512_add_epi32(o1, one);
+		_mm512_i32scatter_ps(dst, o0, _mm512_maskz_mul_ps(valid, nx, magnitude), 4);
+		_mm512_i32scatter_ps(dst, o1, _mm512_maskz_mul_ps(valid, ny, magnitude), 4);
+		_mm512_i32scatter_ps(dst, o2, _mm512_maskz_mul_ps(valid, nz, magnitude), 4);
+	}
+
+	SpringKernels::EvaluateScalar(positions, velocities, edges, restLengths,
+								  stiffness, damping, s, last, out);
+}
+
+static void CpuId(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	int r[4];
+	__cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+	for (int i = 0; i < 4; i++) regs[i] = static_cast<unsigned int>(r[i]);
+#else
+	__cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static unsigned long long XGetBV()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	return _xgetbv(0);
+#else
+	unsigned int lo, hi;
+	__asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return (static_cast<unsigned long long>(hi) << 32) | lo;
+#endif
+}
+
+#endif // SOFTBODY_X86
+
+static SimdLevel DetectLevel()
+{
+#if SOFTBODY_X86
+	unsigned int regs[4];
+	CpuId(0, 0, regs);
+	unsigned int maxLeaf = regs[0];
+
+	CpuId(1, 0, regs);
+	bool sse42 = (regs[2] & (1u << 20)) != 0;
+	bool osxsave = (regs[2] & (1u << 27)) != 0;
+	bool avx = (regs[2] & (1u << 28)) != 0;
+	if (!sse42) return SimdLevel::Scalar;
+
+	// The OS must save the wider register state before AVX/AVX-512 are usable
+	unsigned long long xcr0 = (osxsave && avx) ? XGetBV() : 0;
+	bool ymmState = (xcr0 & 0x6) == 0x6;
+	bool zmmState = (xcr0 & 0xe6) == 0xe6;
+
+	if (maxLeaf >= 7)
+	{
+		CpuId(7, 0, regs);
+		bool avx2 = (regs[1] & (1u << 5)) != 0;
+		bool avx512f = (regs[1] & (1u << 16)) != 0;
+
+		if (avx512f && zmmState) return SimdLevel::AVX512;
+		if (avx2 && ymmState) return SimdLevel::AVX2;
+	}
+	return SimdLevel::SSE42;
+#else
+	return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel SpringKernels::GetActiveLevel()
+{
+	static const SimdLevel level = DetectLevel();
+	return level;
+}
+
+const char* SpringKernels::GetLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SSE42:  return "SSE4.2";
+	case SimdLevel::AVX2:   return "AVX2";
+	case SimdLevel::AVX512: return "AVX-512";
+	default:                return "Scalar";
+	}
+}
+
+void SpringKernels::Evaluate(const glm::vec3* positions, const glm::vec3* velocities,
+							 const SpringEdge* edges, const float* restLengths,
+							 const float* stiffness, const float* damping,
+							 size_t first, size_t last, glm::vec3* out)
+{
+	switch (GetActiveLevel())
+	{
+#if SOFTBODY_X86
+	case SimdLevel::AVX512:
+		EvaluateAVX512(positions, velocities, edges, restLengths, stiffness, damping, first, last, out);
+		return;
+	case SimdLevel::AVX2:
+		EvaluateAVX2(positions, velocities, edges, restLengths, stiffness, damping, first, last, out);
+		return;
+	case SimdLevel::SSE42:
+		EvaluateSSE42(positions, velocities, edges, restLengths, stiffness, damping, first, last, out);
+		return;
+#endif
+	default:
+		EvaluateScalar(positions, velocities, edges, restLengths, stiffness, damping, first, last, out);
+		return;
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "SpringTopology.h"
+
+enum class SimdLevel { Scalar, SSE42, AVX2, AVX512 };
+
+// Vectorized spring + damping force evaluation (paper Eq. 2 & 3).
+// For every spring s = (a, b) the kernels write the force acting on b into
+// out[s]; a receives -out[s]. The instruction set is picked once at runtime
+// via cpuid, and every path performs the same IEEE operations in the same
+// order, so all of them produce bit-identical results to EvaluateScalar.
+class SpringKernels
+{
+public:
+	static void Evaluate(const glm::vec3* positions, const glm::vec3* velocities,
+						 const SpringEdge* edges, const float* restLengths,
+						 const float* stiffness, const float* damping,
+						 size_t first, size_t last, glm::vec3* out);
+
+	// Portable reference path (also used for the remainder of each batch)
+	static void EvaluateScalar(const glm::vec3* positions, const glm::vec3* velocities,
+							   const SpringEdge* edges, const float* restLengths,
+							   const float* stiffness, const float* damping,
+							   size_t first, size_t last, glm::vec3* out);
+
+	static SimdLevel GetActiveLevel();
+	static const char* GetLevelName(SimdLevel level);
+};
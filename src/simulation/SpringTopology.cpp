@@ -0,0 +1,78 @@
+#include "SpringTopology.h"
+#include <algorithm>
+#include <cstdint>
+
+void SpringTopology::Build(const std::vector<Triangle>& triangles, const ParticleStore& particles)
+{
+	// Encode each edge as a 64-bit key (low index in the high word) so a plain
+	// sort groups duplicates together and yields a cache-friendly order.
+	std::vector<uint64_t> keys;
+	keys.reserve(triangles.size() * 3);
+	for (const auto& tri : triangles)
+	{
+		for (int e = 0; e < 3; ++e)
+		{
+			uint64_t i = tri.vertex[e];
+			uint64_t j = tri.vertex[(e + 1) % 3];
+			if (i == j) continue;
+			if (i > j) std::swap(i, j);
+			keys.push_back((i << 32) | j);
+		}
+	}
+	std::sort(keys.begin(), keys.end());
+
+	m_Edges.clear();
+	m_RestLengths.clear();
+	m_Weights.clear();
+
+	const auto& positions = particles.GetPositions();
+	for (size_t k = 0; k < keys.size(); )
+	{
+		size_t run = k + 1;
+		while (run < keys.size() && keys[run] == keys[k]) ++run;
+
+		SpringEdge edge;
+		edge.a = static_cast<ParticleId>(keys[k] >> 32);
+		edge.b = static_cast<ParticleId>(keys[k] & 0xffffffffu);
+
+		m_Edges.push_back(edge);
+		m_RestLengths.push_back(glm::length(positions[edge.a] - positions[edge.b]));
+		m_Weights.push_back(static_cast<float>(run - k));
+
+		k = run;
+	}
+
+	// Incident-spring lists for the per-particle force gather
+	std::vector<uint32_t> rows, entries;
+	rows.reserve(m_Edges.size() * 2);
+	entries.reserve(m_Edges.size() * 2);
+	for (size_t s = 0; s < m_Edges.size(); ++s)
+	{
+		uint32_t id = static_cast<uint32_t>(s) << 1;
+		rows.push_back(m_Edges[s].a); entries.push_back(id);
+		rows.push_back(m_Edges[s].b); entries.push_back(id | 1u);
+	}
+	m_ParticleSprings.Build(particles.Size(), rows, entries);
+
+	m_SpringForces.assign(m_Edges.size(), glm::vec3(0.0f));
+	m_Stiffness.assign(m_Edges.size(), 0.0f);
+	m_Damping.assign(m_Edges.size(), 0.0f);
+	for (size_t i = 0; i < m_Edges.size(); ++i)
+	{
+		m_Stiffness[i] = m_UniformStiffness * m_Weights[i];
+		m_Damping[i] = m_UniformDamping * m_Weights[i];
+	}
+}
+
+void SpringTopology::SetUniformCoefficients(float springK, float dampingK)
+{
+	if (springK == m_UniformStiffness && dampingK == m_UniformDamping) return;
+
+	m_UniformStiffness = springK;
+	m_UniformDamping = dampingK;
+	for (size_t i = 0; i < m_Edges.size(); ++i)
+	{
+		m_Stiffness[i] = springK * m_Weights[i];
+		m_Damping[i] = dampingK * m_Weights[i];
+	}
+}
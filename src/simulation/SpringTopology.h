@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "ParticleStore.h"
+#include "Geometry.h"
+#include "CsrAdjacency.h"
+
+const float SPRING_CONSTANT = 200.0f;
+const float DAMPING_CONSTANT = 2.0f;
+
+// A spring is just the pair of particle indices it connects (a < b)
+struct SpringEdge
+{
+	ParticleId a;
+	ParticleId b;
+};
+
+// Flat, deduplicated spring network built once per mesh.
+// Every unique triangle edge becomes exactly one spring; edges shared by
+// several faces keep that multiplicity as a weight so the combined
+// stiffness/damping matches one spring per face edge.
+class SpringTopology
+{
+private:
+	std::vector<SpringEdge> m_Edges;
+	std::vector<float> m_RestLengths;
+	std::vector<float> m_Stiffness;
+	std::vector<float> m_Damping;
+	std::vector<float> m_Weights;
+
+	// Per-spring force on endpoint b (a gets the negation), filled by the kernels
+	std::vector<glm::vec3> m_SpringForces;
+
+	// Particle -> incident springs; each entry is (springIndex << 1) | isEndB
+	CsrAdjacency m_ParticleSprings;
+
+	float m_UniformStiffness = SPRING_CONSTANT;
+	float m_UniformDamping = DAMPING_CONSTANT;
+
+public:
+	SpringTopology() = default;
+
+	// Sort-based edge builder: emits each undirected triangle edge once
+	void Build(const std::vector<Triangle>& triangles, const ParticleStore& particles);
+
+	// Rescale every spring from the global k / c (no-op if unchanged)
+	void SetUniformCoefficients(float springK, float dampingK);
+
+	inline size_t Size() const { return m_Edges.size(); }
+	inline const std::vector<SpringEdge>& GetEdges() const { return m_Edges; }
+	inline const std::vector<float>& GetRestLengths() const { return m_RestLengths; }
+	inline const std::vector<float>& GetStiffness() const { return m_Stiffness; }
+	inline const std::vector<float>& GetDamping() const { return m_Damping; }
+	inline const std::vector<float>& GetWeights() const { return m_Weights; }
+	inline std::vector<glm::vec3>& GetSpringForces() { return m_SpringForces; }
+	inline const CsrAdjacency& GetParticleSprings() const { return m_ParticleSprings; }
+};
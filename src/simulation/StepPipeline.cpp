@@ -0,0 +1,296 @@
+#include "StepPipeline.h"
+#include "PhysicsEngine.h"
+#include "Parallel.h"
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+static const size_t PARTICLE_GRAIN = 2048;
+
+// Key layout: (integrator * VOLUME_COUNT + volume) * TERM_MASKS + terms
+static const int GRAVITY_TERM = 1;
+static const int EXTERNAL_TERM = 2;
+static const int SPRING_TERM = 4;
+static const int PRESSURE_TERM = 8;
+static constexpr int TERM_MASKS = 16;
+static constexpr int VOLUME_COUNT = 4;
+static constexpr int PIPELINED_INTEGRATORS = 5;
+static constexpr int INTEGRATOR_COUNT = PIPELINED_INTEGRATORS + 1;   // last: not pipelined
+static constexpr int FORCE_KEYS = VOLUME_COUNT * TERM_MASKS;
+static constexpr int KEY_COUNT = INTEGRATOR_COUNT * FORCE_KEYS;
+
+// --- Force terms ---
+// Constructed once per evaluation (any per-element pre-pass runs in the
+// constructor); Gather(i, f) adds the term's force on particle i to f.
+
+struct NoTerm
+{
+	explicit NoTerm(StepContext&) {}
+	inline void Gather(size_t, glm::vec3&) const {}
+};
+
+// Eq. 1: F_gi = m_i * g
+class GravityTerm
+{
+private:
+	const ParticleStore& m_Particles;
+	float m_Gravity;
+
+public:
+	explicit GravityTerm(StepContext& ctx)
+		: m_Particles(ctx.particles), m_Gravity(ctx.params.gravityStrength) {}
+
+	inline void Gather(size_t i, glm::vec3& f) const
+	{
+		f += glm::vec3(0.0f, m_Particles.GetMass(static_cast<ParticleId>(i)) * m_Gravity, 0.0f);
+	}
+};
+
+class ExternalTerm
+{
+private:
+	glm::vec3 m_Force;
+
+public:
+	explicit ExternalTerm(StepContext& ctx) : m_Force(ctx.params.externalForce) {}
+
+	inline void Gather(size_t, glm::vec3& f) const { f += m_Force; }
+};
+
+// Eq. 2 & 3: per-spring kernels first, then the CSR gather per particle
+class SpringTerm
+{
+private:
+	const std::vector<glm::vec3>& m_SpringForces;
+	const CsrAdjacency& m_Adjacency;
+
+public:
+	explicit SpringTerm(StepContext& ctx)
+		: m_SpringForces(ctx.springs.GetSpringForces()), m_Adjacency(ctx.springs.GetParticleSprings())
+	{
+		if (ctx.springs.Size() > 0)
+			PhysicsEngine::EvaluateSpringForces(ctx.particles, ctx.springs);
+	}
+
+	inline void Gather(size_t i, glm::vec3& f) const
+	{
+		glm::vec3 sum(0.0f);
+		for (uint32_t k = m_Adjacency.RowBegin(i); k < m_Adjacency.RowEnd(i); k++)
+		{
+			uint32_t entry = m_Adjacency.entries[k];
+			const glm::vec3& s = m_SpringForces[entry >> 1];
+			if (entry & 1u) sum += s;
+			else            sum -= s;
+		}
+		f += sum;
+	}
+};
+
+// Eq. 5 & 6: the fused face pass, the Volume policy's volume and the
+// pressure, then the per-vertex face gather (which also gives the normals)
+template <typename Volume>
+class PressureTerm
+{
+private:
+	const CsrAdjacency& m_Adjacency;
+	const std::vector<glm::vec3>& m_FaceVectors;
+	std::vector<glm::vec3>& m_Normals;
+	float m_Pressure;
+
+public:
+	explicit PressureTerm(StepContext& ctx)
+		: m_Adjacency(ctx.surface.GetVertexFaces()), m_FaceVectors(ctx.surface.GetFaceVectors()),
+		  m_Normals(ctx.surface.GetVertexNormals())
+	{
+		ctx.exactVolume = PhysicsEngine::ComputeSurface(ctx.params.precision, ctx.particles, ctx.surface);
+		ctx.volume = Volume::Compute(ctx);
+		ctx.pressure = PhysicsEngine::CalculatePressure(ctx.volume, ctx.params.moles);
+		m_Pressure = ctx.pressure;
+	}
+
+	inline void Gather(size_t i, glm::vec3& f) const
+	{
+		glm::vec3 sum(0.0f);
+		for (uint32_t k = m_Adjacency.RowBegin(i); k < m_Adjacency.RowEnd(i); k++)
+			sum += m_FaceVectors[m_Adjacency.entries[k]];
+
+		f += m_Pressure * sum;
+		float length = glm::length(sum);
+		m_Normals[i] = (length > 0.0f) ? sum / length : glm::vec3(0.0f);
+	}
+};
+
+// Net force = Σ terms, in one pass that overwrites the store's forces
+template <typename... Terms>
+struct ForceSet
+{
+	static void Evaluate(StepContext& ctx)
+	{
+		// Braced initialization runs the constructors (pre-passes) in order
+		std::tuple<Terms...> terms{ Terms(ctx)... };
+
+		auto& forces = ctx.particles.GetForces();
+		ParallelFor(0, ctx.particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				glm::vec3 f(0.0f);
+				std::apply([&](const Terms&... term) { (term.Gather(i, f), ...); }, terms);
+				forces[i] = f;
+			}
+		});
+	}
+};
+
+// --- Volume methods (pressure only) ---
+
+struct ExactVolume
+{
+	static float Compute(const StepContext& ctx) { return ctx.exactVolume; }
+};
+
+template <float (*Formula)(const glm::vec3&, const glm::vec3&)>
+struct BoundsVolume
+{
+	static float Compute(const StepContext& ctx)
+	{
+		const auto& positions = ctx.particles.GetPositions();
+		if (positions.empty()) return 0.0f;
+
+		glm::vec3 bbMin = positions[0];
+		glm::vec3 bbMax = positions[0];
+		for (size_t i = 1; i < positions.size(); i++)
+		{
+			bbMin = glm::min(bbMin, positions[i]);
+			bbMax = glm::max(bbMax, positions[i]);
+		}
+		return Formula(bbMin, bbMax);
+	}
+};
+
+// Indexed by VolumeMethod
+using VolumePolicies = std::tuple<
+	BoundsVolume<&PhysicsEngine::CalculateAABBVolume>,
+	BoundsVolume<&PhysicsEngine::CalculateBoundingSphereVolume>,
+	BoundsVolume<&PhysicsEngine::CalculateBoundingEllipsoidVolume>,
+	ExactVolume>;
+
+template <int Terms, typename Volume>
+using ForcesFor = ForceSet<
+	std::conditional_t<(Terms & GRAVITY_TERM) != 0, GravityTerm, NoTerm>,
+	std::conditional_t<(Terms & EXTERNAL_TERM) != 0, ExternalTerm, NoTerm>,
+	std::conditional_t<(Terms & SPRING_TERM) != 0, SpringTerm, NoTerm>,
+	std::conditional_t<(Terms & PRESSURE_TERM) != 0, PressureTerm<Volume>, NoTerm>>;
+
+// --- Integrators ---
+
+template <ExplicitScheme Scheme>
+struct ExplicitStep
+{
+	template <typename Forces>
+	static void Run(StepContext& ctx, float dt)
+	{
+		ctx.integrator.Step<Scheme>(ctx.particles, dt, [&]() { Forces::Evaluate(ctx); });
+	}
+};
+
+// Springs/damping are integrated implicitly; the other terms enter the
+// right-hand side as-is
+struct ImplicitStep
+{
+	template <typename Forces>
+	static void Run(StepContext& ctx, float dt)
+	{
+		Forces::Evaluate(ctx);
+		PhysicsEngine::IntegrateImplicit(ctx.particles, ctx.springs, ctx.implicitSolver, dt);
+	}
+};
+
+// Indexed like GetIntegratorIndex
+using IntegratorPolicies = std::tuple<
+	ExplicitStep<ExplicitScheme::SymplecticEuler>,
+	ExplicitStep<ExplicitScheme::Midpoint>,
+	ExplicitStep<ExplicitScheme::VelocityVerlet>,
+	ExplicitStep<ExplicitScheme::RK4>,
+	ImplicitStep>;
+
+template <typename Integrator, typename Forces>
+static void RunStep(StepContext& ctx, const ColliderBox& localCollider, float dt)
+{
+	Integrator::template Run<Forces>(ctx, dt);
+	PhysicsEngine::ResolveCollisions(ctx.particles, localCollider);
+}
+
+// --- Instantiation tables ---
+
+template <int ForceKey>
+using ForcesForKey = ForcesFor<ForceKey % TERM_MASKS,
+							   std::tuple_element_t<ForceKey / TERM_MASKS, VolumePolicies>>;
+
+template <int Key>
+static constexpr StepPipeline::StepFunction GetStepFunction()
+{
+	constexpr int integrator = Key / FORCE_KEYS;
+	if constexpr (integrator < PIPELINED_INTEGRATORS)
+		return &RunStep<std::tuple_element_t<integrator, IntegratorPolicies>, ForcesForKey<Key % FORCE_KEYS>>;
+	else
+		return nullptr;
+}
+
+template <int... Keys>
+static constexpr std::array<StepPipeline::EvaluateFunction, sizeof...(Keys)>
+MakeEvaluateTable(std::integer_sequence<int, Keys...>)
+{
+	return { &ForcesForKey<Keys>::Evaluate... };
+}
+
+template <int... Keys>
+static constexpr std::array<StepPipeline::StepFunction, sizeof...(Keys)>
+MakeStepTable(std::integer_sequence<int, Keys...>)
+{
+	return { GetStepFunction<Keys>()... };
+}
+
+static constexpr auto EVALUATE_TABLE = MakeEvaluateTable(std::make_integer_sequence<int, FORCE_KEYS>());
+static constexpr auto STEP_TABLE = MakeStepTable(std::make_integer_sequence<int, KEY_COUNT>());
+
+static int GetIntegratorIndex(IntegrationMethod method)
+{
+	switch (method)
+	{
+	case IntegrationMethod::ForwardEuler:   return 0;
+	case IntegrationMethod::Midpoint:       return 1;
+	case IntegrationMethod::VelocityVerlet: return 2;
+	case IntegrationMethod::RK4:            return 3;
+	case IntegrationMethod::ImplicitEuler:  return 4;
+	default:                                return PIPELINED_INTEGRATORS;
+	}
+}
+
+int StepPipeline::GetKey(const SimulationParams& params)
+{
+	int terms = 0;
+	if (params.gravityStrength != 0.0f) terms |= GRAVITY_TERM;
+	if (params.externalForce != glm::vec3(0.0f)) terms |= EXTERNAL_TERM;
+	if (params.springConstant != 0.0f || params.dampingConstant != 0.0f) terms |= SPRING_TERM;
+	if (params.moles != 0) terms |= PRESSURE_TERM;
+
+	int volume = static_cast<int>(params.volumeMethod);
+	return (GetIntegratorIndex(params.integrationMethod) * VOLUME_COUNT + volume) * TERM_MASKS + terms;
+}
+
+StepPipeline::EvaluateFunction StepPipeline::SelectEvaluate(int key)
+{
+	return EVALUATE_TABLE[key % FORCE_KEYS];
+}
+
+StepPipeline::StepFunction StepPipeline::SelectStep(int key)
+{
+	return STEP_TABLE[key];
+}
+
+bool StepPipeline::HasPressure(int key)
+{
+	return ((key % TERM_MASKS) & PRESSURE_TERM) != 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ParticleStore.h"
+#include "SpringTopology.h"
+#include "SurfaceTopology.h"
+#include "ExplicitIntegrator.h"
+#include "ImplicitSolver.h"
+#include "ColliderBox.h"
+#include "SimulationParams.h"
+
+// State one pipelined step reads and writes. The outputs are only valid
+// for the terms the selected pipeline contains.
+struct StepContext
+{
+	ParticleStore& particles;
+	SpringTopology& springs;
+	SurfaceTopology& surface;
+	ExplicitIntegrator& integrator;
+	ImplicitSolver& implicitSolver;
+	const SimulationParams& params;
+
+	float volume = 0.0f;        // active volume method
+	float exactVolume = 0.0f;   // divergence theorem, from the pressure face pass
+	float pressure = 0.0f;
+};
+
+// Force evaluation and fixed-step integration composed at compile time.
+// Every force term (gravity, external, springs, pressure), the volume
+// method feeding the pressure and the integrator is a policy type; each
+// combination is instantiated once, with terms that are zero or disabled
+// left out entirely and the per-particle work of all remaining terms fused
+// into one gather loop that writes the net force (no separate clear pass).
+// Select() maps the current SimulationParams onto the matching
+// instantiation; callers reselect only when GetKey() changes.
+class StepPipeline
+{
+public:
+	// Recomputes the store's forces for its current state
+	using EvaluateFunction = void (*)(StepContext& ctx);
+	// One fixed step of `dt` including the collider response
+	using StepFunction = void (*)(StepContext& ctx, const ColliderBox& localCollider, float dt);
+
+	// Index of the instantiation the params select (cheap, call every frame)
+	static int GetKey(const SimulationParams& params);
+
+	static EvaluateFunction SelectEvaluate(int key);
+
+	// Null for methods that are not fixed-step pipelines (adaptive RK23,
+	// XPBD, Projective Dynamics); those only use the evaluate function
+	static StepFunction SelectStep(int key);
+
+	// True if the key's forces contain the pressure term, which also
+	// refreshes the exact volume and the vertex normals
+	static bool HasPressure(int key);
+};
@@ -0,0 +1,500 @@
+#include "SurfaceBuilder.h"
+#include "SpatialHash.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <queue>
+
+// A collapse may turn a neighbouring face by at most ~78 degrees
+static const double FOLD_MIN_COSINE = 0.2;
+
+// Collapses stop here: a tetrahedron is the smallest closed surface
+static const size_t DECIMATE_MIN_VERTICES = 4;
+
+// Boundary edges get a perpendicular plane this many times heavier than
+// their face, so open rims keep their outline
+static const double BOUNDARY_WEIGHT = 100.0;
+
+static inline uint64_t EdgeKey(uint32_t a, uint32_t b)
+{
+	return (static_cast<uint64_t>(std::max(a, b)) << 32) | std::min(a, b);
+}
+
+// Keeps the vertices some triangle uses, in their original order
+static void CompactVertices(SimulationSurface& surface)
+{
+	const uint32_t unused = ~0u;
+	std::vector<uint32_t> remap(surface.positions.size(), unused);
+	for (const Triangle& tri : surface.triangles)
+		for (int k = 0; k < 3; k++)
+			remap[tri.vertex[k]] = 0;
+
+	std::vector<glm::vec3> positions;
+	for (size_t i = 0; i < remap.size(); i++)
+	{
+		if (remap[i] == unused) continue;
+		remap[i] = static_cast<uint32_t>(positions.size());
+		positions.push_back(surface.positions[i]);
+	}
+	surface.positions = std::move(positions);
+	for (Triangle& tri : surface.triangles)
+		for (int k = 0; k < 3; k++)
+			tri.vertex[k] = remap[tri.vertex[k]];
+}
+
+SimulationSurface SurfaceBuilder::Build(const std::vector<glm::vec3>& positions, const std::vector<Triangle>& triangles,
+										size_t vertexBudget, float radius, SurfaceReport& report)
+{
+	SimulationSurface surface;
+	surface.positions = positions;
+	surface.triangles = triangles;
+
+	report = SurfaceReport();
+	report.inputVertices = positions.size();
+
+	Normalize(surface, radius);
+	Weld(surface, WELD_RELATIVE_TOLERANCE * radius);
+	report.weldedVertices = surface.positions.size();
+	if (vertexBudget > 0 && surface.positions.size() > vertexBudget)
+		Decimate(surface, vertexBudget);
+
+	SurfaceReport topology = Check(surface);
+	report.boundaryEdges = topology.boundaryEdges;
+	report.nonManifoldEdges = topology.nonManifoldEdges;
+	report.flippedEdges = topology.flippedEdges;
+	report.nonManifoldVertices = topology.nonManifoldVertices;
+	if (report.IsClosedManifold())
+		OrientOutward(surface);
+	return surface;
+}
+
+void SurfaceBuilder::Normalize(SimulationSurface& surface, float radius)
+{
+	if (surface.positions.empty()) return;
+
+	glm::vec3 lo = surface.positions[0], hi = surface.positions[0];
+	for (const glm::vec3& p : surface.positions)
+	{
+		lo = glm::min(lo, p);
+		hi = glm::max(hi, p);
+	}
+	glm::vec3 center = 0.5f * (lo + hi);
+
+	float extent = 0.0f;
+	for (const glm::vec3& p : surface.positions)
+		extent = std::max(extent, glm::length(p - center));
+	float scale = extent > 0.0f ? radius / extent : 1.0f;
+
+	for (glm::vec3& p : surface.positions)
+		p = (p - center) * scale;
+}
+
+void SurfaceBuilder::Weld(SimulationSurface& surface, float tolerance)
+{
+	size_t n = surface.positions.size();
+	const auto& positions = surface.positions;
+
+	// Each vertex joins the lowest-numbered earlier representative within
+	// the tolerance; the hash holds every vertex's tolerance box, so the
+	// bucket of a vertex's own cell lists all candidates
+	std::vector<uint32_t> representative(n);
+	for (size_t i = 0; i < n; i++)
+		representative[i] = static_cast<uint32_t>(i);
+	if (tolerance > 0.0f)
+	{
+		SpatialHash hash;
+		hash.SetCellSize(2.0f * tolerance);
+		hash.Build(n, [&](size_t i, glm::vec3& bMin, glm::vec3& bMax)
+		{
+			bMin = positions[i] - tolerance;
+			bMax = positions[i] + tolerance;
+		});
+
+		float tolerance2 = tolerance * tolerance;
+		for (size_t i = 0; i < n; i++)
+		{
+			uint32_t best = static_cast<uint32_t>(i);
+			hash.Query(positions[i], [&](uint32_t j)
+			{
+				if (j >= best || representative[j] != j) return;
+				glm::vec3 d = positions[j] - positions[i];
+				if (glm::dot(d, d) <= tolerance2) best = j;
+			});
+			representative[i] = best;
+		}
+	}
+
+	// Drop triangles that lost a corner to the weld, and repeats of the
+	// same three vertices (either winding)
+	std::vector<std::pair<std::array<uint32_t, 3>, uint32_t>> keys;
+	keys.reserve(surface.triangles.size());
+	for (size_t t = 0; t < surface.triangles.size(); t++)
+	{
+		Triangle& tri = surface.triangles[t];
+		for (int k = 0; k < 3; k++)
+			tri.vertex[k] = representative[tri.vertex[k]];
+		if (tri.vertex[0] == tri.vertex[1] || tri.vertex[1] == tri.vertex[2] || tri.vertex[2] == tri.vertex[0])
+			continue;
+		std::array<uint32_t, 3> key = { tri.vertex[0], tri.vertex[1], tri.vertex[2] };
+		std::sort(key.begin(), key.end());
+		keys.push_back({ key, static_cast<uint32_t>(t) });
+	}
+	std::sort(keys.begin(), keys.end());
+
+	std::vector<char> keep(surface.triangles.size(), 0);
+	for (size_t k = 0; k < keys.size(); k++)
+		if (k == 0 || keys[k].first != keys[k - 1].first)
+			keep[keys[k].second] = 1;
+
+	std::vector<Triangle> triangles;
+	triangles.reserve(keys.size());
+	for (size_t t = 0; t < surface.triangles.size(); t++)
+		if (keep[t]) triangles.push_back(surface.triangles[t]);
+	surface.triangles = std::move(triangles);
+
+	CompactVertices(surface);
+}
+
+namespace
+{
+	// Symmetric 4x4 error quadric Σ w p pᵀ over planes p = (n, d)
+	struct Quadric
+	{
+		double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+		void AddPlane(const glm::dvec3& n, double d, double w)
+		{
+			a2 += w * n.x * n.x; ab += w * n.x * n.y; ac += w * n.x * n.z; ad += w * n.x * d;
+			b2 += w * n.y * n.y; bc += w * n.y * n.z; bd += w * n.y * d;
+			c2 += w * n.z * n.z; cd += w * n.z * d;
+			d2 += w * d * d;
+		}
+
+		Quadric& operator+=(const Quadric& o)
+		{
+			a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad; b2 += o.b2;
+			bc += o.bc; bd += o.bd; c2 += o.c2; cd += o.cd; d2 += o.d2;
+			return *this;
+		}
+
+		double Evaluate(const glm::dvec3& v) const
+		{
+			return a2 * v.x * v.x + 2.0 * ab * v.x * v.y + 2.0 * ac * v.x * v.z + 2.0 * ad * v.x +
+				   b2 * v.y * v.y + 2.0 * bc * v.y * v.z + 2.0 * bd * v.y +
+				   c2 * v.z * v.z + 2.0 * cd * v.z + d2;
+		}
+
+		// Minimizer, if the quadric is well conditioned
+		bool Minimize(glm::dvec3& v) const
+		{
+			glm::dmat3 a(a2, ab, ac, ab, b2, bc, ac, bc, c2);
+			double det = glm::determinant(a);
+			double scale = a2 * b2 * c2;
+			if (!(std::fabs(det) > 1e-10 * std::max(scale, 1e-30))) return false;
+			v = -(glm::inverse(a) * glm::dvec3(ad, bd, cd));
+			return true;
+		}
+	};
+
+	struct Collapse
+	{
+		double cost;
+		uint32_t a, b;
+		uint32_t versionA, versionB;
+		glm::vec3 target;
+
+		bool operator>(const Collapse& o) const { return cost > o.cost; }
+	};
+}
+
+void SurfaceBuilder::Decimate(SimulationSurface& surface, size_t vertexBudget)
+{
+	auto& positions = surface.positions;
+	auto& triangles = surface.triangles;
+	size_t n = positions.size();
+	vertexBudget = std::max(vertexBudget, DECIMATE_MIN_VERTICES);
+	if (n <= vertexBudget) return;
+
+	std::vector<std::vector<uint32_t>> vertexTriangles(n);
+	for (size_t t = 0; t < triangles.size(); t++)
+		for (int k = 0; k < 3; k++)
+			vertexTriangles[triangles[t].vertex[k]].push_back(static_cast<uint32_t>(t));
+
+	// Face quadrics weighted by area
+	std::vector<Quadric> quadrics(n);
+	for (const Triangle& tri : triangles)
+	{
+		glm::dvec3 p0(positions[tri.vertex[0]]), p1(positions[tri.vertex[1]]), p2(positions[tri.vertex[2]]);
+		glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		double length = glm::length(normal);
+		if (length <= 0.0) continue;
+		normal /= length;
+		for (int k = 0; k < 3; k++)
+			quadrics[tri.vertex[k]].AddPlane(normal, -glm::dot(normal, p0), 0.5 * length);
+	}
+
+	// Edges used by other than two faces are rims or seams: their vertices
+	// stay, and rims also get a plane along the face normal
+	std::vector<std::pair<uint64_t, uint32_t>> edges;
+	edges.reserve(3 * triangles.size());
+	for (size_t t = 0; t < triangles.size(); t++)
+		for (int k = 0; k < 3; k++)
+			edges.push_back({ EdgeKey(triangles[t].vertex[k], triangles[t].vertex[(k + 1) % 3]),
+							  static_cast<uint32_t>(t) });
+	std::sort(edges.begin(), edges.end());
+
+	std::vector<char> locked(n, 0);
+	std::vector<uint64_t> uniqueEdges;
+	for (size_t k = 0; k < edges.size();)
+	{
+		size_t end = k;
+		while (end < edges.size() && edges[end].first == edges[k].first) end++;
+		uint32_t a = static_cast<uint32_t>(edges[k].first & 0xFFFFFFFFu);
+		uint32_t b = static_cast<uint32_t>(edges[k].first >> 32);
+		uniqueEdges.push_back(edges[k].first);
+		if (end - k != 2)
+		{
+			locked[a] = locked[b] = 1;
+			if (end - k == 1)
+			{
+				const Triangle& tri = triangles[edges[k].second];
+				glm::dvec3 p0(positions[tri.vertex[0]]), p1(positions[tri.vertex[1]]), p2(positions[tri.vertex[2]]);
+				glm::dvec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+				glm::dvec3 edge = glm::dvec3(positions[b]) - glm::dvec3(positions[a]);
+				glm::dvec3 normal = glm::cross(edge, faceNormal);
+				double length = glm::length(normal);
+				if (length > 0.0)
+				{
+					normal /= length;
+					double d = -glm::dot(normal, glm::dvec3(positions[a]));
+					quadrics[a].AddPlane(normal, d, BOUNDARY_WEIGHT * glm::dot(edge, edge));
+					quadrics[b].AddPlane(normal, d, BOUNDARY_WEIGHT * glm::dot(edge, edge));
+				}
+			}
+		}
+		k = end;
+	}
+
+	std::vector<uint32_t> versions(n, 0);
+	std::vector<char> alive(n, 1);
+	std::vector<char> triangleAlive(triangles.size(), 1);
+
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+	auto push = [&](uint32_t a, uint32_t b)
+	{
+		if (locked[a] || locked[b]) return;
+		Quadric q = quadrics[a];
+		q += quadrics[b];
+		glm::dvec3 pa(positions[a]), pb(positions[b]);
+		glm::dvec3 target;
+		if (!q.Minimize(target))
+		{
+			// Flat or cylindrical neighbourhood: best of the ends and the middle
+			glm::dvec3 options[3] = { pa, pb, 0.5 * (pa + pb) };
+			target = options[0];
+			for (const glm::dvec3& option : options)
+				if (q.Evaluate(option) < q.Evaluate(target)) target = option;
+		}
+		queue.push({ std::max(0.0, q.Evaluate(target)), a, b, versions[a], versions[b], glm::vec3(target) });
+	};
+	for (uint64_t key : uniqueEdges)
+		push(static_cast<uint32_t>(key & 0xFFFFFFFFu), static_cast<uint32_t>(key >> 32));
+
+	auto neighbours = [&](uint32_t v, std::vector<uint32_t>& out)
+	{
+		out.clear();
+		for (uint32_t t : vertexTriangles[v])
+			for (int k = 0; k < 3; k++)
+				if (triangles[t].vertex[k] != v) out.push_back(triangles[t].vertex[k]);
+		std::sort(out.begin(), out.end());
+		out.erase(std::unique(out.begin(), out.end()), out.end());
+	};
+	auto contains = [&](uint32_t t, uint32_t v)
+	{
+		const Triangle& tri = triangles[t];
+		return tri.vertex[0] == v || tri.vertex[1] == v || tri.vertex[2] == v;
+	};
+
+	std::vector<uint32_t> aroundA, aroundB, common;
+	size_t aliveCount = n;
+	while (aliveCount > vertexBudget && !queue.empty())
+	{
+		Collapse c = queue.top();
+		queue.pop();
+		if (!alive[c.a] || !alive[c.b] || versions[c.a] != c.versionA || versions[c.b] != c.versionB)
+			continue;
+
+		// Link condition: a and b may only share the two vertices opposite
+		// their edge, or the collapse pinches the surface
+		size_t shared = 0;
+		for (uint32_t t : vertexTriangles[c.a])
+			if (contains(t, c.b)) shared++;
+		neighbours(c.a, aroundA);
+		neighbours(c.b, aroundB);
+		common.clear();
+		std::set_intersection(aroundA.begin(), aroundA.end(), aroundB.begin(), aroundB.end(),
+							  std::back_inserter(common));
+		if (shared != 2 || common.size() != 2) continue;
+
+		// No remaining face may flip or degenerate
+		bool folds = false;
+		for (uint32_t v : { c.a, c.b })
+		{
+			for (uint32_t t : vertexTriangles[v])
+			{
+				if (contains(t, c.a) && contains(t, c.b)) continue;
+				glm::dvec3 before[3], after[3];
+				for (int k = 0; k < 3; k++)
+				{
+					uint32_t corner = triangles[t].vertex[k];
+					before[k] = glm::dvec3(positions[corner]);
+					after[k] = (corner == v) ? glm::dvec3(c.target) : before[k];
+				}
+				glm::dvec3 oldNormal = glm::cross(before[1] - before[0], before[2] - before[0]);
+				glm::dvec3 newNormal = glm::cross(after[1] - after[0], after[2] - after[0]);
+				double oldLength = glm::length(oldNormal), newLength = glm::length(newNormal);
+				if (newLength <= 1e-12 * std::max(oldLength, 1e-30) ||
+					glm::dot(oldNormal, newNormal) < FOLD_MIN_COSINE * oldLength * newLength)
+				{
+					folds = true;
+					break;
+				}
+			}
+			if (folds) break;
+		}
+		if (folds) continue;
+
+		// b merges into a; the two faces on the edge disappear
+		for (uint32_t t : vertexTriangles[c.b])
+		{
+			if (contains(t, c.a))
+			{
+				triangleAlive[t] = 0;
+				for (int k = 0; k < 3; k++)
+				{
+					uint32_t corner = triangles[t].vertex[k];
+					if (corner == c.b) continue;
+					auto& list = vertexTriangles[corner];
+					list.erase(std::remove(list.begin(), list.end(), t), list.end());
+				}
+				continue;
+			}
+			for (int k = 0; k < 3; k++)
+				if (triangles[t].vertex[k] == c.b) triangles[t].vertex[k] = c.a;
+			vertexTriangles[c.a].push_back(t);
+		}
+		vertexTriangles[c.b].clear();
+		alive[c.b] = 0;
+		aliveCount--;
+
+		positions[c.a] = c.target;
+		quadrics[c.a] += quadrics[c.b];
+		versions[c.a]++;
+
+		neighbours(c.a, aroundA);
+		for (uint32_t v : aroundA)
+			push(std::min(c.a, v), std::max(c.a, v));
+	}
+
+	std::vector<Triangle> kept;
+	kept.reserve(triangles.size());
+	for (size_t t = 0; t < triangles.size(); t++)
+		if (triangleAlive[t]) kept.push_back(triangles[t]);
+	triangles = std::move(kept);
+	CompactVertices(surface);
+}
+
+SurfaceReport SurfaceBuilder::Check(const SimulationSurface& surface)
+{
+	SurfaceReport report;
+	const auto& triangles = surface.triangles;
+
+	// Edges with their direction of traversal; a closed, consistently
+	// wound manifold uses every edge exactly twice, once each way
+	std::vector<std::pair<uint64_t, bool>> edges;
+	edges.reserve(3 * triangles.size());
+	for (const Triangle& tri : triangles)
+		for (int k = 0; k < 3; k++)
+		{
+			uint32_t a = tri.vertex[k], b = tri.vertex[(k + 1) % 3];
+			edges.push_back({ EdgeKey(a, b), a < b });
+		}
+	std::sort(edges.begin(), edges.end());
+	for (size_t k = 0; k < edges.size();)
+	{
+		size_t end = k;
+		while (end < edges.size() && edges[end].first == edges[k].first) end++;
+		size_t uses = end - k;
+		if (uses == 1) report.boundaryEdges++;
+		else if (uses > 2) report.nonManifoldEdges++;
+		else if (edges[k].second == edges[k + 1].second) report.flippedEdges++;
+		k = end;
+	}
+
+	// A manifold vertex's faces form one fan: their opposite edges link
+	// up into a single chain (or cycle)
+	std::vector<std::vector<uint32_t>> vertexTriangles(surface.positions.size());
+	for (size_t t = 0; t < triangles.size(); t++)
+		for (int k = 0; k < 3; k++)
+			vertexTriangles[triangles[t].vertex[k]].push_back(static_cast<uint32_t>(t));
+
+	std::vector<uint32_t> link, parent;
+	for (size_t v = 0; v < vertexTriangles.size(); v++)
+	{
+		if (vertexTriangles[v].empty()) continue;
+
+		link.clear();
+		for (uint32_t t : vertexTriangles[v])
+			for (int k = 0; k < 3; k++)
+				if (triangles[t].vertex[k] != v) link.push_back(triangles[t].vertex[k]);
+		std::sort(link.begin(), link.end());
+		link.erase(std::unique(link.begin(), link.end()), link.end());
+
+		parent.resize(link.size());
+		for (size_t k = 0; k < parent.size(); k++)
+			parent[k] = static_cast<uint32_t>(k);
+		auto find = [&](uint32_t x)
+		{
+			while (parent[x] != x) x = parent[x] = parent[parent[x]];
+			return x;
+		};
+		auto local = [&](uint32_t vertex)
+		{
+			return static_cast<uint32_t>(std::lower_bound(link.begin(), link.end(), vertex) - link.begin());
+		};
+
+		size_t components = link.size();
+		for (uint32_t t : vertexTriangles[v])
+		{
+			uint32_t other[2], count = 0;
+			for (int k = 0; k < 3; k++)
+				if (triangles[t].vertex[k] != v) other[count++] = triangles[t].vertex[k];
+			uint32_t x = find(local(other[0])), y = find(local(other[1]));
+			if (x != y)
+			{
+				parent[x] = y;
+				components--;
+			}
+		}
+		if (components > 1) report.nonManifoldVertices++;
+	}
+	return report;
+}
+
+void SurfaceBuilder::OrientOutward(SimulationSurface& surface)
+{
+	double volume = 0.0;
+	for (const Triangle& tri : surface.triangles)
+	{
+		glm::dvec3 a(surface.positions[tri.vertex[0]]);
+		glm::dvec3 b(surface.positions[tri.vertex[1]]);
+		glm::dvec3 c(surface.positions[tri.vertex[2]]);
+		volume += glm::dot(a, glm::cross(b, c));
+	}
+	if (volume <= 0.0) return;
+
+	for (Triangle& tri : surface.triangles)
+		std::swap(tri.vertex[1], tri.vertex[2]);
+}
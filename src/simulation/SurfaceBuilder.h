@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "Geometry.h"
+
+// Welding tolerance as a fraction of the normalized body's radius
+const float WELD_RELATIVE_TOLERANCE = 1e-4f;
+
+// Triangle surface a Softbody can simulate: one vertex per particle and
+// triangles wound like the icosphere, clockwise seen from outside
+// (PhysicsEngine negates the edge cross product for outward normals)
+struct SimulationSurface
+{
+	std::vector<glm::vec3> positions;
+	std::vector<Triangle> triangles;
+};
+
+// Topology defects that break the divergence-theorem volume (and with it
+// the pressure term and the FEM tetrahedralization)
+struct SurfaceReport
+{
+	size_t inputVertices = 0;
+	size_t weldedVertices = 0;
+	size_t boundaryEdges = 0;        // used by one triangle: the surface has a hole
+	size_t nonManifoldEdges = 0;     // used by three or more triangles
+	size_t flippedEdges = 0;         // two triangles traverse it the same way
+	size_t nonManifoldVertices = 0;  // triangle fan in several pieces (surfaces touching at a point)
+
+	bool IsClosedManifold() const
+	{
+		return boundaryEdges == 0 && nonManifoldEdges == 0 && flippedEdges == 0 && nonManifoldVertices == 0;
+	}
+};
+
+// Turns render geometry (e.g. a loaded Model: one vertex per corner
+// attribute, so seams are split) into a SimulationSurface:
+//   1. normalize: centered on the origin, bounding radius `radius`
+//   2. weld vertices closer than the tolerance through a SpatialHash, and
+//      drop the triangles that collapse or repeat
+//   3. decimate to at most `vertexBudget` vertices (0: no limit) by
+//      quadric-error edge collapses (Garland & Heckbert 1997)
+//   4. check the topology and, if closed, orient the triangles outwards
+class SurfaceBuilder
+{
+public:
+	static SimulationSurface Build(const std::vector<glm::vec3>& positions, const std::vector<Triangle>& triangles,
+								   size_t vertexBudget, float radius, SurfaceReport& report);
+
+	static void Normalize(SimulationSurface& surface, float radius);
+	static void Weld(SimulationSurface& surface, float tolerance);
+	static void Decimate(SimulationSurface& surface, size_t vertexBudget);
+	static SurfaceReport Check(const SimulationSurface& surface);
+
+	// Flips every triangle when the enclosed signed volume, taken with the
+	// counter-clockwise convention, is positive
+	static void OrientOutward(SimulationSurface& surface);
+};
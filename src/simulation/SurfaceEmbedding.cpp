@@ -0,0 +1,115 @@
+#include "SurfaceEmbedding.h"
+#include "TriangleBvh.h"
+#include "Parallel.h"
+#include <cmath>
+
+static const size_t VERTEX_GRAIN = 2048;
+static const float FRAME_EPSILON = 1e-12f;
+
+// Orthonormal frame (edge tangent, bitangent, normal) at the point with
+// barycentric weights w on the triangle: the normal interpolates the
+// cage's vertex normals, so neighbouring faces agree along their edges
+static glm::mat3 FaceFrame(const std::vector<glm::vec3>& cage, const std::vector<glm::vec3>& normals,
+						   const Triangle& tri, const glm::vec3& w)
+{
+	const glm::vec3& a = cage[tri.vertex[0]];
+	const glm::vec3& b = cage[tri.vertex[1]];
+	const glm::vec3& c = cage[tri.vertex[2]];
+
+	glm::vec3 n = w.x * normals[tri.vertex[0]] + w.y * normals[tri.vertex[1]] + w.z * normals[tri.vertex[2]];
+	if (glm::dot(n, n) < FRAME_EPSILON)
+		n = glm::cross(b - a, c - a);
+	if (glm::dot(n, n) < FRAME_EPSILON)
+		return glm::mat3(1.0f);
+	n = glm::normalize(n);
+
+	glm::vec3 t = (b - a) - n * glm::dot(n, b - a);
+	if (glm::dot(t, t) < FRAME_EPSILON)
+		t = (c - a) - n * glm::dot(n, c - a);
+	if (glm::dot(t, t) < FRAME_EPSILON)
+		t = glm::cross(n, std::fabs(n.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f));
+	t = glm::normalize(t);
+
+	return glm::mat3(t, glm::cross(n, t), n);
+}
+
+void SurfaceEmbedding::Build(const std::vector<glm::vec3>& cage, const std::vector<Triangle>& cageTriangles,
+							 const std::vector<glm::vec3>& cageNormals, const std::vector<glm::vec3>& render,
+							 const std::vector<Triangle>& renderTriangles)
+{
+	m_CageTriangles = cageTriangles;
+	size_t count = render.size();
+	m_Faces.assign(count, 0);
+	m_Weights.assign(count, glm::vec3(1.0f, 0.0f, 0.0f));
+	m_Offsets.assign(count, glm::vec3(0.0f));
+	m_Normals.assign(count, glm::vec3(0.0f));
+	if (count == 0 || cageTriangles.empty()) return;
+
+	// Area-weighted rest normals of the render mesh
+	std::vector<glm::vec3> restNormals(count, glm::vec3(0.0f));
+	for (const Triangle& tri : renderTriangles)
+	{
+		const glm::vec3& a = render[tri.vertex[0]];
+		glm::vec3 n = glm::cross(render[tri.vertex[1]] - a, render[tri.vertex[2]] - a);
+		for (int k = 0; k < 3; k++)
+			restNormals[tri.vertex[k]] += n;
+	}
+
+	// Search radius: anything inside the joint bounding box
+	glm::vec3 lo = cage[0], hi = cage[0];
+	for (const glm::vec3& p : cage) { lo = glm::min(lo, p); hi = glm::max(hi, p); }
+	for (const glm::vec3& p : render) { lo = glm::min(lo, p); hi = glm::max(hi, p); }
+	float reach = glm::length(hi - lo) + 1.0f;
+
+	TriangleBvh bvh;
+	bvh.Build(cageTriangles, cage);
+
+	std::vector<float> alignment(count, 0.0f);
+	ParallelFor(0, count, VERTEX_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			BvhHit hit;
+			if (!bvh.FindClosest(render[i], reach, cageTriangles, cage, hit)) continue;
+
+			glm::mat3 frame = FaceFrame(cage, cageNormals, cageTriangles[hit.triangle], hit.weights);
+			glm::mat3 toFrame = glm::transpose(frame);
+			m_Faces[i] = hit.triangle;
+			m_Weights[i] = hit.weights;
+			m_Offsets[i] = toFrame * (render[i] - hit.point);
+
+			float length = glm::length(restNormals[i]);
+			if (length > 0.0f)
+				m_Normals[i] = toFrame * (restNormals[i] / length);
+			alignment[i] = m_Normals[i].z;
+		}
+	});
+
+	// The render mesh may be wound the other way round from the cage
+	double agreement = 0.0;
+	for (float a : alignment)
+		agreement += a;
+	if (agreement < 0.0)
+		for (glm::vec3& n : m_Normals)
+			n = -n;
+}
+
+void SurfaceEmbedding::Apply(const std::vector<glm::vec3>& cage, const std::vector<glm::vec3>& cageNormals,
+							 std::vector<Vertex>& render) const
+{
+	render.resize(m_Faces.size());
+	ParallelFor(0, m_Faces.size(), VERTEX_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			const Triangle& tri = m_CageTriangles[m_Faces[i]];
+			const glm::vec3& w = m_Weights[i];
+			glm::vec3 q = w.x * cage[tri.vertex[0]] + w.y * cage[tri.vertex[1]] + w.z * cage[tri.vertex[2]];
+
+			// The frame is orthonormal, so the rotated normal stays unit length
+			glm::mat3 frame = FaceFrame(cage, cageNormals, tri, w);
+			render[i].Position = q + frame * m_Offsets[i];
+			render[i].Normal = frame * m_Normals[i];
+		}
+	});
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Geometry.h"
+
+// Dense render surface carried by a coarse simulated cage, so visual
+// detail no longer costs particles. At rest every render vertex binds to
+// its closest cage triangle: the barycentric weights of the closest point,
+// plus the vertex's offset from it and its normal expressed in a frame
+// built from the triangle's interpolated vertex normal and first edge.
+// Apply rebuilds that frame on the deformed cage, so the render surface
+// follows the cage's stretching (weights) and bending and rotation (frame),
+// reproduces the rest shape exactly, and stays continuous across cage
+// faces along the normal. Each render vertex is an independent gather from
+// three cage vertices, so the reconstruction runs in parallel.
+class SurfaceEmbedding
+{
+private:
+	std::vector<Triangle> m_CageTriangles;
+	std::vector<uint32_t> m_Faces;       // per render vertex: cage triangle
+	std::vector<glm::vec3> m_Weights;    // barycentric weights of the closest point
+	std::vector<glm::vec3> m_Offsets;    // vertex - closest point, in the face frame
+	std::vector<glm::vec3> m_Normals;    // rest normal, in the face frame
+
+public:
+	SurfaceEmbedding() = default;
+
+	// cage/cageNormals: rest cage positions and vertex normals; the render
+	// mesh's rest normals are computed from its triangles and oriented like
+	// the cage's
+	void Build(const std::vector<glm::vec3>& cage, const std::vector<Triangle>& cageTriangles,
+			   const std::vector<glm::vec3>& cageNormals, const std::vector<glm::vec3>& render,
+			   const std::vector<Triangle>& renderTriangles);
+
+	// Writes the render vertices' positions and normals for the current cage
+	void Apply(const std::vector<glm::vec3>& cage, const std::vector<glm::vec3>& cageNormals,
+			   std::vector<Vertex>& render) const;
+
+	inline bool IsEmpty() const { return m_Faces.empty(); }
+	inline size_t GetVertexCount() const { return m_Faces.size(); }
+};
@@ -0,0 +1,22 @@
+#include "SurfaceTopology.h"
+
+void SurfaceTopology::Build(const std::vector<Triangle>& triangles, size_t vertexCount)
+{
+	m_Triangles = triangles;
+
+	std::vector<uint32_t> rows, faces;
+	rows.reserve(triangles.size() * 3);
+	faces.reserve(triangles.size() * 3);
+	for (size_t f = 0; f < triangles.size(); f++)
+	{
+		for (int i = 0; i < Triangle::GetVertexCount(); i++)
+		{
+			rows.push_back(triangles[f].vertex[i]);
+			faces.push_back(static_cast<uint32_t>(f));
+		}
+	}
+
+	m_VertexFaces.Build(vertexCount, rows, faces);
+	m_FaceVectors.assign(triangles.size(), glm::vec3(0.0f));
+	m_VertexNormals.assign(vertexCount, glm::vec3(0.0f));
+}
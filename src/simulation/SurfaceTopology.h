@@ -0,0 +1,32 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Geometry.h"
+#include "CsrAdjacency.h"
+
+// Closed triangle surface of a soft body plus its vertex -> face adjacency.
+// Face passes compute one value per triangle into m_FaceVectors, then every
+// vertex gathers from its incident faces, so both phases parallelize
+// without write conflicts.
+class SurfaceTopology
+{
+private:
+	std::vector<Triangle> m_Triangles;
+	CsrAdjacency m_VertexFaces;
+	std::vector<glm::vec3> m_FaceVectors;
+	std::vector<glm::vec3> m_VertexNormals;
+
+public:
+	SurfaceTopology() = default;
+
+	void Build(const std::vector<Triangle>& triangles, size_t vertexCount);
+
+	inline size_t GetFaceCount() const { return m_Triangles.size(); }
+	inline size_t GetVertexCount() const { return m_VertexFaces.GetRowCount(); }
+	inline const std::vector<Triangle>& GetTriangles() const { return m_Triangles; }
+	inline const CsrAdjacency& GetVertexFaces() const { return m_VertexFaces; }
+	inline std::vector<glm::vec3>& GetFaceVectors() { return m_FaceVectors; }
+	inline std::vector<glm::vec3>& GetVertexNormals() { return m_VertexNormals; }
+	inline const std::vector<glm::vec3>& GetVertexNormals() const { return m_VertexNormals; }
+};
@@ -0,0 +1,381 @@
+#include "Tetrahedralizer.h"
+#include "PhysicsEngine.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const size_t POINT_GRAIN = 64;
+
+// Relative size of the insertion jitter that breaks the co-spherical ties
+// of regular inputs (every icosphere vertex lies on one sphere)
+static const double JITTER_SCALE = 1e-6;
+
+// Vertices of the face opposite vertex j
+static const int TET_FACES[4][3] = { { 1, 2, 3 }, { 0, 2, 3 }, { 0, 1, 3 }, { 0, 1, 2 } };
+
+static double Orient(const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c, const glm::dvec3& p)
+{
+	return glm::dot(glm::cross(b - a, c - a), p - a);
+}
+
+// Bowyer-Watson state: tets are 4 vertex slots plus the neighbour across
+// the face opposite each vertex (-1 on the hull); deleted tets have
+// vertex -1 and are reused from the free list
+class DelaunayBuilder
+{
+private:
+	std::vector<glm::dvec3> m_Points;
+	std::vector<int> m_Vertices;
+	std::vector<int> m_Neighbors;
+	std::vector<glm::dvec3> m_Centers;
+	std::vector<double> m_Radii2;
+	std::vector<int> m_Free;
+	std::vector<int> m_Marks;
+	int m_Mark = 0;
+	int m_Last = 0;
+
+	// Cavity scratch
+	std::vector<int> m_Cavity;
+	std::vector<int> m_Stack;
+	struct FaceLink { uint64_t edge; int tet; int face; };
+	std::vector<FaceLink> m_Links;
+
+public:
+	explicit DelaunayBuilder(const std::vector<glm::dvec3>& points, const glm::dvec3& lo, double extent)
+		: m_Points(points)
+	{
+		// Enclosing tet, far enough out that its circumspheres stay well conditioned
+		glm::dvec3 origin = lo - glm::dvec3(extent);
+		double size = 10.0 * extent;
+		m_Points.push_back(origin);
+		m_Points.push_back(origin + glm::dvec3(size, 0.0, 0.0));
+		m_Points.push_back(origin + glm::dvec3(0.0, size, 0.0));
+		m_Points.push_back(origin + glm::dvec3(0.0, 0.0, size));
+		int n = static_cast<int>(points.size());
+		AddTet(n, n + 1, n + 2, n + 3);
+	}
+
+	size_t GetTetCount() const { return m_Vertices.size() / 4; }
+	const int* GetTet(size_t t) const { return &m_Vertices[4 * t]; }
+
+	void Insert(int point)
+	{
+		const glm::dvec3& p = m_Points[point];
+		int start = Locate(p);
+		if (start < 0) return;
+
+		// Flood the tets whose circumsphere contains p
+		m_Mark++;
+		m_Cavity.clear();
+		m_Stack.assign(1, start);
+		m_Marks[start] = m_Mark;
+		while (!m_Stack.empty())
+		{
+			int t = m_Stack.back();
+			m_Stack.pop_back();
+			m_Cavity.push_back(t);
+			for (int j = 0; j < 4; j++)
+			{
+				int n = m_Neighbors[4 * t + j];
+				if (n < 0 || m_Marks[n] == m_Mark) continue;
+				if (InCircumsphere(n, p))
+				{
+					m_Marks[n] = m_Mark;
+					m_Stack.push_back(n);
+				}
+			}
+		}
+
+		// Cone the cavity boundary to p
+		m_Links.clear();
+		for (int t : m_Cavity)
+		{
+			for (int j = 0; j < 4; j++)
+			{
+				int outer = m_Neighbors[4 * t + j];
+				if (outer >= 0 && m_Marks[outer] == m_Mark) continue;
+
+				int a = m_Vertices[4 * t + TET_FACES[j][0]];
+				int b = m_Vertices[4 * t + TET_FACES[j][1]];
+				int c = m_Vertices[4 * t + TET_FACES[j][2]];
+				if (Orient(m_Points[a], m_Points[b], m_Points[c], p) < 0.0) std::swap(a, b);
+
+				int created = AddTet(a, b, c, point);
+				m_Neighbors[4 * created + 3] = outer;
+				if (outer >= 0)
+					for (int k = 0; k < 4; k++)
+						if (m_Neighbors[4 * outer + k] == t) m_Neighbors[4 * outer + k] = created;
+
+				// Faces through p, keyed by their edge on the boundary
+				int face[3] = { a, b, c };
+				for (int k = 0; k < 3; k++)
+				{
+					uint64_t lo = static_cast<uint64_t>(std::min(face[(k + 1) % 3], face[(k + 2) % 3]));
+					uint64_t hi = static_cast<uint64_t>(std::max(face[(k + 1) % 3], face[(k + 2) % 3]));
+					m_Links.push_back({ (hi << 32) | lo, created, k });
+				}
+				m_Last = created;
+			}
+		}
+
+		std::sort(m_Links.begin(), m_Links.end(),
+				  [](const FaceLink& x, const FaceLink& y) { return x.edge < y.edge; });
+		for (size_t k = 0; k + 1 < m_Links.size(); k += 2)
+		{
+			m_Neighbors[4 * m_Links[k].tet + m_Links[k].face] = m_Links[k + 1].tet;
+			m_Neighbors[4 * m_Links[k + 1].tet + m_Links[k + 1].face] = m_Links[k].tet;
+		}
+
+		for (int t : m_Cavity)
+		{
+			m_Vertices[4 * t] = -1;
+			m_Free.push_back(t);
+		}
+	}
+
+private:
+	int AddTet(int a, int b, int c, int d)
+	{
+		int t;
+		if (!m_Free.empty())
+		{
+			t = m_Free.back();
+			m_Free.pop_back();
+		}
+		else
+		{
+			t = static_cast<int>(GetTetCount());
+			m_Vertices.resize(m_Vertices.size() + 4);
+			m_Neighbors.resize(m_Neighbors.size() + 4);
+			m_Centers.emplace_back(0.0);
+			m_Radii2.push_back(0.0);
+			m_Marks.push_back(0);
+		}
+
+		int* v = &m_Vertices[4 * t];
+		v[0] = a; v[1] = b; v[2] = c; v[3] = d;
+		for (int j = 0; j < 4; j++)
+			m_Neighbors[4 * t + j] = -1;
+		m_Marks[t] = 0;
+
+		const glm::dvec3& p0 = m_Points[a];
+		glm::dvec3 e1 = m_Points[b] - p0, e2 = m_Points[c] - p0, e3 = m_Points[d] - p0;
+		double denominator = 2.0 * glm::dot(e1, glm::cross(e2, e3));
+		glm::dvec3 offset = (glm::dot(e1, e1) * glm::cross(e2, e3) + glm::dot(e2, e2) * glm::cross(e3, e1) +
+							 glm::dot(e3, e3) * glm::cross(e1, e2)) / denominator;
+		m_Centers[t] = p0 + offset;
+		m_Radii2[t] = glm::dot(offset, offset);
+		return t;
+	}
+
+	bool InCircumsphere(int t, const glm::dvec3& p) const
+	{
+		glm::dvec3 d = p - m_Centers[t];
+		return glm::dot(d, d) < m_Radii2[t];
+	}
+
+	// Walk towards p from the last created tet; falls back to a scan if the
+	// walk cycles on a degenerate configuration
+	int Locate(const glm::dvec3& p)
+	{
+		int t = (m_Last < static_cast<int>(GetTetCount()) && m_Vertices[4 * m_Last] >= 0) ? m_Last : -1;
+		size_t steps = 0;
+		while (t >= 0 && steps++ < GetTetCount())
+		{
+			int next = -1;
+			for (int j = 0; j < 4 && next < 0; j++)
+			{
+				const int* v = &m_Vertices[4 * t];
+				const glm::dvec3& a = m_Points[v[TET_FACES[j][0]]];
+				const glm::dvec3& b = m_Points[v[TET_FACES[j][1]]];
+				const glm::dvec3& c = m_Points[v[TET_FACES[j][2]]];
+				if (Orient(a, b, c, p) * Orient(a, b, c, m_Points[v[j]]) < 0.0)
+					next = m_Neighbors[4 * t + j];
+			}
+			if (next < 0) break;
+			t = next;
+		}
+		if (t >= 0 && InCircumsphere(t, p)) return t;
+
+		for (size_t s = 0; s < GetTetCount(); s++)
+			if (m_Vertices[4 * s] >= 0 && InCircumsphere(static_cast<int>(s), p))
+				return static_cast<int>(s);
+		return -1;
+	}
+};
+
+double Tetrahedralizer::WindingNumber(const std::vector<glm::vec3>& surface, const std::vector<Triangle>& triangles,
+									  const glm::dvec3& p)
+{
+	// Van Oosterom & Strackee solid angle per triangle
+	const double fourPi = 4.0 * 3.14159265358979323846;
+	double sum = 0.0;
+	for (const Triangle& tri : triangles)
+	{
+		glm::dvec3 a = glm::dvec3(surface[tri.vertex[0]]) - p;
+		glm::dvec3 b = glm::dvec3(surface[tri.vertex[1]]) - p;
+		glm::dvec3 c = glm::dvec3(surface[tri.vertex[2]]) - p;
+		double la = glm::length(a), lb = glm::length(b), lc = glm::length(c);
+		double numerator = glm::dot(a, glm::cross(b, c));
+		double denominator = la * lb * lc + glm::dot(a, b) * lc + glm::dot(b, c) * la + glm::dot(c, a) * lb;
+		sum += 2.0 * std::atan2(numerator, denominator);
+	}
+	return std::fabs(sum / fourPi);
+}
+
+static float TetQuality(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3)
+{
+	glm::vec3 e[6] = { p1 - p0, p2 - p0, p3 - p0, p2 - p1, p3 - p1, p3 - p2 };
+	float sum2 = 0.0f;
+	for (const glm::vec3& edge : e)
+		sum2 += glm::dot(edge, edge);
+	float rms = std::sqrt(sum2 / 6.0f);
+	float volume = glm::dot(e[0], glm::cross(e[1], e[2])) / 6.0f;
+	return rms > 0.0f ? 6.0f * std::sqrt(2.0f) * volume / (rms * rms * rms) : 0.0f;
+}
+
+TetMesh Tetrahedralizer::Build(const std::vector<glm::vec3>& surface, const std::vector<Triangle>& triangles,
+							   int resolution, float minQuality)
+{
+	TetMesh mesh;
+	mesh.surfaceCount = surface.size();
+	mesh.positions = surface;
+	if (surface.size() < 4 || triangles.empty()) return mesh;
+
+	glm::vec3 lo = surface[0], hi = surface[0];
+	for (const glm::vec3& p : surface)
+	{
+		lo = glm::min(lo, p);
+		hi = glm::max(hi, p);
+	}
+	glm::vec3 size = hi - lo;
+	float extent = std::max(size.x, std::max(size.y, size.z));
+
+	// Interior grid points, kept when inside and clear of the surface
+	float cell = extent / static_cast<float>(std::max(1, resolution));
+	glm::ivec3 counts = glm::max(glm::ivec3(size / cell), glm::ivec3(1));
+	std::vector<glm::vec3> candidates;
+	for (int z = 0; z < counts.z; z++)
+		for (int y = 0; y < counts.y; y++)
+			for (int x = 0; x < counts.x; x++)
+				candidates.push_back(lo + (glm::vec3(x, y, z) + 0.5f) * cell);
+
+	std::vector<char> keep(candidates.size(), 0);
+	ParallelFor(0, candidates.size(), POINT_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			const glm::vec3& p = candidates[i];
+			if (WindingNumber(surface, triangles, glm::dvec3(p)) < 0.5) continue;
+
+			float nearest2 = std::numeric_limits<float>::max();
+			for (const Triangle& tri : triangles)
+			{
+				glm::vec3 weights;
+				glm::vec3 q = PhysicsEngine::ClosestPointOnTriangle(p, surface[tri.vertex[0]], surface[tri.vertex[1]],
+																	surface[tri.vertex[2]], weights);
+				nearest2 = std::min(nearest2, glm::dot(q - p, q - p));
+			}
+			keep[i] = nearest2 > 0.25f * cell * cell;
+		}
+	});
+	for (size_t i = 0; i < candidates.size(); i++)
+		if (keep[i]) mesh.positions.push_back(candidates[i]);
+
+	// Insert in jittered double precision
+	std::vector<glm::dvec3> points(mesh.positions.size());
+	uint32_t seed = 0x9E3779B9u;
+	auto jitter = [&]()
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return (static_cast<double>(seed >> 8) / 16777216.0 * 2.0 - 1.0) * JITTER_SCALE * extent;
+	};
+	for (size_t i = 0; i < points.size(); i++)
+		points[i] = glm::dvec3(mesh.positions[i]) + glm::dvec3(jitter(), jitter(), jitter());
+
+	DelaunayBuilder delaunay(points, glm::dvec3(lo), static_cast<double>(extent));
+	for (size_t i = 0; i < points.size(); i++)
+		delaunay.Insert(static_cast<int>(i));
+
+	// Keep real, inside, non-degenerate tets
+	int pointCount = static_cast<int>(points.size());
+	std::vector<glm::uvec4> candidatesTets;
+	for (size_t t = 0; t < delaunay.GetTetCount(); t++)
+	{
+		const int* v = delaunay.GetTet(t);
+		if (v[0] < 0 || v[0] >= pointCount || v[1] >= pointCount || v[2] >= pointCount || v[3] >= pointCount)
+			continue;
+		candidatesTets.push_back(glm::uvec4(v[0], v[1], v[2], v[3]));
+	}
+
+	std::vector<float> quality(candidatesTets.size(), 0.0f);
+	std::vector<char> inside(candidatesTets.size(), 0);
+	ParallelFor(0, candidatesTets.size(), POINT_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t t = first; t < last; t++)
+		{
+			const glm::uvec4& tet = candidatesTets[t];
+			const auto& x = mesh.positions;
+			quality[t] = TetQuality(x[tet.x], x[tet.y], x[tet.z], x[tet.w]);
+			glm::dvec3 centroid = 0.25 * (glm::dvec3(x[tet.x]) + glm::dvec3(x[tet.y]) +
+										  glm::dvec3(x[tet.z]) + glm::dvec3(x[tet.w]));
+			inside[t] = WindingNumber(surface, triangles, centroid) >= 0.5;
+		}
+	});
+
+	std::vector<char> used(mesh.positions.size(), 0);
+	std::vector<char> kept(candidatesTets.size(), 0);
+	for (size_t t = 0; t < candidatesTets.size(); t++)
+	{
+		if (!inside[t] || quality[t] < minQuality) continue;
+		kept[t] = 1;
+		for (int k = 0; k < 4; k++)
+			used[candidatesTets[t][k]] = 1;
+	}
+
+	// Every surface node is a particle and needs a tet: one that lost all
+	// of its tets to the quality cut gets back its best incident one,
+	// preferring tets inside the surface
+	std::vector<int> best(mesh.surfaceCount, -1);
+	for (size_t t = 0; t < candidatesTets.size(); t++)
+	{
+		if (quality[t] <= 0.0f) continue;
+		for (int k = 0; k < 4; k++)
+		{
+			uint32_t node = candidatesTets[t][k];
+			if (node >= mesh.surfaceCount || used[node]) continue;
+			int& b = best[node];
+			if (b < 0 || std::make_pair(inside[t], quality[t]) > std::make_pair(inside[b], quality[b]))
+				b = static_cast<int>(t);
+		}
+	}
+	for (int t : best)
+	{
+		if (t < 0 || kept[t]) continue;
+		kept[t] = 1;
+		for (int k = 0; k < 4; k++)
+			used[candidatesTets[t][k]] = 1;
+	}
+	for (size_t t = 0; t < candidatesTets.size(); t++)
+		if (kept[t]) mesh.tets.push_back(candidatesTets[t]);
+
+	// Drop interior points no tet uses; surface nodes keep their indices
+	std::vector<uint32_t> remap(mesh.positions.size(), 0);
+
+	std::vector<glm::vec3> positions(surface);
+	for (size_t i = 0; i < mesh.surfaceCount; i++)
+		remap[i] = static_cast<uint32_t>(i);
+	for (size_t i = mesh.surfaceCount; i < mesh.positions.size(); i++)
+	{
+		if (!used[i]) continue;
+		remap[i] = static_cast<uint32_t>(positions.size());
+		positions.push_back(mesh.positions[i]);
+	}
+	mesh.positions = std::move(positions);
+	for (glm::uvec4& tet : mesh.tets)
+		for (int k = 0; k < 4; k++)
+			tet[k] = remap[tet[k]];
+
+	return mesh;
+}
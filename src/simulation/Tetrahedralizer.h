@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "Geometry.h"
+
+const int TET_DEFAULT_RESOLUTION = 6;
+const float TET_MIN_QUALITY = 0.001f;
+
+// Volumetric mesh of a closed surface. The surface vertices come first, in
+// their original order, so node i < surfaceCount is surface vertex i.
+struct TetMesh
+{
+	std::vector<glm::vec3> positions;
+	std::vector<glm::uvec4> tets;       // positively oriented: det[x1-x0, x2-x0, x3-x0] > 0
+	size_t surfaceCount = 0;
+};
+
+// Delaunay tetrahedralization (incremental Bowyer-Watson) of the surface
+// vertices plus a grid of interior points, `resolution` cells along the
+// longest axis of the bounds; interior points closer than half a cell to
+// the surface are skipped. Tets whose centroid lies outside the surface
+// (generalized winding number below 1/2) and slivers whose quality
+// 6√2 V / l_rms³ (1 for a regular tet) is below minQuality are dropped,
+// except that every surface node keeps its best incident tet.
+// The surface must be closed but need not be convex; the result fills it
+// without conforming exactly to every surface triangle.
+class Tetrahedralizer
+{
+public:
+	static TetMesh Build(const std::vector<glm::vec3>& surface, const std::vector<Triangle>& triangles,
+						 int resolution = TET_DEFAULT_RESOLUTION, float minQuality = TET_MIN_QUALITY);
+
+	// |winding number| of the closed surface around p: ~1 inside, ~0 outside
+	static double WindingNumber(const std::vector<glm::vec3>& surface, const std::vector<Triangle>& triangles,
+								const glm::dvec3& p);
+};
@@ -0,0 +1,369 @@
+#include "TriangleBvh.h"
+#include "PhysicsEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const uint32_t LEAF_SIZE = 4;
+static const uint32_t SAH_MAX_LEAF_SIZE = 16;
+static const int SAH_BINS = 12;
+
+void TriangleBvh::Build(const std::vector<Triangle>& triangles, const std::vector<glm::vec3>& positions,
+						BvhSplit split)
+{
+	m_Nodes.clear();
+	m_TriangleOrder.resize(triangles.size());
+	if (triangles.empty()) return;
+
+	BuildInput input;
+	input.split = split;
+	input.centroids.resize(triangles.size());
+	if (split == BvhSplit::Sah)
+	{
+		input.boxMin.resize(triangles.size());
+		input.boxMax.resize(triangles.size());
+	}
+
+	for (uint32_t t = 0; t < triangles.size(); t++)
+	{
+		const glm::vec3& a = positions[triangles[t].vertex[0]];
+		const glm::vec3& b = positions[triangles[t].vertex[1]];
+		const glm::vec3& c = positions[triangles[t].vertex[2]];
+		input.centroids[t] = (a + b + c) / 3.0f;
+		if (split == BvhSplit::Sah)
+		{
+			input.boxMin[t] = glm::min(a, glm::min(b, c));
+			input.boxMax[t] = glm::max(a, glm::max(b, c));
+		}
+		m_TriangleOrder[t] = t;
+	}
+
+	m_Nodes.reserve(2 * triangles.size() / LEAF_SIZE + 1);
+	BuildNode(input, 0, static_cast<uint32_t>(triangles.size()));
+	Refit(triangles, positions, 0.0f);
+}
+
+static float SurfaceArea(const glm::vec3& bMin, const glm::vec3& bMax)
+{
+	glm::vec3 e = glm::max(bMax - bMin, glm::vec3(0.0f));
+	return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+// Binned SAH (Wald 2007): returns the partition point, or end when no split
+// beats keeping the range as one leaf
+uint32_t TriangleBvh::FindSahSplit(const BuildInput& input, uint32_t begin, uint32_t end)
+{
+	struct Bin
+	{
+		glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+		uint32_t count = 0;
+	};
+
+	glm::vec3 cMin(std::numeric_limits<float>::max());
+	glm::vec3 cMax(-std::numeric_limits<float>::max());
+	glm::vec3 nodeMin(std::numeric_limits<float>::max());
+	glm::vec3 nodeMax(-std::numeric_limits<float>::max());
+	for (uint32_t i = begin; i < end; i++)
+	{
+		uint32_t t = m_TriangleOrder[i];
+		cMin = glm::min(cMin, input.centroids[t]);
+		cMax = glm::max(cMax, input.centroids[t]);
+		nodeMin = glm::min(nodeMin, input.boxMin[t]);
+		nodeMax = glm::max(nodeMax, input.boxMax[t]);
+	}
+
+	float bestCost = static_cast<float>(end - begin) * SurfaceArea(nodeMin, nodeMax);
+	int bestAxis = -1;
+	int bestBin = 0;
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		float extent = cMax[axis] - cMin[axis];
+		if (extent <= 0.0f) continue;
+		float scale = SAH_BINS / extent;
+
+		Bin bins[SAH_BINS];
+		for (uint32_t i = begin; i < end; i++)
+		{
+			uint32_t t = m_TriangleOrder[i];
+			int b = std::min(SAH_BINS - 1, static_cast<int>((input.centroids[t][axis] - cMin[axis]) * scale));
+			bins[b].min = glm::min(bins[b].min, input.boxMin[t]);
+			bins[b].max = glm::max(bins[b].max, input.boxMax[t]);
+			bins[b].count++;
+		}
+
+		// Sweep from the right for the right-hand areas, then from the left
+		float rightArea[SAH_BINS];
+		uint32_t rightCount[SAH_BINS];
+		Bin accumulated;
+		for (int b = SAH_BINS - 1; b > 0; b--)
+		{
+			accumulated.min = glm::min(accumulated.min, bins[b].min);
+			accumulated.max = glm::max(accumulated.max, bins[b].max);
+			accumulated.count += bins[b].count;
+			rightArea[b] = SurfaceArea(accumulated.min, accumulated.max);
+			rightCount[b] = accumulated.count;
+		}
+
+		accumulated = Bin();
+		for (int b = 0; b < SAH_BINS - 1; b++)
+		{
+			accumulated.min = glm::min(accumulated.min, bins[b].min);
+			accumulated.max = glm::max(accumulated.max, bins[b].max);
+			accumulated.count += bins[b].count;
+			if (accumulated.count == 0 || rightCount[b + 1] == 0) continue;
+
+			float cost = accumulated.count * SurfaceArea(accumulated.min, accumulated.max) +
+						 rightCount[b + 1] * rightArea[b + 1];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = b;
+			}
+		}
+	}
+
+	if (bestAxis < 0) return end;
+
+	float scale = SAH_BINS / (cMax[bestAxis] - cMin[bestAxis]);
+	auto middle = std::partition(m_TriangleOrder.begin() + begin, m_TriangleOrder.begin() + end,
+		[&](uint32_t t)
+		{
+			int b = std::min(SAH_BINS - 1, static_cast<int>((input.centroids[t][bestAxis] - cMin[bestAxis]) * scale));
+			return b <= bestBin;
+		});
+	return static_cast<uint32_t>(middle - m_TriangleOrder.begin());
+}
+
+uint32_t TriangleBvh::BuildNode(const BuildInput& input, uint32_t begin, uint32_t end)
+{
+	uint32_t index = static_cast<uint32_t>(m_Nodes.size());
+	m_Nodes.push_back({ glm::vec3(0.0f), begin, glm::vec3(0.0f), end - begin });
+	if (end - begin <= LEAF_SIZE) return index;
+
+	uint32_t mid = end;
+	if (input.split == BvhSplit::Sah)
+	{
+		mid = FindSahSplit(input, begin, end);
+		// Splitting is not worth it, unless the leaf would be too large
+		if (mid == end && end - begin <= SAH_MAX_LEAF_SIZE) return index;
+	}
+
+	if (mid == begin || mid == end)
+	{
+		const auto& centroids = input.centroids;
+		glm::vec3 cMin = centroids[m_TriangleOrder[begin]];
+		glm::vec3 cMax = cMin;
+		for (uint32_t i = begin + 1; i < end; i++)
+		{
+			cMin = glm::min(cMin, centroids[m_TriangleOrder[i]]);
+			cMax = glm::max(cMax, centroids[m_TriangleOrder[i]]);
+		}
+		glm::vec3 extent = cMax - cMin;
+		int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+
+		mid = begin + (end - begin) / 2;
+		std::nth_element(m_TriangleOrder.begin() + begin, m_TriangleOrder.begin() + mid,
+						 m_TriangleOrder.begin() + end,
+			[&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+	}
+
+	BuildNode(input, begin, mid);
+	uint32_t right = BuildNode(input, mid, end);
+	m_Nodes[index].first = right;
+	m_Nodes[index].count = 0;
+	return index;
+}
+
+void TriangleBvh::Refit(const std::vector<Triangle>& triangles, const std::vector<glm::vec3>& positions,
+						float margin)
+{
+	glm::vec3 grow(margin);
+
+	// Children are stored after their parent, so a reverse sweep is bottom-up
+	for (size_t n = m_Nodes.size(); n-- > 0;)
+	{
+		BvhNode& node = m_Nodes[n];
+		if (node.count > 0)
+		{
+			glm::vec3 bMin(std::numeric_limits<float>::max());
+			glm::vec3 bMax(-std::numeric_limits<float>::max());
+			for (uint32_t i = node.first; i < node.first + node.count; i++)
+			{
+				const Triangle& tri = triangles[m_TriangleOrder[i]];
+				for (int k = 0; k < 3; k++)
+				{
+					bMin = glm::min(bMin, positions[tri.vertex[k]]);
+					bMax = glm::max(bMax, positions[tri.vertex[k]]);
+				}
+			}
+			node.min = bMin - grow;
+			node.max = bMax + grow;
+		}
+		else
+		{
+			const BvhNode& left = m_Nodes[n + 1];
+			const BvhNode& right = m_Nodes[node.first];
+			node.min = glm::min(left.min, right.min);
+			node.max = glm::max(left.max, right.max);
+		}
+	}
+}
+
+static float BoxDistanceSquared(const glm::vec3& p, const BvhNode& node)
+{
+	glm::vec3 d = p - glm::clamp(p, node.min, node.max);
+	return glm::dot(d, d);
+}
+
+bool TriangleBvh::FindClosest(const glm::vec3& point, float maxDistance, const std::vector<Triangle>& triangles,
+							  const std::vector<glm::vec3>& positions, BvhHit& hit) const
+{
+	if (m_Nodes.empty()) return false;
+
+	float best = maxDistance * maxDistance;
+	bool found = false;
+
+	uint32_t stack[BVH_STACK_SIZE];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	{
+		uint32_t index = stack[--top];
+		const BvhNode& node = m_Nodes[index];
+		if (BoxDistanceSquared(point, node) > best) continue;
+
+		if (node.count > 0)
+		{
+			for (uint32_t i = node.first; i < node.first + node.count; i++)
+			{
+				const Triangle& tri = triangles[m_TriangleOrder[i]];
+				glm::vec3 weights;
+				glm::vec3 q = PhysicsEngine::ClosestPointOnTriangle(point, positions[tri.vertex[0]],
+					positions[tri.vertex[1]], positions[tri.vertex[2]], weights);
+				glm::vec3 d = point - q;
+				float distanceSquared = glm::dot(d, d);
+				if (distanceSquared <= best)
+				{
+					best = distanceSquared;
+					hit.triangle = m_TriangleOrder[i];
+					hit.point = q;
+					hit.weights = weights;
+					found = true;
+				}
+			}
+			continue;
+		}
+
+		if (top + 2 > BVH_STACK_SIZE) continue;
+
+		// Push the farther child first so the nearer one is searched first
+		uint32_t left = index + 1;
+		uint32_t right = node.first;
+		if (BoxDistanceSquared(point, m_Nodes[left]) < BoxDistanceSquared(point, m_Nodes[right]))
+			std::swap(left, right);
+		stack[top++] = left;
+		stack[top++] = right;
+	}
+
+	if (found) hit.distance = std::sqrt(best);
+	return found;
+}
+
+// Möller-Trumbore, front faces only: a particle leaving a closed mesh is
+// never stopped at the surface it exits through
+static bool IntersectFrontFace(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& a,
+							   const glm::vec3& b, const glm::vec3& c, float& t, glm::vec3& weights)
+{
+	glm::vec3 ab = b - a, ac = c - a;
+	glm::vec3 q = glm::cross(direction, ac);
+	float det = glm::dot(ab, q);
+	if (det <= 0.0f) return false;   // det = -dot(direction, normal)
+
+	float inverse = 1.0f / det;
+	glm::vec3 ao = origin - a;
+	float u = glm::dot(ao, q) * inverse;
+	if (u < 0.0f || u > 1.0f) return false;
+
+	glm::vec3 r = glm::cross(ao, ab);
+	float v = glm::dot(direction, r) * inverse;
+	if (v < 0.0f || u + v > 1.0f) return false;
+
+	t = glm::dot(ac, r) * inverse;
+	weights = glm::vec3(1.0f - u - v, u, v);
+	return true;
+}
+
+// Slab test; returns the entry fraction or a value > limit when missed
+static float EnterBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const BvhNode& node, float limit)
+{
+	glm::vec3 t0 = (node.min - origin) * inverseDirection;
+	glm::vec3 t1 = (node.max - origin) * inverseDirection;
+	glm::vec3 near = glm::min(t0, t1), far = glm::max(t0, t1);
+	float enter = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+	float exit = std::min(std::min(far.x, far.y), std::min(far.z, limit));
+	return enter <= exit ? enter : std::numeric_limits<float>::max();
+}
+
+bool TriangleBvh::IntersectSegment(const glm::vec3& start, const glm::vec3& end, const std::vector<Triangle>& triangles,
+								   const std::vector<glm::vec3>& positions, BvhHit& hit) const
+{
+	if (m_Nodes.empty()) return false;
+
+	glm::vec3 direction = end - start;
+	// Infinite components make the slabs of parallel axes all-or-nothing
+	glm::vec3 inverseDirection = 1.0f / direction;
+	float best = 1.0f;
+	bool found = false;
+
+	uint32_t stack[BVH_STACK_SIZE];
+	int top = 0;
+	if (EnterBox(start, inverseDirection, m_Nodes[0], best) <= best)
+		stack[top++] = 0;
+	while (top > 0)
+	{
+		uint32_t index = stack[--top];
+		const BvhNode& node = m_Nodes[index];
+
+		if (node.count > 0)
+		{
+			for (uint32_t i = node.first; i < node.first + node.count; i++)
+			{
+				const Triangle& tri = triangles[m_TriangleOrder[i]];
+				float t;
+				glm::vec3 weights;
+				if (!IntersectFrontFace(start, direction, positions[tri.vertex[0]], positions[tri.vertex[1]],
+										positions[tri.vertex[2]], t, weights))
+					continue;
+				if (t < 0.0f || t > best) continue;
+
+				best = t;
+				hit.triangle = m_TriangleOrder[i];
+				hit.weights = weights;
+				hit.point = start + t * direction;
+				found = true;
+			}
+			continue;
+		}
+
+		if (top + 2 > BVH_STACK_SIZE) continue;
+
+		// Visit the child the segment enters first
+		uint32_t left = index + 1;
+		uint32_t right = node.first;
+		float enterLeft = EnterBox(start, inverseDirection, m_Nodes[left], best);
+		float enterRight = EnterBox(start, inverseDirection, m_Nodes[right], best);
+		if (enterLeft > enterRight)
+		{
+			std::swap(left, right);
+			std::swap(enterLeft, enterRight);
+		}
+		if (enterRight <= best) stack[top++] = right;
+		if (enterLeft <= best) stack[top++] = left;
+	}
+
+	if (found) hit.distance = best;
+	return found;
+}
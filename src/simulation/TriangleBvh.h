@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "Geometry.h"
+
+struct BvhNode
+{
+	glm::vec3 min;
+	uint32_t first;   // leaf: first entry in the triangle order; inner: right child
+	glm::vec3 max;
+	uint32_t count;   // leaf: triangle count; inner: 0 (left child is the next node)
+};
+
+// Median: split at the median centroid of the longest axis (fast, balanced)
+// Sah:    binned surface area heuristic (slower build, cheaper queries)
+enum class BvhSplit { Median, Sah };
+
+// Nearest face found by TriangleBvh::FindClosest
+struct BvhHit
+{
+	uint32_t triangle = 0;
+	glm::vec3 point = glm::vec3(0.0f);
+	glm::vec3 weights = glm::vec3(0.0f);   // barycentric weights of point
+	float distance = 0.0f;
+};
+
+const int BVH_STACK_SIZE = 64;
+
+// Bounding volume hierarchy over a triangle mesh, flattened depth-first so
+// a parent always precedes its children.
+// Deforming surfaces build once from the rest shape (median split) and
+// then only refit the boxes in reverse order each step: the topology never
+// changes, which is fine for soft bodies whose triangles stay local to
+// their rest-shape neighbours. Static meshes build once with SAH splits.
+class TriangleBvh
+{
+private:
+	std::vector<BvhNode> m_Nodes;
+	std::vector<uint32_t> m_TriangleOrder;
+
+	struct BuildInput
+	{
+		BvhSplit split;
+		std::vector<glm::vec3> centroids;
+		std::vector<glm::vec3> boxMin;
+		std::vector<glm::vec3> boxMax;
+	};
+
+public:
+	TriangleBvh() = default;
+
+	void Build(const std::vector<Triangle>& triangles, const std::vector<glm::vec3>& positions,
+			   BvhSplit split = BvhSplit::Median);
+
+	// Recomputes every box from the current positions, grown by `margin`
+	void Refit(const std::vector<Triangle>& triangles, const std::vector<glm::vec3>& positions,
+			   float margin);
+
+	// Calls fn(triangleIndex) for every triangle whose box overlaps the
+	// sphere (center, radius)
+	template <typename Fn>
+	void QuerySphere(const glm::vec3& center, float radius, const Fn& fn) const;
+
+	// Nearest face to point within maxDistance (branch and bound, nearer
+	// child first); false if there is none
+	bool FindClosest(const glm::vec3& point, float maxDistance, const std::vector<Triangle>& triangles,
+					 const std::vector<glm::vec3>& positions, BvhHit& hit) const;
+
+	// First triangle crossed by the segment start -> end from its front
+	// (counter-clockwise) side; hit.distance is the fraction of the segment
+	// travelled at the crossing
+	bool IntersectSegment(const glm::vec3& start, const glm::vec3& end, const std::vector<Triangle>& triangles,
+						  const std::vector<glm::vec3>& positions, BvhHit& hit) const;
+
+	inline bool IsEmpty() const { return m_Nodes.empty(); }
+	inline const glm::vec3& GetMin() const { return m_Nodes[0].min; }
+	inline const glm::vec3& GetMax() const { return m_Nodes[0].max; }
+	inline size_t GetNodeCount() const { return m_Nodes.size(); }
+
+private:
+	uint32_t BuildNode(const BuildInput& input, uint32_t begin, uint32_t end);
+	uint32_t FindSahSplit(const BuildInput& input, uint32_t begin, uint32_t end);
+};
+
+template <typename Fn>
+void TriangleBvh::QuerySphere(const glm::vec3& center, float radius, const Fn& fn) const
+{
+	if (m_Nodes.empty()) return;
+
+	uint32_t stack[BVH_STACK_SIZE];
+	int top = 0;
+	stack[top++] = 0;
+	while (top > 0)
+	{
+		const BvhNode& node = m_Nodes[stack[--top]];
+		glm::vec3 closest = glm::clamp(center, node.min, node.max);
+		glm::vec3 d = center - closest;
+		if (glm::dot(d, d) > radius * radius) continue;
+
+		if (node.count > 0)
+		{
+			for (uint32_t i = node.first; i < node.first + node.count; i++)
+				fn(m_TriangleOrder[i]);
+		}
+		else if (top + 2 <= BVH_STACK_SIZE)
+		{
+			uint32_t self = static_cast<uint32_t>(&node - m_Nodes.data());
+			stack[top++] = node.first;
+			stack[top++] = self + 1;
+		}
+	}
+}
@@ -0,0 +1,243 @@
+#include "XpbdSolver.h"
+#include "PhysicsEngine.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+static const size_t SPRING_GRAIN = 4096;
+static const size_t PARTICLE_GRAIN = 2048;
+
+// Over-relaxation for averaged Jacobi updates (Macklin et al. 2014, Sec. 4.2)
+static const float JACOBI_RELAXATION = 1.5f;
+
+// Moles at which the target volume equals the rest volume
+static const float REFERENCE_MOLES = 500.0f;
+
+void XpbdSolver::Build(const ParticleStore& particles, SurfaceTopology& surface)
+{
+	m_PreviousPositions.assign(particles.Size(), glm::vec3(0.0f));
+	m_Contacts.assign(particles.Size(), 0);
+	m_VolumeGradients.assign(particles.Size(), glm::vec3(0.0f));
+	m_RestVolume = PhysicsEngine::ComputeSurface(particles, surface);
+	m_Volume = m_RestVolume;
+	m_Pressure = 0.0f;
+}
+
+void XpbdSolver::Step(ParticleStore& particles, const SpringTopology& springs,
+					  SurfaceTopology& surface, const SimulationParams& params,
+					  const ColliderBox& collider)
+{
+	size_t n = particles.Size();
+	if (m_PreviousPositions.size() != n) Build(particles, surface);
+	m_SpringCorrections.resize(springs.Size());
+
+	int substeps = std::max(1, params.xpbdSubsteps);
+	float h = params.integrationStep / substeps;
+	float targetVolume = m_RestVolume * (params.moles / REFERENCE_MOLES);
+
+	// External forces are constant over the frame step
+	PhysicsEngine::ClearForces(particles);
+	PhysicsEngine::ApplyGravity(particles, params.gravityStrength);
+	PhysicsEngine::ApplyExternalForce(particles, params.externalForce);
+
+	auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& forces = particles.GetForces();
+	const auto& inverseMasses = particles.GetInverseMasses();
+
+	for (int s = 0; s < substeps; s++)
+	{
+		// Predict
+		ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				m_PreviousPositions[i] = positions[i];
+				velocities[i] += h * inverseMasses[i] * forces[i];
+				positions[i] += h * velocities[i];
+			}
+		});
+
+		// One iteration per substep
+		SolveDistanceConstraints(particles, springs, params.xpbdCompliance, h);
+		SolveVolumeConstraint(particles, surface, targetVolume, params.xpbdVolumeCompliance, h,
+							  params.precision);
+
+		// Collider constraint, then velocities from the position change
+		ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; i++)
+			{
+				m_Contacts[i] = collider.enabled && collider.ProjectPosition(positions[i]);
+				velocities[i] = (positions[i] - m_PreviousPositions[i]) / h;
+			}
+		});
+
+		// Velocity pass: spring damping, then restitution for contacts
+		SolveDamping(particles, springs, h);
+		if (collider.enabled)
+		{
+			ParallelFor(0, n, PARTICLE_GRAIN, [&](size_t first, size_t last)
+			{
+				for (size_t i = first; i < last; i++)
+					if (m_Contacts[i]) collider.ResolveCollision(positions[i], velocities[i]);
+			});
+		}
+	}
+}
+
+void XpbdSolver::SolveDistanceConstraints(ParticleStore& particles, const SpringTopology& springs,
+										  float compliance, float h)
+{
+	auto& positions = particles.GetPositions();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	const auto& edges = springs.GetEdges();
+	const auto& restLengths = springs.GetRestLengths();
+	const auto& weights = springs.GetWeights();
+	float alphaTilde = compliance / (h * h);
+
+	// C = |x_b - x_a| - l0,  Δλ = -C / (w_a + w_b + α̃ / weight)
+	ParallelFor(0, springs.Size(), SPRING_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t s = first; s < last; s++)
+		{
+			ParticleId a = edges[s].a;
+			ParticleId b = edges[s].b;
+			glm::vec3 diff = positions[b] - positions[a];
+			float dist = glm::length(diff);
+			float denominator = inverseMasses[a] + inverseMasses[b] + alphaTilde / weights[s];
+			if (dist < 1e-8f || denominator == 0.0f)
+			{
+				m_SpringCorrections[s] = glm::vec3(0.0f);
+				continue;
+			}
+
+			float deltaLambda = -(dist - restLengths[s]) / denominator;
+			m_SpringCorrections[s] = (deltaLambda / dist) * diff;
+		}
+	});
+
+	// Averaged Jacobi gather: Δx_i = ω / n_i * w_i * Σ ±Δλ n
+	const CsrAdjacency& adjacency = springs.GetParticleSprings();
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			uint32_t begin = adjacency.RowBegin(i);
+			uint32_t end = adjacency.RowEnd(i);
+			if (begin == end) continue;
+
+			glm::vec3 sum(0.0f);
+			for (uint32_t k = begin; k < end; k++)
+			{
+				uint32_t entry = adjacency.entries[k];
+				const glm::vec3& correction = m_SpringCorrections[entry >> 1];
+				if (entry & 1u) sum += correction;
+				else            sum -= correction;
+			}
+			positions[i] += (JACOBI_RELAXATION * inverseMasses[i] / (end - begin)) * sum;
+		}
+	});
+}
+
+// Spring damping applied to velocities along each spring (small steps paper,
+// Sec. 3.5): relative normal velocity is reduced by min(1, h * c * (w_a + w_b))
+void XpbdSolver::SolveDamping(ParticleStore& particles, const SpringTopology& springs, float h)
+{
+	const auto& positions = particles.GetPositions();
+	auto& velocities = particles.GetVelocities();
+	const auto& inverseMasses = particles.GetInverseMasses();
+	const auto& edges = springs.GetEdges();
+	const auto& damping = springs.GetDamping();
+
+	ParallelFor(0, springs.Size(), SPRING_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t s = first; s < last; s++)
+		{
+			ParticleId a = edges[s].a;
+			ParticleId b = edges[s].b;
+			glm::vec3 diff = positions[b] - positions[a];
+			float dist = glm::length(diff);
+			float inverseMassSum = inverseMasses[a] + inverseMasses[b];
+			if (dist < 1e-8f || inverseMassSum == 0.0f)
+			{
+				m_SpringCorrections[s] = glm::vec3(0.0f);
+				continue;
+			}
+
+			glm::vec3 dir = diff / dist;
+			float relative = glm::dot(velocities[b] - velocities[a], dir);
+			float fraction = std::min(1.0f, h * damping[s] * inverseMassSum);
+			m_SpringCorrections[s] = (-relative * fraction / inverseMassSum) * dir;
+		}
+	});
+
+	const CsrAdjacency& adjacency = springs.GetParticleSprings();
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			uint32_t begin = adjacency.RowBegin(i);
+			uint32_t end = adjacency.RowEnd(i);
+			if (begin == end) continue;
+
+			glm::vec3 sum(0.0f);
+			for (uint32_t k = begin; k < end; k++)
+			{
+				uint32_t entry = adjacency.entries[k];
+				const glm::vec3& impulse = m_SpringCorrections[entry >> 1];
+				if (entry & 1u) sum += impulse;
+				else            sum -= impulse;
+			}
+			velocities[i] += (JACOBI_RELAXATION * inverseMasses[i] / (end - begin)) * sum;
+		}
+	});
+}
+
+void XpbdSolver::SolveVolumeConstraint(ParticleStore& particles, SurfaceTopology& surface,
+									   float targetVolume, float compliance, float h,
+									   PrecisionMode precision)
+{
+	// Fused face pass: volume plus area-weighted face normals
+	m_Volume = PhysicsEngine::ComputeSurface(precision, particles, surface);
+
+	// ∂V/∂x_i = 1/3 Σ area * n_hat over incident faces; the same sum gives
+	// the smooth vertex normal
+	const CsrAdjacency& adjacency = surface.GetVertexFaces();
+	const auto& faceVectors = surface.GetFaceVectors();
+	auto& normals = surface.GetVertexNormals();
+	const auto& inverseMasses = particles.GetInverseMasses();
+
+	float weightedNorm = ParallelReduce(0, adjacency.GetRowCount(), PARTICLE_GRAIN, 0.0f,
+		[&](size_t first, size_t last)
+		{
+			float partial = 0.0f;
+			for (size_t i = first; i < last; i++)
+			{
+				glm::vec3 sum(0.0f);
+				for (uint32_t k = adjacency.RowBegin(i); k < adjacency.RowEnd(i); k++)
+					sum += faceVectors[adjacency.entries[k]];
+
+				float length = glm::length(sum);
+				normals[i] = (length > 0.0f) ? sum / length : glm::vec3(0.0f);
+				m_VolumeGradients[i] = sum / 3.0f;
+				partial += inverseMasses[i] * glm::dot(m_VolumeGradients[i], m_VolumeGradients[i]);
+			}
+			return partial;
+		},
+		[](float a, float b) { return a + b; });
+
+	float alphaTilde = compliance / (h * h);
+	float denominator = weightedNorm + alphaTilde;
+	if (denominator <= 0.0f) return;
+
+	float deltaLambda = -(m_Volume - targetVolume) / denominator;
+	m_Pressure = deltaLambda / (h * h);
+
+	auto& positions = particles.GetPositions();
+	ParallelFor(0, particles.Size(), PARTICLE_GRAIN, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			positions[i] += (inverseMasses[i] * deltaLambda) * m_VolumeGradients[i];
+	});
+}
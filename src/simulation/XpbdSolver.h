@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <glm/glm.hpp>
+#include "ParticleStore.h"
+#include "SpringTopology.h"
+#include "SurfaceTopology.h"
+#include "ColliderBox.h"
+#include "SimulationParams.h"
+
+// Extended position-based dynamics (Macklin et al. 2016) with the "small
+// steps" scheme (Macklin et al. 2019): the frame step is split into many
+// substeps with a single constraint iteration each. Constraints:
+//   - one distance constraint per spring (compliance / spring weight)
+//   - one global volume constraint toward the rest volume, scaled by the
+//     number of moles so the Moles slider still inflates the body
+//   - collider box (inequality, zero compliance)
+// Spring damping and collider restitution act in a velocity pass.
+// Distance constraints are solved Jacobi-style (per-spring corrections,
+// then a per-particle CSR gather) so every phase runs in parallel.
+class XpbdSolver
+{
+private:
+	std::vector<glm::vec3> m_PreviousPositions;
+	std::vector<glm::vec3> m_SpringCorrections;   // Δλ * n (or damping impulse) per spring
+	std::vector<uint8_t> m_Contacts;
+	std::vector<glm::vec3> m_VolumeGradients;     // ∂V/∂x_i
+	float m_RestVolume = 0.0f;
+	float m_Volume = 0.0f;
+	float m_Pressure = 0.0f;
+
+public:
+	XpbdSolver() = default;
+
+	// Captures the rest volume from the current particle positions
+	void Build(const ParticleStore& particles, SurfaceTopology& surface);
+
+	// Advances one frame step (params.integrationStep) in params.xpbdSubsteps substeps
+	void Step(ParticleStore& particles, const SpringTopology& springs,
+			  SurfaceTopology& surface, const SimulationParams& params,
+			  const ColliderBox& collider);
+
+	inline float GetVolume() const { return m_Volume; }
+	// Volume constraint multiplier converted to a pressure (λ / h²)
+	inline float GetPressure() const { return m_Pressure; }
+
+private:
+	void SolveDistanceConstraints(ParticleStore& particles, const SpringTopology& springs,
+								  float compliance, float h);
+	void SolveDamping(ParticleStore& particles, const SpringTopology& springs, float h);
+	void SolveVolumeConstraint(ParticleStore& particles, SurfaceTopology& surface,
+							   float targetVolume, float compliance, float h,
+							   PrecisionMode precision);
+};
@@ -60,17 +60,41 @@ void SimulationUI::Draw(SimulationParams& params, SimulationMetrics& metrics,
 		params.moles = static_cast<unsigned int>(moles);
 
 	ImGui::SliderFloat("Time Step", &params.integrationStep, 0.001f, 0.05f, "%.4f");
+	ImGui::SliderInt("Max Substeps", &params.maxSubsteps, 1, 64);
 
-	const char* integrationMethods[] = { "Forward Euler", "Midpoint (2nd Order)", "Implicit Euler" };
 	int currentMethod = static_cast<int>(params.integrationMethod);
-	if (ImGui::Combo("Integration", &currentMethod, integrationMethods, 3))
+	if (ImGui::Combo("Integration", &currentMethod, INTEGRATION_METHOD_NAMES, INTEGRATION_METHOD_COUNT))
 		params.integrationMethod = static_cast<IntegrationMethod>(currentMethod);
 
+	if (params.integrationMethod == IntegrationMethod::XPBD)
+	{
+		ImGui::SliderInt("XPBD Substeps", &params.xpbdSubsteps, 1, 50);
+		ImGui::SliderFloat("Stretch Compliance", &params.xpbdCompliance, 1e-8f, 1e-1f,
+			"%.1e", ImGuiSliderFlags_Logarithmic);
+		ImGui::SliderFloat("Volume Compliance", &params.xpbdVolumeCompliance, 0.0f, 1e-1f,
+			"%.1e", ImGuiSliderFlags_Logarithmic);
+	}
+	else if (params.integrationMethod == IntegrationMethod::AdaptiveRK23)
+	{
+		ImGui::SliderFloat("Min Step", &params.adaptiveMinStep, 0.0001f, 0.01f, "%.4f");
+		ImGui::SliderFloat("Max Step", &params.adaptiveMaxStep, 0.005f, 0.1f, "%.4f");
+		ImGui::SliderFloat("Tolerance", &params.adaptiveTolerance, 1e-5f, 1e-1f,
+			"%.1e", ImGuiSliderFlags_Logarithmic);
+	}
+	else if (params.integrationMethod == IntegrationMethod::ProjectiveDynamics)
+	{
+		ImGui::SliderInt("PD Iterations", &params.pdIterations, 1, 50);
+	}
+
 	const char* volumeMethods[] = { "AABB", "Bounding Sphere", "Bounding Ellipsoid", "Exact (Divergence Thm)" };
 	int currentVolMethod = static_cast<int>(params.volumeMethod);
 	if (ImGui::Combo("Volume Method", &currentVolMethod, volumeMethods, 4))
 		params.volumeMethod = static_cast<VolumeMethod>(currentVolMethod);
 
+	int currentPrecision = static_cast<int>(params.precision);
+	if (ImGui::Combo("Precision", &currentPrecision, PRECISION_MODE_NAMES, PRECISION_MODE_COUNT))
+		params.precision = static_cast<PrecisionMode>(currentPrecision);
+
 	// Volume comparison (Addition 1)
 	if (app)
 	{
@@ -172,7 +196,40 @@ void SimulationUI::Draw(SimulationParams& params, SimulationMetrics& metrics,
 	{
 		ImGui::Text("Frame: %d  |  Step: %.3f ms  |  Avg: %.3f ms",
 			metrics.simFrameCount, metrics.physicsStepMs, metrics.avgPhysicsStepMs);
+		ImGui::Text("Substeps: %d  |  %.0f steps/s", metrics.substeps, metrics.substepsPerSec);
 		ImGui::Text("Max Dist: %.2f", metrics.maxParticleDist);
+		ImGui::Text("Body Pairs: %zu  |  Contacts: %zu", metrics.bodyPairs, metrics.bodyContacts);
+		if (params.selfCollision)
+			ImGui::Text("Self Contacts: %zu", metrics.selfContacts);
+		if (app && !app->GetModels().empty())
+			ImGui::Text("Model Contacts: %zu", metrics.meshContacts);
+		if (app && !app->GetObstacles().GetPrimitives().empty())
+			ImGui::Text("Obstacle Contacts: %zu", metrics.obstacleContacts);
+		if (params.continuousCollision)
+			ImGui::Text("Swept Contacts: %zu", metrics.sweptContacts);
+		if (params.sleeping)
+			ImGui::Text("Sleeping: %zu / %zu bodies", metrics.sleepingBodies,
+				app ? app->GetSoftbodies().size() : size_t(0));
+		ImGui::Text("Spring Kernel: %s",
+			SpringKernels::GetLevelName(SpringKernels::GetActiveLevel()));
+		if (params.integrationMethod == IntegrationMethod::ImplicitEuler)
+			ImGui::Text("PCG: %d iters  |  Residual: %.1e",
+				metrics.solverIterations, metrics.solverResidual);
+		if (params.integrationMethod == IntegrationMethod::AdaptiveRK23)
+		{
+			ImGui::Text("Adaptive: h = %.4f s  |  %d accepted  |  %d rejected",
+				metrics.adaptiveStep, metrics.adaptiveAccepted, metrics.adaptiveRejected);
+			if (metrics.adaptiveTruncated > 0)
+				ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "%d steps cut short (attempt cap)",
+					metrics.adaptiveTruncated);
+		}
+		if (params.integrationMethod == IntegrationMethod::ProjectiveDynamics)
+		{
+			ImGui::Text("PD: %d iters  |  %d factorizations  |  nnz(L) %zu",
+				params.pdIterations, metrics.pdFactorizations, metrics.pdFactorNonZeros);
+			if (metrics.pdSingular)
+				ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "PD system singular: explicit fallback");
+		}
 
 		if (metrics.diverged)
 			ImGui::TextColored(ImVec4(1.0f, 0.2f, 0.2f, 1.0f), "Simulation unstable!");
@@ -182,6 +239,11 @@ void SimulationUI::Draw(SimulationParams& params, SimulationMetrics& metrics,
 			if (app) app->CaptureSnapshot();
 		}
 		ImGui::SameLine();
+		if (ImGui::Button("Benchmark Precision"))
+		{
+			if (app) app->BenchmarkPrecision();
+		}
+		ImGui::SameLine();
 		if (ImGui::Button("Reset Metrics"))
 		{
 			metrics.avgPhysicsStepMs = 0.0f;
@@ -220,6 +282,71 @@ void SimulationUI::Draw(SimulationParams& params, SimulationMetrics& metrics,
 
 	ImGui::Separator();
 
+	DrawObstacles(app);
+
+	ImGui::Separator();
+
+	// Soft bodies
+	ImGui::Text("Soft Bodies");
+	ImGui::Checkbox("Body Collisions", &params.bodyCollisions);
+	ImGui::SliderFloat("Contact Thickness", &params.bodyThickness, 0.005f, 0.2f, "%.3f");
+	ImGui::Checkbox("Self Collision", &params.selfCollision);
+	ImGui::SliderFloat("Self Thickness", &params.selfThickness, 0.001f, 0.1f, "%.3f");
+	ImGui::Checkbox("Continuous Collision", &params.continuousCollision);
+	ImGui::Checkbox("Sleeping", &params.sleeping);
+	if (params.sleeping)
+	{
+		ImGui::SliderFloat("Sleep Energy", &params.sleepEnergy, 1e-6f, 1e-2f, "%.1e", ImGuiSliderFlags_Logarithmic);
+		ImGui::SliderFloat("Sleep Speed", &params.sleepSpeed, 0.001f, 0.5f, "%.3f");
+		ImGui::SliderInt("Sleep Steps", &params.sleepSteps, 1, 300);
+	}
+	int currentModel = static_cast<int>(params.spawnModel);
+	if (ImGui::Combo("New Body Model", &currentModel, SOFTBODY_MODEL_NAMES, SOFTBODY_MODEL_COUNT))
+		params.spawnModel = static_cast<SoftbodyModel>(currentModel);
+	ImGui::SliderFloat("Shape Stiffness", &params.shapeStiffness, 0.0f, 1.0f, "%.3f");
+	ImGui::SliderInt("Shape Clusters", &params.shapeClusters, 1, 6);
+	ImGui::SliderFloat("Shape Overlap", &params.shapeOverlap, 0.0f, 1.0f, "%.2f");
+	ImGui::SliderInt("Shape Iterations", &params.shapeIterations, 1, 8);
+	ImGui::SliderFloat("Young's Modulus", &params.femYoungsModulus, 1e3f, 1e6f, "%.0f", ImGuiSliderFlags_Logarithmic);
+	ImGui::SliderFloat("Poisson Ratio", &params.femPoissonRatio, 0.0f, 0.45f, "%.2f");
+	ImGui::SliderFloat("FEM Density", &params.femDensity, 10.0f, 1000.0f, "%.0f", ImGuiSliderFlags_Logarithmic);
+	ImGui::SliderFloat("FEM Damping", &params.femDamping, 0.0f, 0.1f, "%.3f");
+	ImGui::SliderInt("Tet Resolution", &params.femResolution, 2, 12);
+	ImGui::SliderInt("Render Detail", &params.renderDetail, 0, 3);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("New bodies draw a finer surface carried by the simulated one (0 draws the particles)");
+	if (app)
+	{
+		if (ImGui::Button("Add Body")) app->AddSoftbodies(1);
+		ImGui::SameLine();
+		if (ImGui::Button("Add 10 Bodies")) app->AddSoftbodies(10);
+		ImGui::SameLine();
+		if (ImGui::Button("Add 100 Bodies")) app->AddSoftbodies(100);
+
+		size_t matched = 0, clusters = 0, volumetric = 0, tets = 0, particles = 0, rendered = 0;
+		for (const auto& sb : app->GetSoftbodies())
+		{
+			particles += sb->GetParticleCount();
+			rendered += sb->GetRenderVertexCount();
+			if (sb->GetModel() == SoftbodyModel::ShapeMatching)
+			{
+				matched++;
+				clusters += sb->GetShapeMatching().GetClusterCount();
+			}
+			else if (sb->GetModel() == SoftbodyModel::Fem)
+			{
+				volumetric++;
+				tets += sb->GetFem().GetTetCount();
+			}
+		}
+		ImGui::Text("%zu bodies  |  %zu shape matching (%zu clusters)",
+			app->GetSoftbodies().size(), matched, clusters);
+		ImGui::Text("%zu FEM (%zu tets)", volumetric, tets);
+		ImGui::Text("%zu particles drive %zu rendered vertices", particles, rendered);
+	}
+
+	ImGui::Separator();
+
 	// --- Model Loading ---
 	ImGui::Text("3D Models");
 	ImGui::Spacing();
@@ -246,6 +373,9 @@ void SimulationUI::Draw(SimulationParams& params, SimulationMetrics& metrics,
 			m_ModelPath[0] = '\0';
 		}
 	}
+	ImGui::SliderInt("Particle Budget", &params.importParticleBudget, 0, 5000);
+	if (ImGui::IsItemHovered())
+		ImGui::SetTooltip("Vertices kept when a model becomes a soft body (0 keeps every welded vertex)");
 
 	// Status message
 	if (m_StatusTimer > 0.0f)
@@ -285,17 +415,76 @@ void SimulationUI::Draw(SimulationParams& params, SimulationMetrics& metrics,
 				float scl[3] = { scale.x, scale.y, scale.z };
 				float rot[3] = { rotation.x, rotation.y, rotation.z };
 
+				// Any edit to a collider the bodies may rest on wakes them
+				bool moved = false;
 				if (ImGui::DragFloat3("Position", pos, 0.1f))
+				{
 					t.SetTranslation(glm::vec3(pos[0], pos[1], pos[2]));
+					moved = true;
+				}
 
 				if (ImGui::DragFloat3("Scale", scl, 0.01f, 0.001f, 100.0f))
+				{
 					t.SetScale(glm::vec3(scl[0], scl[1], scl[2]));
+					moved = true;
+				}
 
 				if (ImGui::DragFloat3("Rotation", rot, 1.0f, -360.0f, 360.0f))
+				{
 					t.SetRotation(glm::vec3(rot[0], rot[1], rot[2]));
+					moved = true;
+				}
+
+				bool collision = models[i]->IsCollisionEnabled();
+				if (ImGui::Checkbox("Collider", &collision))
+				{
+					models[i]->SetCollisionEnabled(collision);
+					moved = true;
+				}
+				ImGui::SameLine();
+				ImGui::Text("%zu triangles", models[i]->GetCollider().GetTriangleCount());
 
+				bool useSdf = models[i]->IsUsingSdf();
+				if (ImGui::Checkbox("Distance Field", &useSdf))
+				{
+					SdfSource source = models[i]->SetUseSdf(useSdf);
+					moved = true;
+					if (source != SdfSource::None)
+					{
+						m_StatusMsg = source == SdfSource::Reused ? "SDF reused"
+							: source == SdfSource::Cache ? "SDF loaded from cache" : "SDF baked";
+						m_StatusTimer = 3.0f;
+					}
+				}
+				if (models[i]->IsUsingSdf())
+				{
+					glm::ivec3 size = models[i]->GetSdf().GetSize();
+					ImGui::SameLine();
+					ImGui::Text("%dx%dx%d, %.1f MB", size.x, size.y, size.z,
+						models[i]->GetSdf().GetByteSize() / (1024.0f * 1024.0f));
+				}
+
+				if (ImGui::Button("Make Soft Body"))
+				{
+					SurfaceReport report;
+					char message[256];
+					if (app->AddSoftbodyFromModel(i, report))
+						snprintf(message, sizeof(message), "Soft body: %zu vertices -> %zu welded -> %zu particles",
+							report.inputVertices, report.weldedVertices,
+							app->GetSoftbodies().back()->GetParticleCount());
+					else
+						snprintf(message, sizeof(message),
+							"Not a closed manifold: %zu open, %zu non-manifold, %zu flipped edges, %zu pinched vertices",
+							report.boundaryEdges, report.nonManifoldEdges, report.flippedEdges,
+							report.nonManifoldVertices);
+					m_StatusMsg = message;
+					m_StatusTimer = 5.0f;
+				}
+				ImGui::SameLine();
 				if (ImGui::Button("Remove"))
 					removeIndex = i;
+				if (moved)
+					app->WakeSoftbodies();
 			}
 
 			ImGui::PopID();
@@ -307,3 +496,62 @@ void SimulationUI::Draw(SimulationParams& params, SimulationMetrics& metrics,
 
 	ImGui::End();
 }
+
+void SimulationUI::DrawObstacles(Application* app)
+{
+	ImGui::Text("Obstacles");
+	if (!app) return;
+
+	ImGui::Combo("Shape", &m_ObstacleShape, COLLIDER_SHAPE_NAMES, IM_ARRAYSIZE(COLLIDER_SHAPE_NAMES));
+	if (ImGui::Button("Add Obstacle"))
+		app->AddObstacle(static_cast<ColliderShape>(m_ObstacleShape));
+
+	auto& obstacles = app->GetObstacles().GetPrimitives();
+	int removeIndex = -1;
+
+	for (int i = 0; i < static_cast<int>(obstacles.size()); i++)
+	{
+		ColliderPrimitive& obstacle = obstacles[i];
+		ImGui::PushID(1000 + i);
+
+		char label[64];
+		snprintf(label, sizeof(label), "%s %d", COLLIDER_SHAPE_NAMES[static_cast<int>(obstacle.shape)], i);
+		if (ImGui::TreeNode(label))
+		{
+			bool changed = ImGui::Checkbox("Enabled", &obstacle.enabled);
+			changed |= ImGui::DragFloat3("Position", &obstacle.position.x, 0.05f);
+
+			bool rotates = obstacle.shape == ColliderShape::OBB || obstacle.shape == ColliderShape::Capsule ||
+						   obstacle.shape == ColliderShape::Plane;
+			if (rotates)
+				changed |= ImGui::DragFloat3("Rotation", &obstacle.rotation.x, 1.0f, -360.0f, 360.0f);
+
+			switch (obstacle.shape)
+			{
+			case ColliderShape::AABB:
+			case ColliderShape::OBB:
+				changed |= ImGui::DragFloat3("Half Extents", &obstacle.halfExtents.x, 0.01f, 0.01f, 20.0f);
+				break;
+			case ColliderShape::Capsule:
+				changed |= ImGui::DragFloat("Half Length", &obstacle.halfLength, 0.01f, 0.0f, 20.0f);
+				// fall through
+			case ColliderShape::Sphere:
+				changed |= ImGui::DragFloat("Radius", &obstacle.radius, 0.01f, 0.01f, 20.0f);
+				break;
+			case ColliderShape::Plane:
+				break;
+			}
+
+			if (changed)
+				app->WakeSoftbodies();
+			if (ImGui::Button("Remove"))
+				removeIndex = i;
+			ImGui::TreePop();
+		}
+
+		ImGui::PopID();
+	}
+
+	if (removeIndex >= 0)
+		app->RemoveObstacle(removeIndex);
+}
@@ -18,6 +18,8 @@ private:
 	char m_ModelPath[512] = "";
 	std::string m_StatusMsg;
 	float m_StatusTimer = 0.0f;
+	int m_ObstacleShape = 0;
 
 	std::string OpenFileDialog();
+	void DrawObstacles(Application* app);
 };